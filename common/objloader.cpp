@@ -3,9 +3,21 @@
 #include <string>
 #include <cstring>
 
+#include <stdint.h>
+#include <errno.h>
+#include <algorithm>
+#include <functional>
+
+/* POSIX */
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <glm/glm.hpp>
 
 #include "objloader.hpp"
+#include "ThreadPool.hpp"
 
 // Very, VERY simple OBJ loader.
 // Here is a short list of features a real function would provide : 
@@ -111,6 +123,673 @@ bool loadOBJ(
 }
 
 
+// ---------------------------------------------------------------------------
+// Fast OBJ reader
+//
+// The file is mmapped and cut into chunks at line ends. The chunks are parsed
+// in parallel on the ThreadPool, each into its own attribute arrays and a
+// triangle list of raw (v, vt, vn) corners. Prefix sums over the per chunk
+// attribute counts turn the chunk local indices (negative OBJ indices are
+// relative to the attributes read so far) into global ones. Last, the corners
+// are welded into an indexed mesh through a hash table keyed on the triplet.
+//
+// Handles triangles, quads and n-gons (fan triangulated), negative indices,
+// and faces without uvs or normals (those come out as zero). Everything but
+// v/vt/vn/f is skipped, so groups and materials end up in the one mesh.
+// ---------------------------------------------------------------------------
+
+#define OBJ_MIN_CHUNK_SIZE (1 << 20)
+#define OBJ_MISSING INT32_MIN
+
+// One face corner, the position, uv and normal index
+struct ObjCorner{
+	int32_t index[3];
+	uint8_t relative;	// Bit i set: index[i] is chunk local, 0 based
+};
+
+// What one chunk of the file holds
+struct ObjChunk{
+	const char * begin;
+	const char * end;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	std::vector<ObjCorner> corners;		// Triangle list
+	size_t base[3];						// Attributes in the chunks before this one
+	bool ok;
+};
+
+static inline const char * objSkipSpace(const char * p, const char * end){
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+	return p;
+}
+
+// strtof without the locale and the allocations. Not correctly rounded in
+// the last bit, which is plenty for vertex data.
+static const char * objParseFloat(const char * p, const char * end, float & out){
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	p = objSkipSpace(p, end);
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')){
+		negative = (*p == '-');
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digits = 0;
+	const char * start = p;
+	for (; p < end && *p >= '0' && *p <= '9'; p++){
+		if (digits < 19){ mantissa = mantissa * 10 + (*p - '0'); digits += (mantissa != 0); }
+		else exponent++;
+	}
+	if (p < end && *p == '.'){
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++){
+			if (digits < 19){ mantissa = mantissa * 10 + (*p - '0'); digits += (mantissa != 0); exponent--; }
+		}
+	}
+	if (p == start) return NULL;
+	if (p < end && (*p == 'e' || *p == 'E')){
+		const char * q = p + 1;
+		bool negativeExponent = false;
+		if (q < end && (*q == '-' || *q == '+')){
+			negativeExponent = (*q == '-');
+			q++;
+		}
+		if (q < end && *q >= '0' && *q <= '9'){
+			int e = 0;
+			for (; q < end && *q >= '0' && *q <= '9'; q++){
+				if (e < 10000) e = e * 10 + (*q - '0');
+			}
+			exponent += negativeExponent ? -e : e;
+			p = q;
+		}
+	}
+
+	double value = (double)mantissa;
+	while (exponent > 22) { value *= 1e22; exponent -= 22; }
+	while (exponent < -22) { value /= 1e22; exponent += 22; }
+	value = exponent >= 0 ? value * powers[exponent] : value / powers[-exponent];
+
+	out = (float)(negative ? -value : value);
+	return p;
+}
+
+static const char * objParseInt(const char * p, const char * end, int32_t & out){
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')){
+		negative = (*p == '-');
+		p++;
+	}
+	const char * start = p;
+	int64_t value = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++){
+		if (value < INT32_MAX) value = value * 10 + (*p - '0');
+	}
+	if (p == start) return NULL;
+	if (value > INT32_MAX) value = INT32_MAX;
+	out = (int32_t)(negative ? -value : value);
+	return p;
+}
+
+// Parses one f corner, v, v/vt, v//vn or v/vt/vn. counts are the attributes
+// read so far in this chunk, for the negative indices.
+static const char * objParseCorner(const char * p, const char * end, const size_t * counts, ObjCorner & corner){
+	corner.relative = 0;
+	corner.index[0] = corner.index[1] = corner.index[2] = OBJ_MISSING;
+	for (int i = 0; i < 3; i++){
+		if (i > 0){
+			if (p >= end || *p != '/') break;
+			p++;
+			if (p < end && *p == '/') continue;	// v//vn
+		}
+		int32_t value;
+		const char * q = objParseInt(p, end, value);
+		if (q == NULL){
+			if (i == 0) return NULL;
+			continue;
+		}
+		p = q;
+		if (value > 0){
+			corner.index[i] = value - 1;
+		}else if (value < 0){
+			corner.index[i] = (int32_t)counts[i] + value;
+			corner.relative |= (uint8_t)(1 << i);
+		}else{
+			return NULL;	// Indices start at 1
+		}
+	}
+	return p;
+}
+
+// Parses the lines of a chunk
+static void objParseChunk(ObjChunk & chunk){
+	chunk.ok = true;
+	std::vector<ObjCorner> polygon;
+	const char * p = chunk.begin;
+	const char * end = chunk.end;
+
+	while (p < end){
+		const char * lineEnd = (const char *)memchr(p, '\n', end - p);
+		if (lineEnd == NULL) lineEnd = end;
+
+		p = objSkipSpace(p, lineEnd);
+		if (lineEnd - p >= 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')){
+			glm::vec3 position;
+			const char * q = p + 2;
+			for (int i = 0; i < 3 && q; i++) q = objParseFloat(q, lineEnd, position[i]);
+			if (q == NULL){ chunk.ok = false; return; }
+			chunk.positions.push_back(position);
+		}else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')){
+			glm::vec2 uv(0.0f, 0.0f);
+			const char * q = objParseFloat(p + 3, lineEnd, uv.x);
+			if (q == NULL){ chunk.ok = false; return; }
+			objParseFloat(q, lineEnd, uv.y);	// v is optional
+			uv.y = -uv.y; // Same as loadOBJ, the DDS textures are inverted
+			chunk.uvs.push_back(uv);
+		}else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')){
+			glm::vec3 normal;
+			const char * q = p + 3;
+			for (int i = 0; i < 3 && q; i++) q = objParseFloat(q, lineEnd, normal[i]);
+			if (q == NULL){ chunk.ok = false; return; }
+			chunk.normals.push_back(normal);
+		}else if (lineEnd - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')){
+			size_t counts[3] = { chunk.positions.size(), chunk.uvs.size(), chunk.normals.size() };
+			polygon.clear();
+			const char * q = objSkipSpace(p + 2, lineEnd);
+			while (q < lineEnd && *q != '\r' && *q != '#'){
+				ObjCorner corner;
+				q = objParseCorner(q, lineEnd, counts, corner);
+				if (q == NULL){ chunk.ok = false; return; }
+				polygon.push_back(corner);
+				q = objSkipSpace(q, lineEnd);
+			}
+			if (polygon.size() < 3){ chunk.ok = false; return; }
+
+			// Fan, fine for the convex polygons exporters write
+			for (size_t i = 1; i + 1 < polygon.size(); i++){
+				chunk.corners.push_back(polygon[0]);
+				chunk.corners.push_back(polygon[i]);
+				chunk.corners.push_back(polygon[i + 1]);
+			}
+		}
+		// Anything else, comments, groups, materials, is skipped
+
+		p = lineEnd + 1;
+	}
+}
+
+// Welds (v, vt, vn) triplets into output vertices
+class ObjWelder{
+public:
+	ObjWelder(size_t expected){
+		size_t capacity = 16;
+		while (capacity < expected * 2) capacity <<= 1;
+		mask_ = capacity - 1;
+		slots_.assign(capacity, EMPTY);
+	}
+
+	// Returns true and the index of the triplet if it was seen before,
+	// otherwise stores it under next
+	bool findOrInsert(const int32_t * key, uint32_t next, uint32_t & result){
+		uint64_t hash = (uint32_t)key[0] * 0x9E3779B97F4A7C15ULL;
+		hash ^= (uint32_t)key[1] * 0xC2B2AE3D27D4EB4FULL;
+		hash ^= (uint32_t)key[2] * 0x165667B19E3779F9ULL;
+		hash ^= hash >> 32;
+
+		for (size_t slot = hash & mask_; ; slot = (slot + 1) & mask_){
+			uint32_t index = slots_[slot];
+			if (index == EMPTY){
+				slots_[slot] = next;
+				keys_.insert(keys_.end(), key, key + 3);
+				return false;
+			}
+			if (memcmp(&keys_[(size_t)index * 3], key, 3 * sizeof(int32_t)) == 0){
+				result = index;
+				return true;
+			}
+		}
+	}
+
+	// Forget every triplet, keeps the storage
+	void clear(){
+		std::fill(slots_.begin(), slots_.end(), (uint32_t)EMPTY);
+		keys_.clear();
+	}
+
+private:
+	enum { EMPTY = 0xFFFFFFFF };	// Free slot
+
+	size_t mask_;
+	std::vector<uint32_t> slots_;
+	std::vector<int32_t> keys_;
+};
+
+bool loadOBJ_fast(
+	const char * path,
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	printf("Loading OBJ file %s...\n", path);
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0){
+		printf("Impossible to open %s: %s\n", path, strerror(errno));
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0){
+		printf("Impossible to stat %s or it is empty\n", path);
+		close(fd);
+		return false;
+	}
+	size_t size = st.st_size;
+	const char * data = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED){
+		printf("Impossible to map %s: %s\n", path, strerror(errno));
+		return false;
+	}
+	madvise((void *)data, size, MADV_SEQUENTIAL);
+
+	// Cut the file into chunks at line ends, a few per worker
+	ThreadPool & pool = ThreadPool::global();
+	size_t chunkSize = size / ((pool.size() + 1) * 4) + 1;
+	if (chunkSize < OBJ_MIN_CHUNK_SIZE) chunkSize = OBJ_MIN_CHUNK_SIZE;
+
+	std::vector<ObjChunk> chunks;
+	const char * end = data + size;
+	for (const char * p = data; p < end; ){
+		const char * chunkEnd = p + chunkSize < end ? p + chunkSize : end;
+		if (chunkEnd < end){
+			const char * newline = (const char *)memchr(chunkEnd, '\n', end - chunkEnd);
+			chunkEnd = newline ? newline + 1 : end;
+		}
+		chunks.push_back(ObjChunk());
+		chunks.back().begin = p;
+		chunks.back().end = chunkEnd;
+		p = chunkEnd;
+	}
+
+	// Pass 1, parse
+	pool.parallelFor(chunks.size(), [&](uint32_t i){
+		objParseChunk(chunks[i]);
+	});
+
+	size_t totals[3] = { 0, 0, 0 };
+	size_t cornerCount = 0;
+	for (size_t i = 0; i < chunks.size(); i++){
+		if (!chunks[i].ok){
+			printf("%s: malformed line in bytes %lu-%lu\n", path,
+				(unsigned long)(chunks[i].begin - data), (unsigned long)(chunks[i].end - data));
+			munmap((void *)data, size);
+			return false;
+		}
+		chunks[i].base[0] = totals[0];
+		chunks[i].base[1] = totals[1];
+		chunks[i].base[2] = totals[2];
+		totals[0] += chunks[i].positions.size();
+		totals[1] += chunks[i].uvs.size();
+		totals[2] += chunks[i].normals.size();
+		cornerCount += chunks[i].corners.size();
+	}
+	munmap((void *)data, size);
+
+	// Pass 2, global attribute arrays and global corner indices
+	std::vector<glm::vec3> positions(totals[0]);
+	std::vector<glm::vec2> uvs(totals[1]);
+	std::vector<glm::vec3> normals(totals[2]);
+	std::vector<uint8_t> invalid(chunks.size(), 0);
+
+	pool.parallelFor(chunks.size(), [&](uint32_t i){
+		ObjChunk & chunk = chunks[i];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.base[0]);
+		std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.base[1]);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.base[2]);
+		std::vector<glm::vec3>().swap(chunk.positions);
+		std::vector<glm::vec2>().swap(chunk.uvs);
+		std::vector<glm::vec3>().swap(chunk.normals);
+
+		for (size_t c = 0; c < chunk.corners.size(); c++){
+			ObjCorner & corner = chunk.corners[c];
+			for (int a = 0; a < 3; a++){
+				if (corner.index[a] == OBJ_MISSING) continue;
+				int64_t index = corner.index[a];
+				if (corner.relative & (1 << a)) index += chunk.base[a];
+				if (index < 0 || (size_t)index >= totals[a]){
+					invalid[i] = 1;
+					index = OBJ_MISSING;
+				}
+				corner.index[a] = (int32_t)index;
+			}
+			if (corner.index[0] == OBJ_MISSING) invalid[i] = 1;
+		}
+	});
+
+	for (size_t i = 0; i < chunks.size(); i++){
+		if (invalid[i]){
+			printf("%s: face index out of range\n", path);
+			return false;
+		}
+	}
+
+	// Pass 3, weld the corners into indexed output
+	ObjWelder welder(cornerCount);
+	out_indices.reserve(out_indices.size() + cornerCount);
+	uint32_t base = out_vertices.size();
+	for (size_t i = 0; i < chunks.size(); i++){
+		const std::vector<ObjCorner> & corners = chunks[i].corners;
+		for (size_t c = 0; c < corners.size(); c++){
+			const ObjCorner & corner = corners[c];
+			uint32_t index;
+			if (!welder.findOrInsert(corner.index, out_vertices.size() - base, index)){
+				index = out_vertices.size() - base;
+				out_vertices.push_back(positions[corner.index[0]]);
+				out_uvs.push_back(corner.index[1] != OBJ_MISSING ? uvs[corner.index[1]] : glm::vec2(0.0f, 0.0f));
+				out_normals.push_back(corner.index[2] != OBJ_MISSING ? normals[corner.index[2]] : glm::vec3(0.0f, 0.0f, 0.0f));
+			}
+			out_indices.push_back(base + index);
+		}
+		std::vector<ObjCorner>().swap(chunks[i].corners);
+	}
+
+	printf("%s: %lu triangles, %lu vertices\n", path,
+		(unsigned long)(cornerCount / 3), (unsigned long)(out_vertices.size() - base));
+	return true;
+}
+
+
+// ---------------------------------------------------------------------------
+// Streaming OBJ reader
+//
+// Reads the file through a fixed buffer and hands out indexed meshes of at
+// most maxVertices vertices as soon as they are full. The de-indexed corners
+// and the output never exist in full, only one chunk of each does. A face may
+// use any v/vt/vn read before it, so those go to a temporary file; only the
+// latest block and a few recently used blocks of each stay in memory.
+// ---------------------------------------------------------------------------
+
+#define OBJ_STREAM_BUFFER_SIZE (1 << 20)
+#define OBJ_POOL_BLOCK_SIZE (1 << 16)	// Attributes per pool block
+#define OBJ_POOL_CACHED_BLOCKS 16		// Written blocks kept in memory, per pool
+
+// Every attribute of one kind read so far. Full blocks are written to an
+// unlinked temporary file and read back on demand into a small LRU cache;
+// scanned meshes mostly use attributes close to the face, so misses are rare.
+template <typename T>
+class ObjSpillPool{
+public:
+	ObjSpillPool() :
+		file_(NULL),
+		written_(0),
+		clock_(0)
+	{
+		tail_.reserve(OBJ_POOL_BLOCK_SIZE);
+	}
+
+	~ObjSpillPool(){
+		if (file_ != NULL) fclose(file_);
+	}
+
+	size_t size(){ return written_ + tail_.size(); }
+
+	bool push(const T & value){
+		tail_.push_back(value);
+		if (tail_.size() < OBJ_POOL_BLOCK_SIZE) return true;
+
+		// Full, write it out
+		if (file_ == NULL){
+			file_ = tmpfile();
+			if (file_ == NULL){
+				printf("Impossible to create the attribute pool file: %s\n", strerror(errno));
+				return false;
+			}
+		}
+		if (!transfer(true, tail_.data(), written_)) return false;
+		written_ += tail_.size();
+		tail_.clear();
+		return true;
+	}
+
+	bool get(size_t index, T & value){
+		if (index >= written_){
+			value = tail_[index - written_];
+			return true;
+		}
+
+		size_t first = index - index % OBJ_POOL_BLOCK_SIZE;
+		Block * slot = &cache_[0];
+		for (int b = 0; b < OBJ_POOL_CACHED_BLOCKS; b++){
+			Block & block = cache_[b];
+			if (!block.data.empty() && block.first == first){
+				slot = &block;
+				break;
+			}
+			if (block.used < slot->used) slot = &block;	// Least recently used
+		}
+		if (slot->data.empty() || slot->first != first){
+			slot->data.resize(OBJ_POOL_BLOCK_SIZE);
+			if (!transfer(false, slot->data.data(), first)){
+				slot->data.clear();
+				return false;
+			}
+			slot->first = first;
+		}
+		slot->used = ++clock_;
+		value = slot->data[index - first];
+		return true;
+	}
+
+private:
+	// One block, first is the index of its first attribute
+	bool transfer(bool write, T * data, size_t first){
+		int fd = fileno(file_);
+		char * bytes = (char *)data;
+		size_t left = OBJ_POOL_BLOCK_SIZE * sizeof(T);
+		off_t offset = (off_t)(first * sizeof(T));
+		while (left > 0){
+			ssize_t done = write ? pwrite(fd, bytes, left, offset) : pread(fd, bytes, left, offset);
+			if (done < 0 && errno == EINTR) continue;
+			if (done <= 0){
+				printf("Impossible to %s the attribute pool file: %s\n",
+					write ? "write" : "read", done < 0 ? strerror(errno) : "end of file");
+				return false;
+			}
+			bytes += done;
+			left -= done;
+			offset += done;
+		}
+		return true;
+	}
+
+	struct Block{
+		Block() : first(0), used(0) {}
+		std::vector<T> data;	// Empty until used
+		size_t first;
+		uint64_t used;			// clock_ of the last get
+	};
+
+	FILE * file_;				// Created with the first full block
+	size_t written_;			// Attributes in the file
+	std::vector<T> tail_;		// The ones after them
+	Block cache_[OBJ_POOL_CACHED_BLOCKS];
+	uint64_t clock_;
+};
+
+// Collects triangles into an ObjMeshChunk, flushes it when full
+class ObjChunkBuilder{
+public:
+	ObjChunkBuilder(size_t maxVertices, const std::function<void(ObjMeshChunk &)> & callback) :
+		maxVertices_(maxVertices < 3 ? 3 : maxVertices),
+		welder_(maxVertices_),
+		callback_(callback),
+		chunks_(0)
+	{
+	}
+
+	bool addTriangle(const ObjCorner * corners,
+		ObjSpillPool<glm::vec3> & positions,
+		ObjSpillPool<glm::vec2> & uvs,
+		ObjSpillPool<glm::vec3> & normals
+	){
+		// All three corners go in the same chunk
+		if (chunk_.vertices.size() + 3 > maxVertices_) flush();
+
+		for (int c = 0; c < 3; c++){
+			const ObjCorner & corner = corners[c];
+			uint32_t index;
+			if (!welder_.findOrInsert(corner.index, chunk_.vertices.size(), index)){
+				index = chunk_.vertices.size();
+				glm::vec3 position;
+				glm::vec2 uv(0.0f, 0.0f);
+				glm::vec3 normal(0.0f, 0.0f, 0.0f);
+				if (!positions.get(corner.index[0], position) ||
+					(corner.index[1] != OBJ_MISSING && !uvs.get(corner.index[1], uv)) ||
+					(corner.index[2] != OBJ_MISSING && !normals.get(corner.index[2], normal))){
+					return false;
+				}
+				chunk_.vertices.push_back(position);
+				chunk_.uvs.push_back(uv);
+				chunk_.normals.push_back(normal);
+			}
+			chunk_.indices.push_back(index);
+		}
+		return true;
+	}
+
+	void flush(){
+		if (chunk_.indices.empty()) return;
+
+		callback_(chunk_);
+		chunks_++;
+
+		// The callback may have taken the arrays, start over either way
+		chunk_.indices.clear();
+		chunk_.vertices.clear();
+		chunk_.uvs.clear();
+		chunk_.normals.clear();
+		welder_.clear();
+	}
+
+	size_t getChunkCount(){ return chunks_; }
+
+private:
+	size_t maxVertices_;
+	ObjWelder welder_;
+	const std::function<void(ObjMeshChunk &)> & callback_;
+	ObjMeshChunk chunk_;
+	size_t chunks_;
+};
+
+bool loadOBJ_stream(
+	const char * path,
+	size_t maxVertices,
+	const std::function<void(ObjMeshChunk &)> & callback
+){
+	printf("Streaming OBJ file %s...\n", path);
+
+	FILE * file = fopen(path, "rb");
+	if (file == NULL){
+		printf("Impossible to open %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	ObjSpillPool<glm::vec3> positions;
+	ObjSpillPool<glm::vec2> uvs;
+	ObjSpillPool<glm::vec3> normals;
+	ObjChunkBuilder builder(maxVertices, callback);
+
+	std::vector<char> buffer(OBJ_STREAM_BUFFER_SIZE);
+	size_t filled = 0;
+	size_t triangles = 0;
+	ObjChunk block;
+	bool eof = false;
+
+	while (!eof){
+		size_t read = fread(&buffer[filled], 1, buffer.size() - filled, file);
+		filled += read;
+		eof = (read == 0);
+
+		// Parse up to the last complete line, all of it at the end
+		const char * begin = buffer.data();
+		const char * end = begin + filled;
+		if (!eof){
+			const char * last = end;
+			while (last > begin && last[-1] != '\n') last--;
+			if (last == begin){
+				// A line longer than the buffer, make room and read on
+				buffer.resize(buffer.size() * 2);
+				continue;
+			}
+			end = last;
+		}
+
+		block.begin = begin;
+		block.end = end;
+		block.positions.clear();
+		block.uvs.clear();
+		block.normals.clear();
+		block.corners.clear();
+		objParseChunk(block);
+		if (!block.ok){
+			printf("%s: malformed line\n", path);
+			fclose(file);
+			return false;
+		}
+
+		// Chunk local indices are relative to what was read before this block
+		size_t base[3] = { positions.size(), uvs.size(), normals.size() };
+		bool pooled = true;
+		for (size_t i = 0; pooled && i < block.positions.size(); i++) pooled = positions.push(block.positions[i]);
+		for (size_t i = 0; pooled && i < block.uvs.size(); i++) pooled = uvs.push(block.uvs[i]);
+		for (size_t i = 0; pooled && i < block.normals.size(); i++) pooled = normals.push(block.normals[i]);
+		if (!pooled){
+			fclose(file);
+			return false;
+		}
+		size_t totals[3] = { positions.size(), uvs.size(), normals.size() };
+
+		for (size_t c = 0; c < block.corners.size(); c++){
+			ObjCorner & corner = block.corners[c];
+			for (int a = 0; a < 3; a++){
+				if (corner.index[a] == OBJ_MISSING) continue;
+				int64_t index = corner.index[a];
+				if (corner.relative & (1 << a)) index += base[a];
+				if (index < 0 || (size_t)index >= totals[a]){
+					printf("%s: face index out of range\n", path);
+					fclose(file);
+					return false;
+				}
+				corner.index[a] = (int32_t)index;
+			}
+			if (c % 3 == 2){
+				if (!builder.addTriangle(&block.corners[c - 2], positions, uvs, normals)){
+					fclose(file);
+					return false;
+				}
+				triangles++;
+			}
+		}
+
+		// Keep the partial line for the next read
+		filled -= end - begin;
+		memmove(buffer.data(), end, filled);
+	}
+	fclose(file);
+
+	builder.flush();
+	printf("%s: %lu triangles in %lu chunks\n", path,
+		(unsigned long)triangles, (unsigned long)builder.getChunkCount());
+	return true;
+}
+
+
 #ifdef USE_ASSIMP // don't use this #define, it's only for me (it AssImp fails to compile on your machine, at least all the other tutorials still work)
 
 // Include AssImp
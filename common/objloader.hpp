@@ -1,6 +1,8 @@
 #ifndef OBJLOADER_H
 #define OBJLOADER_H
 
+#include <functional>
+
 bool loadOBJ(
 	const char * path, 
 	std::vector<glm::vec3> & out_vertices, 
@@ -8,6 +10,34 @@ bool loadOBJ(
 	std::vector<glm::vec3> & out_normals
 );
 
+// mmapped and parsed in parallel, n-gons, negative indices, optional
+// uvs and normals. Outputs an indexed mesh, appended to the out_ arrays.
+bool loadOBJ_fast(
+	const char * path,
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+);
+
+// One indexed piece of a streamed mesh, indices are local to the chunk
+struct ObjMeshChunk{
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+};
+
+// Reads through a fixed buffer and calls back with chunks of at most
+// maxVertices vertices as they fill up. The callback may move the arrays
+// out. Memory stays bounded whatever the file size: the v/vt/vn read so far
+// are kept in a temporary file, with a few blocks of each cached.
+bool loadOBJ_stream(
+	const char * path,
+	size_t maxVertices,
+	const std::function<void(ObjMeshChunk &)> & callback
+);
+
 
 
 bool loadAssImp(
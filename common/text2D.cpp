@@ -12,6 +12,8 @@ using namespace glm;
 
 #include "text2D.hpp"
 
+#include "GLState.hpp"
+
 unsigned int Text2DTextureID;
 unsigned int Text2DVertexBufferID;
 unsigned int Text2DUVBufferID;
@@ -79,11 +81,10 @@ void printText2D(const char * text, int x, int y, int size){
 	glBufferData(GL_ARRAY_BUFFER, UVs.size() * sizeof(glm::vec2), &UVs[0], GL_STATIC_DRAW);
 
 	// Bind shader
-	glUseProgram(Text2DShaderID);
+	GLState::get().useProgram(Text2DShaderID);
 
 	// Bind texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, Text2DTextureID);
+	GLState::get().bindTexture(0, Text2DTextureID);
 	// Set our "myTextureSampler" sampler to use Texture Unit 0
 	glUniform1i(Text2DUniformID, 0);
 
@@ -116,9 +117,11 @@ void cleanupText2D(){
 	glDeleteBuffers(1, &Text2DVertexBufferID);
 	glDeleteBuffers(1, &Text2DUVBufferID);
 
-	// Delete texture
+	// Delete texture, GLState may still think it is bound
+	GLState::get().forgetTexture(Text2DTextureID);
 	glDeleteTextures(1, &Text2DTextureID);
 
-	// Delete shader
+	// Delete shader, same for the program
+	GLState::get().forgetProgram(Text2DShaderID);
 	glDeleteProgram(Text2DShaderID);
 }
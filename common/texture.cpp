@@ -6,6 +6,8 @@
 
 #include <glfw3.h>
 
+#include "GLState.hpp"
+
 
 GLuint loadBMP_custom(const char * imagepath){
 
@@ -69,7 +71,7 @@ GLuint loadBMP_custom(const char * imagepath){
 	glGenTextures(1, &textureID);
 	
 	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::get().bindTexture(0, textureID);
 
 	// Give the image to OpenGL
 	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
@@ -187,7 +189,7 @@ GLuint loadDDS(const char * imagepath){
 	glGenTextures(1, &textureID);
 
 	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::get().bindTexture(0, textureID);
 	glPixelStorei(GL_UNPACK_ALIGNMENT,1);	
 	
 	unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16; 
@@ -1,5 +1,7 @@
 #include <vector>
 #include <map>
+#include <math.h>
+#include <stdint.h>
 
 #include <glm/glm.hpp>
 
@@ -74,27 +76,79 @@ void indexVBO_slow(
 	}
 }
 
-struct PackedVertex{
-	glm::vec3 position;
-	glm::vec2 uv;
-	glm::vec3 normal;
-	bool operator<(const PackedVertex that) const{
-		return memcmp((void*)this, (void*)&that, sizeof(PackedVertex))>0;
-	};
-};
+// Open addressing hash table for welding vertices in one pass.
+// Each output vertex gets a key of VERTEX_KEY_SIZE 64 bit words: the raw
+// float bits when epsilon is 0 (exact match, what the std::map version
+// did), or the attributes snapped to a grid of size epsilon otherwise.
+// Note that snapping is not quite is_near: two values closer than epsilon
+// but on either side of a cell border stay separate vertices.
+#define VERTEX_KEY_SIZE 8
 
-bool getSimilarVertexIndex_fast( 
-	PackedVertex & packed, 
-	std::map<PackedVertex,unsigned short> & VertexToOutIndex,
-	unsigned short & result
-){
-	std::map<PackedVertex,unsigned short>::iterator it = VertexToOutIndex.find(packed);
-	if ( it == VertexToOutIndex.end() ){
-		return false;
-	}else{
-		result = it->second;
-		return true;
+class VertexWelder {
+public:
+	VertexWelder(size_t expected, float epsilon) :
+		epsilon_(epsilon),
+		inverse_(epsilon > 0.0f ? 1.0 / epsilon : 0.0)
+	{
+		// Keep the load factor under 1/2
+		size_t capacity = 16;
+		while (capacity < expected * 2) capacity <<= 1;
+		mask_ = capacity - 1;
+		slots_.assign(capacity, EMPTY);
+
+	}
+
+	// Returns true and the index of an equal vertex if there is one,
+	// otherwise inserts the vertex under the index next, returns false.
+	bool findOrInsert(const float * attributes, uint32_t next, uint32_t & result){
+		int64_t key[VERTEX_KEY_SIZE];
+		uint64_t hash = makeKey(attributes, key);
+
+		for (size_t slot = hash & mask_; ; slot = (slot + 1) & mask_){
+			uint32_t index = slots_[slot];
+			if (index == EMPTY){
+				slots_[slot] = next;
+				keys_.insert(keys_.end(), key, key + VERTEX_KEY_SIZE);
+				return false;
+			}
+			if (memcmp(&keys_[(size_t)index * VERTEX_KEY_SIZE], key, sizeof(key)) == 0){
+				result = index;
+				return true;
+			}
+		}
 	}
+
+private:
+	enum { EMPTY = 0xFFFFFFFF };	// Free slot
+
+	uint64_t makeKey(const float * attributes, int64_t * key){
+		uint64_t hash = 14695981039346656037ULL; // FNV-1a over the words
+		for (int i = 0; i < VERTEX_KEY_SIZE; i++){
+			if (epsilon_ > 0.0f){
+				key[i] = (int64_t)floor(attributes[i] * inverse_ + 0.5);
+			}else{
+				uint32_t bits;
+				memcpy(&bits, &attributes[i], sizeof(bits));
+				key[i] = bits;
+			}
+			hash = (hash ^ (uint64_t)key[i]) * 1099511628211ULL;
+		}
+		// FNV mixes the low bits poorly, fold the high ones in
+		return hash ^ (hash >> 29);
+	}
+
+	float epsilon_;
+	double inverse_;
+	size_t mask_;
+	std::vector<uint32_t> slots_;	// Output vertex index per slot
+	std::vector<int64_t> keys_;		// Keys of the output vertices
+};
+
+// Position, uv and normal side by side, the welder key
+static void packVertex(const glm::vec3 & position, const glm::vec2 & uv, const glm::vec3 & normal, float * packed){
+	packed[0] = position.x; packed[1] = position.y; packed[2] = position.z;
+	packed[3] = uv.x;       packed[4] = uv.y;
+	packed[5] = normal.x;   packed[6] = normal.y;   packed[7] = normal.z;
 }
 
 void indexVBO(
@@ -102,22 +156,28 @@ void indexVBO(
 	std::vector<glm::vec2> & in_uvs,
 	std::vector<glm::vec3> & in_normals,
 
-	std::vector<unsigned short> & out_indices,
+	std::vector<unsigned int> & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
-	std::vector<glm::vec3> & out_normals
+	std::vector<glm::vec3> & out_normals,
+
+	float epsilon
 ){
-	std::map<PackedVertex,unsigned short> VertexToOutIndex;
+	// The welder counts from 0, the out_ arrays may already hold vertices
+	VertexWelder welder(in_vertices.size(), epsilon);
+	size_t base = out_vertices.size();
+	out_indices.reserve(out_indices.size() + in_vertices.size());
 
 	// For each input vertex
 	for ( unsigned int i=0; i<in_vertices.size(); i++ ){
 
-		PackedVertex packed = {in_vertices[i], in_uvs[i], in_normals[i]};
-		
+		float packed[VERTEX_KEY_SIZE];
+		packVertex(in_vertices[i], in_uvs[i], in_normals[i], packed);
 
 		// Try to find a similar vertex in out_XXXX
-		unsigned short index;
-		bool found = getSimilarVertexIndex_fast( packed, VertexToOutIndex, index);
+		uint32_t index = 0;
+		bool found = welder.findOrInsert(packed, out_vertices.size() - base, index);
+		index += base;
 
 		if ( found ){ // A similar vertex is already in the VBO, use it instead !
 			out_indices.push_back( index );
@@ -125,9 +185,7 @@ void indexVBO(
 			out_vertices.push_back( in_vertices[i]);
 			out_uvs     .push_back( in_uvs[i]);
 			out_normals .push_back( in_normals[i]);
-			unsigned short newindex = (unsigned short)out_vertices.size() - 1;
-			out_indices .push_back( newindex );
-			VertexToOutIndex[ packed ] = newindex;
+			out_indices .push_back( (unsigned int)out_vertices.size() - 1 );
 		}
 	}
 }
@@ -145,19 +203,30 @@ void indexVBO_TBN(
 	std::vector<glm::vec3> & in_tangents,
 	std::vector<glm::vec3> & in_bitangents,
 
-	std::vector<unsigned short> & out_indices,
+	std::vector<unsigned int> & out_indices,
 	std::vector<glm::vec3> & out_vertices,
 	std::vector<glm::vec2> & out_uvs,
 	std::vector<glm::vec3> & out_normals,
 	std::vector<glm::vec3> & out_tangents,
-	std::vector<glm::vec3> & out_bitangents
+	std::vector<glm::vec3> & out_bitangents,
+
+	float epsilon
 ){
+	// The welder counts from 0, the out_ arrays may already hold vertices
+	VertexWelder welder(in_vertices.size(), epsilon);
+	size_t base = out_vertices.size();
+	out_indices.reserve(out_indices.size() + in_vertices.size());
+
 	// For each input vertex
 	for ( unsigned int i=0; i<in_vertices.size(); i++ ){
 
+		float packed[VERTEX_KEY_SIZE];
+		packVertex(in_vertices[i], in_uvs[i], in_normals[i], packed);
+
 		// Try to find a similar vertex in out_XXXX
-		unsigned short index;
-		bool found = getSimilarVertexIndex(in_vertices[i], in_uvs[i], in_normals[i],     out_vertices, out_uvs, out_normals, index);
+		uint32_t index = 0;
+		bool found = welder.findOrInsert(packed, out_vertices.size() - base, index);
+		index += base;
 
 		if ( found ){ // A similar vertex is already in the VBO, use it instead !
 			out_indices.push_back( index );
@@ -171,7 +240,85 @@ void indexVBO_TBN(
 			out_normals .push_back( in_normals[i]);
 			out_tangents .push_back( in_tangents[i]);
 			out_bitangents .push_back( in_bitangents[i]);
-			out_indices .push_back( (unsigned short)out_vertices.size() - 1 );
+			out_indices .push_back( (unsigned int)out_vertices.size() - 1 );
+		}
+	}
+}
+
+// Narrows the indices, offset by base, into out_indices. Returns false,
+// and leaves out_indices alone, if one of them doesn't fit in 16 bits.
+static bool narrowIndices(const std::vector<unsigned int> & indices, size_t base, std::vector<unsigned short> & out_indices){
+	for ( size_t i=0; i<indices.size(); i++ ){
+		if ( indices[i] + base > 0xFFFF ){
+			return false;
 		}
 	}
+	out_indices.reserve(out_indices.size() + indices.size());
+	for ( size_t i=0; i<indices.size(); i++ ){
+		out_indices.push_back( (unsigned short)(indices[i] + base) );
+	}
+	return true;
+}
+
+template<class T>
+static void append(std::vector<T> & out, const std::vector<T> & in){
+	out.insert(out.end(), in.begin(), in.end());
+}
+
+bool indexVBO(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+
+	float epsilon
+){
+	// Welded into locals, the out_ arrays only grow if the indices fit
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> vertices, normals;
+	std::vector<glm::vec2> uvs;
+	indexVBO(in_vertices, in_uvs, in_normals, indices, vertices, uvs, normals, epsilon);
+	if ( !narrowIndices(indices, out_vertices.size(), out_indices) ){
+		return false;
+	}
+	append(out_vertices, vertices);
+	append(out_uvs, uvs);
+	append(out_normals, normals);
+	return true;
+}
+
+bool indexVBO_TBN(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+	std::vector<glm::vec3> & in_tangents,
+	std::vector<glm::vec3> & in_bitangents,
+
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> & out_tangents,
+	std::vector<glm::vec3> & out_bitangents,
+
+	float epsilon
+){
+	std::vector<unsigned int> indices;
+	std::vector<glm::vec3> vertices, normals, tangents, bitangents;
+	std::vector<glm::vec2> uvs;
+	indexVBO_TBN(in_vertices, in_uvs, in_normals, in_tangents, in_bitangents,
+		indices, vertices, uvs, normals, tangents, bitangents, epsilon);
+	if ( !narrowIndices(indices, out_vertices.size(), out_indices) ){
+		return false;
+	}
+	append(out_vertices, vertices);
+	append(out_uvs, uvs);
+	append(out_normals, normals);
+	append(out_tangents, tangents);
+	append(out_bitangents, bitangents);
+	return true;
 }
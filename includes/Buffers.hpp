@@ -23,6 +23,19 @@
 #include <vector>
 
 #include "BinDataUtils.hpp"
+#include "GLState.hpp"
+
+/**
+ * ******************************************************
+ * What happens to the CPU side copy of the buffer data
+ * once it was uploaded.
+ * ******************************************************
+**/
+typedef enum {
+    BR_DISCARD      = 0,    /* Upload only, nothing kept in RAM */
+    BR_READBACK     = 1,    /* Keep a copy for the CPU to read back */
+    BR_DEBUG        = 2,    /* Keep a copy for hexDump */
+} BufferRetention;
 
 /**
  * ******************************************************
@@ -42,17 +55,21 @@ class Buffer{
          * @param[in] dType         - draw type; how the data will be drawn 
          * @param[in] data          - buffer data
          * @param[in] size          - buffer data size
+         * @param[in] retention     - whether a CPU copy is kept after the upload
          * ******************************************************
         **/
-        Buffer(uint32_t bType, uint32_t dType, const T* data, size_t size):
-            bType_(bType), dType_(dType), size_(size)
+        Buffer(uint32_t bType, uint32_t dType, const T* data, size_t size,
+                BufferRetention retention = BR_DISCARD):
+            bType_(bType), dType_(dType), size_(size), retention_(retention)
         {
             LOG(L_DBG, "Allocating buffer %d, with size %ld.", bType, size_);
-            uptrData_.reset( (T*) malloc(size_) );
-            memcpy(uptrData_.get(), data, size_);
+            if (retention_ != BR_DISCARD) {
+                uptrData_.reset(new uint8_t[size_]);
+                memcpy(uptrData_.get(), data, size_);
+            }
             glGenBuffers(1 /* Generate one buffer */, &handler_);
             glBindBuffer(bType_, handler_);
-            glBufferData(bType_, size_, uptrData_.get(), dType_); 
+            glBufferData(bType_, size_, data, dType_); 
 
             hexDumpMask_ = setHexDumpMask(typeid(T).name());
         }
@@ -110,16 +127,99 @@ class Buffer{
         void hexDump()
         {
             LOG(L_DBG, "Buffer %d:", handler_);
-            DumpHex(uptrData_.get(), size_, hexDumpMask_);
+            if (uptrData_) {
+                DumpHex(uptrData_.get(), size_, hexDumpMask_);
+                return;
+            }
+
+            /* Nothing retained, read it back. The copy target leaves the VAO bindings alone. */
+            std::unique_ptr<uint8_t[]> data(new uint8_t[size_]);
+            glBindBuffer(GL_COPY_READ_BUFFER, handler_);
+            glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size_, data.get());
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            DumpHex(data.get(), size_, hexDumpMask_);
         }
 
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        uint32_t getHandler() { return handler_; }
+        size_t getSize() { return size_; }
+
+        /* The retained copy, NULL with BR_DISCARD */
+        const T* getData() { return (const T*) uptrData_.get(); }
+
+        /* Bytes held in RAM for this buffer */
+        size_t getRetainedSize() { return uptrData_ ? size_ : 0; }
+
     private: /*Members */
-        uint32_t            bType_;     /* Buffer type */
-        uint32_t            dType_;     /* Draw type */
+        uint32_t                    bType_;     /* Buffer type */
+        uint32_t                    dType_;     /* Draw type */
+        uint32_t                    handler_;   /* Buffer handler */
+        size_t                      size_;      /* Buffer size */
+        BufferRetention             retention_; /* CPU copy policy */
+        uint8_t                     hexDumpMask_;
+        std::unique_ptr<uint8_t[]>  uptrData_;  /* CPU copy, unless discarded */
+};
+
+
+/**
+ * ******************************************************
+ * @brief Uniform buffer class
+ *
+ * Templated by the std140 mirror struct of the block, see
+ * UniformBlocks.hpp. The buffer stays bound to its binding
+ * point; every Program that binds the block to the same
+ * point reads the same data.
+ * ******************************************************
+**/
+template<class T>
+class UniformBuffer {
+    public: /* Constructors */
+        /**
+         * ******************************************************
+         * Constructor
+         *
+         * @param[in] binding       - uniform buffer binding point
+         * ******************************************************
+        **/
+        UniformBuffer(uint32_t binding) :
+            binding_(binding)
+        {
+            LOG(L_DBG, "Allocating uniform buffer %d, with size %ld.", binding_, sizeof(T));
+            glGenBuffers(1 /* Generate one buffer */, &handler_);
+            glBindBuffer(GL_UNIFORM_BUFFER, handler_);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(T), NULL, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, binding_, handler_);
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Upload the whole block
+         *
+         * @param[in] data
+         * ******************************************************
+        **/
+        void update(const T& data)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, handler_);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        uint32_t getHandler() { return handler_; }
+        uint32_t getBinding() { return binding_; }
+
+    private: /*Members */
+        uint32_t            binding_;   /* Binding point */
         uint32_t            handler_;   /* Buffer handler */
-        size_t              size_;      /* Buffer size */
-        uint8_t             hexDumpMask_;
-        std::unique_ptr<T>  uptrData_;  /* Data to be drawn */ // TODO should I really save this?
 };
 
 
@@ -202,7 +302,7 @@ class VertexArray {
         VertexArray()
         {
             glGenVertexArrays(1 /* Numbers of Vertex arrays */, &handler_);
-            glBindVertexArray(handler_);
+            GLState::get().bindVertexArray(handler_);
             attrPtrs_.reserve(16 /* 16 attributes */);
         }
 
@@ -241,14 +341,21 @@ class VertexArray {
         uint32_t getHandler() { return handler_; };
         /**
          * ******************************************************
-         * Emplace back for buffer format 
+         * Set the buffer format at id, replacing the one there.
+         * Reads from the buffer bound to GL_ARRAY_BUFFER, so an
+         * attribute can be pointed at another buffer.
          * ******************************************************
         **/
         void attribPointer(uint32_t id, size_t size, uint32_t type, 
                 bool normalized, size_t stride, size_t offset)
         {
-            LOG(L_ERR, "NOT IMPLEMENTED!");
-            // TODO, not sure if replacing attribute format at id is needed or a good idea
+            if (id > attrPtrs_.size()) {
+                LOG(L_ERR, "Attribute %u set before attribute %lu.", id, (unsigned long)attrPtrs_.size());
+                return;
+            }
+            if (id == attrPtrs_.size()) attrPtrs_.emplace_back(size, type, normalized, stride, offset);
+            else                        attrPtrs_[id] = BufferFormat(size, type, normalized, stride, offset);
+            glVertexAttribPointer(id, size, type, normalized, stride, (void*)offset);
         }
 
         /**
@@ -318,6 +425,19 @@ class VertexArray {
             glEnableVertexAttribArray(id);
         }
 
+        /**
+         * ******************************************************
+         * @brief Advance an attribute per instance, not per vertex
+         *
+         * @param[in] id        - the id of the attribute array
+         * @param[in] divisor   - instances per element, 0 per vertex
+         * ******************************************************
+        **/
+        void attribDivisor(uint32_t id, uint32_t divisor)
+        {
+            glVertexAttribDivisor(id, divisor);
+        }
+
         /**
          * ******************************************************
          * @brief Enable all attribute arrays.
@@ -0,0 +1,318 @@
+/******************************************
+
+* File Name : includes/DDSFile.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Reads and writes block compressed DDS files with their mip chain.
+ * BC1, BC3 and BC5 use the legacy FourCC header, BC7 the DX10 one.
+ * No GL in here, tools/texcompress writes these and Texture uploads
+ * them.
+ *
+ * The rows are stored bottom up, the way Texture uploads the images
+ * stb_image decodes, so a DDS can replace the PNG next to it with the
+ * same texture coordinates. Files from other tools are top down.
+ */
+
+#ifndef _LOGL_DDS_FILE_HPP_
+#define _LOGL_DDS_FILE_HPP_
+
+/* STD */
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Utils.hpp"
+
+#define DDS_MAGIC               0x20534444  /* "DDS " */
+#define DDS_FOURCC(a, b, c, d)  ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+#define DDSD_CAPS               0x00000001
+#define DDSD_HEIGHT             0x00000002
+#define DDSD_WIDTH              0x00000004
+#define DDSD_PIXELFORMAT        0x00001000
+#define DDSD_MIPMAPCOUNT        0x00020000
+#define DDSD_LINEARSIZE         0x00080000
+#define DDPF_FOURCC             0x00000004
+#define DDSCAPS_COMPLEX         0x00000008
+#define DDSCAPS_TEXTURE         0x00001000
+#define DDSCAPS_MIPMAP          0x00400000
+
+#define DXGI_FORMAT_BC7_UNORM   98
+#define DDS_DIMENSION_TEXTURE2D 3
+
+/**
+ * ******************************************************
+ * Block formats
+ * ******************************************************
+**/
+typedef enum {
+    BF_UNKNOWN  = 0,
+    BF_BC1      = 1,    /* RGB, 1 bit alpha, 8 bytes per block */
+    BF_BC3      = 3,    /* RGBA, 16 bytes per block */
+    BF_BC5      = 5,    /* RG, two channel normal maps, 16 bytes per block */
+    BF_BC7      = 7,    /* RGBA, 16 bytes per block */
+} BlockFormat;
+
+/**
+ * ******************************************************
+ * On disk headers, after the magic
+ * ******************************************************
+**/
+struct DDSPixelFormat {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t masks[4];
+};
+
+struct DDSHeader {
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        linearSize;
+    uint32_t        depth;
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDSPixelFormat  pixelFormat;
+    uint32_t        caps[4];
+    uint32_t        reserved2;
+};
+
+struct DDSHeaderDX10 {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDS header layout");
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDS DX10 header layout");
+
+/**
+ * ******************************************************
+ * @brief DDS file, one 2D texture and its mip chain
+ * ******************************************************
+**/
+class DDSFile {
+    public: /* Constructors */
+        DDSFile() :
+            format_(BF_UNKNOWN), width_(0), height_(0)
+        {
+        }
+
+        /**
+         * ******************************************************
+         * An empty file, the levels are added with addLevel
+         *
+         * @param[in] format
+         * @param[in] width         - of level 0
+         * @param[in] height        - of level 0
+         * ******************************************************
+        **/
+        DDSFile(BlockFormat format, uint32_t width, uint32_t height) :
+            format_(format), width_(width), height_(height)
+        {
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Bytes per 4x4 block
+         * ******************************************************
+        **/
+        static uint32_t blockSize(BlockFormat format)
+        {
+            return format == BF_BC1 ? 8 : 16;
+        }
+
+        /**
+         * ******************************************************
+         * Bytes of a level, partial blocks are padded
+         * ******************************************************
+        **/
+        static size_t levelSize(BlockFormat format, uint32_t width, uint32_t height)
+        {
+            size_t blocksX = width  ? (width + 3) / 4 : 1;
+            size_t blocksY = height ? (height + 3) / 4 : 1;
+            return blocksX * blocksY * blockSize(format);
+        }
+
+        /**
+         * ******************************************************
+         * Append the next level of the chain
+         *
+         * @param[in] blocks        - levelSize() bytes
+         * ******************************************************
+        **/
+        void addLevel(const uint8_t* blocks)
+        {
+            uint32_t level = levels_.size();
+            size_t size = levelSize(format_, getLevelWidth(level), getLevelHeight(level));
+            levels_.push_back(data_.size());
+            data_.insert(data_.end(), blocks, blocks + size);
+        }
+
+        /**
+         * ******************************************************
+         * Read a file
+         *
+         * @param[in] path
+         *
+         * @return false if it is not a BC1/3/5/7 2D texture
+         * ******************************************************
+        **/
+        bool read(const char* path)
+        {
+            FILE* file = fopen(path, "rb");
+            if (file == NULL) {
+                LOG(L_ERR, "Could not open %s.", path);
+                return false;
+            }
+
+            uint32_t magic = 0;
+            DDSHeader header;
+            bool ok = fread(&magic, sizeof(magic), 1, file) == 1 && magic == DDS_MAGIC &&
+                fread(&header, sizeof(header), 1, file) == 1 && header.size == sizeof(header);
+
+            format_ = BF_UNKNOWN;
+            if (ok && (header.pixelFormat.flags & DDPF_FOURCC)) {
+                switch (header.pixelFormat.fourCC) {
+                    case DDS_FOURCC('D', 'X', 'T', '1'): format_ = BF_BC1; break;
+                    case DDS_FOURCC('D', 'X', 'T', '5'): format_ = BF_BC3; break;
+                    case DDS_FOURCC('A', 'T', 'I', '2'):
+                    case DDS_FOURCC('B', 'C', '5', 'U'): format_ = BF_BC5; break;
+                    case DDS_FOURCC('D', 'X', '1', '0'): {
+                        DDSHeaderDX10 dx10;
+                        ok = fread(&dx10, sizeof(dx10), 1, file) == 1 &&
+                            dx10.resourceDimension == DDS_DIMENSION_TEXTURE2D && dx10.arraySize <= 1;
+                        if (ok && dx10.dxgiFormat == DXGI_FORMAT_BC7_UNORM) format_ = BF_BC7;
+                        break;
+                    }
+                    default: break;
+                }
+            }
+            if (!ok || format_ == BF_UNKNOWN) {
+                LOG(L_ERR, "%s is not a BC1/BC3/BC5/BC7 DDS texture.", path);
+                fclose(file);
+                return false;
+            }
+
+            width_ = header.width;
+            height_ = header.height;
+            uint32_t count = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount ? header.mipMapCount : 1;
+
+            size_t size = 0;
+            levels_.clear();
+            for (uint32_t level = 0; level < count; level++) {
+                levels_.push_back(size);
+                size += levelSize(format_, getLevelWidth(level), getLevelHeight(level));
+            }
+            data_.resize(size);
+            ok = fread(data_.data(), 1, size, file) == size;
+            fclose(file);
+
+            if (!ok) LOG(L_ERR, "%s is truncated.", path);
+            return ok;
+        }
+
+        /**
+         * ******************************************************
+         * Write the file
+         *
+         * @param[in] path
+         * ******************************************************
+        **/
+        bool write(const char* path)
+        {
+            DDSHeader header;
+            memset(&header, 0, sizeof(header));
+            header.size         = sizeof(header);
+            header.flags        = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+            header.height       = height_;
+            header.width        = width_;
+            header.linearSize   = levelSize(format_, width_, height_);
+            header.mipMapCount  = levels_.size();
+            header.caps[0]      = DDSCAPS_TEXTURE;
+            if (levels_.size() > 1) {
+                header.flags    |= DDSD_MIPMAPCOUNT;
+                header.caps[0]  |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+            }
+            header.pixelFormat.size     = sizeof(DDSPixelFormat);
+            header.pixelFormat.flags    = DDPF_FOURCC;
+
+            DDSHeaderDX10 dx10;
+            memset(&dx10, 0, sizeof(dx10));
+            switch (format_) {
+                case BF_BC1: header.pixelFormat.fourCC = DDS_FOURCC('D', 'X', 'T', '1'); break;
+                case BF_BC3: header.pixelFormat.fourCC = DDS_FOURCC('D', 'X', 'T', '5'); break;
+                case BF_BC5: header.pixelFormat.fourCC = DDS_FOURCC('A', 'T', 'I', '2'); break;
+                case BF_BC7:
+                    header.pixelFormat.fourCC   = DDS_FOURCC('D', 'X', '1', '0');
+                    dx10.dxgiFormat             = DXGI_FORMAT_BC7_UNORM;
+                    dx10.resourceDimension      = DDS_DIMENSION_TEXTURE2D;
+                    dx10.arraySize              = 1;
+                    break;
+                default:
+                    LOG(L_ERR, "No format to write %s with.", path);
+                    return false;
+            }
+
+            FILE* file = fopen(path, "wb");
+            if (file == NULL) {
+                LOG(L_ERR, "Could not create %s.", path);
+                return false;
+            }
+            uint32_t magic = DDS_MAGIC;
+            bool ok = fwrite(&magic, sizeof(magic), 1, file) == 1 &&
+                fwrite(&header, sizeof(header), 1, file) == 1;
+            if (ok && format_ == BF_BC7) ok = fwrite(&dx10, sizeof(dx10), 1, file) == 1;
+            if (ok) ok = fwrite(data_.data(), 1, data_.size(), file) == data_.size();
+            ok = (fclose(file) == 0) && ok;
+
+            if (!ok) LOG(L_ERR, "Could not write %s.", path);
+            return ok;
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        BlockFormat getFormat() { return format_; }
+        uint32_t getWidth() { return width_; }
+        uint32_t getHeight() { return height_; }
+        uint32_t getLevelCount() { return levels_.size(); }
+        uint32_t getLevelWidth(uint32_t level) { return (width_ >> level) ? (width_ >> level) : 1; }
+        uint32_t getLevelHeight(uint32_t level) { return (height_ >> level) ? (height_ >> level) : 1; }
+        const uint8_t* getLevel(uint32_t level) { return data_.data() + levels_[level]; }
+        size_t getLevelSize(uint32_t level)
+        {
+            return levelSize(format_, getLevelWidth(level), getLevelHeight(level));
+        }
+        size_t getSize() { return data_.size(); }
+
+    private: /* Members */
+        BlockFormat             format_;    /* Block format */
+        uint32_t                width_;     /* Level 0 width */
+        uint32_t                height_;    /* Level 0 height */
+        std::vector<size_t>     levels_;    /* Offset of each level in data_ */
+        std::vector<uint8_t>    data_;      /* The blocks, levels back to back */
+};
+
+#endif
@@ -0,0 +1,127 @@
+/******************************************
+
+* File Name : includes/FrameTimeHistogram.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Frame time histogram, 1 ms buckets. Hitches show up in the tail
+ * percentiles and the slow frame count long before they move the
+ * average.
+ */
+
+#ifndef _LOGL_FRAME_TIME_HISTOGRAM_HPP_
+#define _LOGL_FRAME_TIME_HISTOGRAM_HPP_
+
+/* STD */
+#include <string>
+#include <stdint.h>
+#include <string.h>
+
+#include "Utils.hpp"
+
+#define FTH_BUCKETS         100     /* 0-99 ms, slower frames land in the last one */
+#define FTH_SLOW_FRAME_MS   33.3    /* Missed two vsyncs at 60 Hz */
+
+/**
+ * ******************************************************
+ * @brief Frame time histogram
+ * ******************************************************
+**/
+class FrameTimeHistogram {
+    public: /* Constructors */
+        FrameTimeHistogram()
+        {
+            reset();
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Count a frame
+         *
+         * @param[in] ms            - frame time
+         * ******************************************************
+        **/
+        void add(double ms)
+        {
+            uint32_t bucket = ms < 0.0 ? 0 : (uint32_t)ms;
+            if (bucket >= FTH_BUCKETS) bucket = FTH_BUCKETS - 1;
+            buckets_[bucket]++;
+            frames_++;
+            total_ += ms;
+            if (ms > max_) max_ = ms;
+            if (ms > FTH_SLOW_FRAME_MS) slow_++;
+        }
+
+        /**
+         * ******************************************************
+         * Upper edge of the bucket holding the p-th percentile
+         *
+         * @param[in] p             - in [0, 1]
+         * ******************************************************
+        **/
+        double percentile(double p)
+        {
+            uint64_t rank = (uint64_t)(p * frames_);
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < FTH_BUCKETS; i++) {
+                seen += buckets_[i];
+                if (seen > rank) return i + 1;
+            }
+            return FTH_BUCKETS;
+        }
+
+        /**
+         * ******************************************************
+         * Log the summary, and the buckets at debug level
+         *
+         * @param[in] label
+         * ******************************************************
+        **/
+        void print(const char* label)
+        {
+            if (frames_ == 0) return;
+
+            LOG(L_INFO, "%s: %lu frames, avg %.2f ms, p50 %.0f p95 %.0f p99 %.0f max %.2f ms, %lu over %.1f ms.",
+                    label, (unsigned long)frames_, total_ / frames_,
+                    percentile(0.50), percentile(0.95), percentile(0.99), max_,
+                    (unsigned long)slow_, FTH_SLOW_FRAME_MS);
+
+            for (uint32_t i = 0; i < FTH_BUCKETS; i++) {
+                if (buckets_[i] == 0) continue;
+                std::string bar((size_t)(buckets_[i] * 50 / frames_) + 1, '#');
+                LOG(L_DBG, "%3u ms %8lu %s", i, (unsigned long)buckets_[i], bar.c_str());
+            }
+        }
+
+        void reset()
+        {
+            memset(buckets_, 0, sizeof(buckets_));
+            frames_ = 0;
+            slow_ = 0;
+            total_ = 0.0;
+            max_ = 0.0;
+        }
+
+        uint64_t getFrames() { return frames_; }
+
+    private: /* Members */
+        uint64_t    buckets_[FTH_BUCKETS];  /* Frames per 1 ms */
+        uint64_t    frames_;                /* Frames counted */
+        uint64_t    slow_;                  /* Frames over FTH_SLOW_FRAME_MS */
+        double      total_;                 /* Sum, for the average */
+        double      max_;                   /* Slowest frame */
+};
+
+#endif
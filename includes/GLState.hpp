@@ -0,0 +1,230 @@
+/******************************************
+
+* File Name : includes/GLState.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Shadow of the bind state of the context: current program, active
+ * texture unit, the 2D / 2D array texture of each unit and the VAO.
+ * Binds that would set what is already current are filtered out.
+ *
+ * This only works if every bind goes through here. Code that binds
+ * behind its back (third party libs) must call invalidate() after,
+ * and deleted objects must be forgotten, since GL reuses the names.
+ */
+
+#ifndef _LOGL_GL_STATE_HPP_
+#define _LOGL_GL_STATE_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* STD */
+#include <stdint.h>
+#include <string.h>
+
+#define GLS_MAX_TEXTURE_UNITS   32
+
+/**
+ * ******************************************************
+ * Binds issued and filtered, reset once per frame
+ * ******************************************************
+**/
+struct GLStateStats {
+    uint64_t programBinds;
+    uint64_t programFiltered;
+    uint64_t unitSwitches;
+    uint64_t unitFiltered;
+    uint64_t textureBinds;
+    uint64_t textureFiltered;
+    uint64_t vaoBinds;
+    uint64_t vaoFiltered;
+};
+
+/**
+ * ******************************************************
+ * @brief GL state tracker, one per context
+ * ******************************************************
+**/
+class GLState {
+    public: /* Constructors */
+        GLState()
+        {
+            invalidate();
+            resetStats();
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * The tracker of the (only) context
+         * ******************************************************
+        **/
+        static GLState& get()
+        {
+            static GLState state;
+            return state;
+        }
+
+        /**
+         * ******************************************************
+         * glUseProgram
+         *
+         * @return true if the call was issued
+         * ******************************************************
+        **/
+        bool useProgram(uint32_t program)
+        {
+            if (program_ == program) {
+                stats_.programFiltered++;
+                return false;
+            }
+            glUseProgram(program);
+            program_ = program;
+            stats_.programBinds++;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * glActiveTexture
+         *
+         * @param[in] unit          - unit index, not GL_TEXTUREi
+         *
+         * @return true if the call was issued
+         * ******************************************************
+        **/
+        bool activeTexture(uint32_t unit)
+        {
+            if (unit_ == unit) {
+                stats_.unitFiltered++;
+                return false;
+            }
+            glActiveTexture(GL_TEXTURE0 + unit);
+            unit_ = unit;
+            stats_.unitSwitches++;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * glBindTexture on a unit. Only switches the active unit
+         * when the bind is actually issued.
+         *
+         * @param[in] unit          - unit index
+         * @param[in] texture       - texture name
+         * @param[in] target        - GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY,
+         *                            other targets are not filtered
+         *
+         * @return true if the call was issued
+         * ******************************************************
+        **/
+        bool bindTexture(uint32_t unit, uint32_t texture, uint32_t target = GL_TEXTURE_2D)
+        {
+            int32_t slot = targetSlot(target);
+            if (slot >= 0 && unit < GLS_MAX_TEXTURE_UNITS &&
+                    textures_[slot][unit] == texture) {
+                stats_.textureFiltered++;
+                return false;
+            }
+            activeTexture(unit);
+            glBindTexture(target, texture);
+            if (slot >= 0 && unit < GLS_MAX_TEXTURE_UNITS) textures_[slot][unit] = texture;
+            stats_.textureBinds++;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * glBindVertexArray
+         *
+         * @return true if the call was issued
+         * ******************************************************
+        **/
+        bool bindVertexArray(uint32_t vao)
+        {
+            if (vao_ == vao) {
+                stats_.vaoFiltered++;
+                return false;
+            }
+            glBindVertexArray(vao);
+            vao_ = vao;
+            stats_.vaoBinds++;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Drop deleted objects, GL may hand the name out again
+         * ******************************************************
+        **/
+        void forgetTexture(uint32_t texture)
+        {
+            for (uint32_t slot = 0; slot < TARGET_SLOTS; slot++) {
+                for (uint32_t unit = 0; unit < GLS_MAX_TEXTURE_UNITS; unit++) {
+                    if (textures_[slot][unit] == texture) textures_[slot][unit] = UNKNOWN;
+                }
+            }
+        }
+        void forgetProgram(uint32_t program) { if (program_ == program) program_ = UNKNOWN; }
+        void forgetVertexArray(uint32_t vao) { if (vao_ == vao) vao_ = UNKNOWN; }
+
+        /**
+         * ******************************************************
+         * Forget everything, the next bind of each kind is issued
+         * ******************************************************
+        **/
+        void invalidate()
+        {
+            program_ = UNKNOWN;
+            unit_ = UNKNOWN;
+            vao_ = UNKNOWN;
+            for (uint32_t slot = 0; slot < TARGET_SLOTS; slot++) {
+                for (uint32_t unit = 0; unit < GLS_MAX_TEXTURE_UNITS; unit++) {
+                    textures_[slot][unit] = UNKNOWN;
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        const GLStateStats& getStats() { return stats_; }
+        void resetStats() { memset(&stats_, 0, sizeof(stats_)); }
+
+    private: /* Types */
+        static const uint32_t UNKNOWN = 0xFFFFFFFF;
+        static const uint32_t TARGET_SLOTS = 2;
+
+    private: /* Methods */
+        static int32_t targetSlot(uint32_t target)
+        {
+            switch (target) {
+                case GL_TEXTURE_2D:         return 0;
+                case GL_TEXTURE_2D_ARRAY:   return 1;
+                default:                    return -1;
+            }
+        }
+
+    private: /* Members */
+        uint32_t        program_;                                       /* Current program */
+        uint32_t        unit_;                                          /* Active texture unit */
+        uint32_t        textures_[TARGET_SLOTS][GLS_MAX_TEXTURE_UNITS]; /* Texture per target and unit */
+        uint32_t        vao_;                                           /* Bound VAO */
+        GLStateStats    stats_;                                         /* Per frame counters */
+};
+
+#endif
@@ -0,0 +1,159 @@
+/******************************************
+
+* File Name : includes/InstanceBuffer.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Per instance attributes for instanced draws: the model matrix and
+ * the normal matrix (transposed inverse of the model) of every copy,
+ * streamed each frame. The normal matrices are computed on the
+ * ThreadPool. Each update orphans the buffer, so the driver hands out
+ * fresh storage instead of waiting for last frame's draws.
+ *
+ * A vertex array reads the matrices at attribute locations 3 to 10,
+ * one column each, advanced once per instance; see attach() and the
+ * INSTANCED path of shaders/SimpleVertexShader.vs.
+ *
+ * Every buffer gets a serial no other buffer of the run shares. The
+ * vertex arrays remember the serial of the buffer they read, not its
+ * address or GL name, which a new buffer may get again.
+ */
+
+#ifndef _LOGL_INSTANCE_BUFFER_HPP_
+#define _LOGL_INSTANCE_BUFFER_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* STD */
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "Utils.hpp"
+#include "ThreadPool.hpp"
+#include "Buffers.hpp"
+
+#define INSTANCE_ATTRIB_FIRST   3       /* After position, normal and texture coordinates */
+#define INSTANCE_ATTRIB_COUNT   8       /* Two mat4, a column per attribute */
+#define INSTANCE_CHUNK          1024    /* Instances per ThreadPool task */
+
+/**
+ * ******************************************************
+ * Attributes of one instance, as laid out in the buffer
+ * ******************************************************
+**/
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat4 transposedInversedModel;
+};
+
+/**
+ * ******************************************************
+ * @brief Streamed buffer of per instance matrices
+ * ******************************************************
+**/
+class InstanceBuffer {
+    public: /* Constructors */
+        InstanceBuffer() :
+            serial_(nextSerial()++), capacity_(0), count_(0)
+        {
+            glGenBuffers(1, &handler_);
+        }
+
+        ~InstanceBuffer()
+        {
+            glDeleteBuffers(1, &handler_);
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Replace the instances, once per frame
+         *
+         * @param[in] models        - model matrix per instance
+         * @param[in] count
+         * ******************************************************
+        **/
+        void update(const glm::mat4* models, size_t count)
+        {
+            data_.resize(count);
+            uint32_t chunks = (count + INSTANCE_CHUNK - 1) / INSTANCE_CHUNK;
+            ThreadPool::global().parallelFor(chunks, [this, models, count](uint32_t chunk) {
+                size_t end = (size_t)(chunk + 1) * INSTANCE_CHUNK;
+                if (end > count) end = count;
+                for (size_t i = (size_t)chunk * INSTANCE_CHUNK; i < end; i++) {
+                    data_[i].model = models[i];
+                    data_[i].transposedInversedModel = glm::transpose(glm::inverse(models[i]));
+                }
+            });
+            count_ = count;
+
+            /* Orphan: same size, new storage. Grows to the largest count seen. */
+            if (count > capacity_) capacity_ = count;
+            glBindBuffer(GL_ARRAY_BUFFER, handler_);
+            glBufferData(GL_ARRAY_BUFFER, capacity_ * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceData), data_.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        /**
+         * ******************************************************
+         * Point the instance attributes of a vertex array at this
+         * buffer. Leaves the vertex array bound.
+         *
+         * @param[in] vao
+         * ******************************************************
+        **/
+        void attach(VertexArray & vao)
+        {
+            GLState::get().bindVertexArray(vao.getHandler());
+            glBindBuffer(GL_ARRAY_BUFFER, handler_);
+            for (uint32_t column = 0; column < INSTANCE_ATTRIB_COUNT; column++) {
+                uint32_t id = INSTANCE_ATTRIB_FIRST + column;
+                vao.attribPointer(id, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), column * sizeof(glm::vec4));
+                vao.attribDivisor(id, 1);
+                vao.enableAttribArray(id);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        uint32_t getHandler() { return handler_; }
+        uint64_t getSerial() { return serial_; }
+        size_t getCount() { return count_; }
+
+    private: /* Methods */
+        /* Serial of the next buffer, 0 is never handed out */
+        static std::atomic<uint64_t>& nextSerial()
+        {
+            static std::atomic<uint64_t> serial(1);
+            return serial;
+        }
+
+    private: /* Members */
+        uint64_t                    serial_;    /* Unique to this buffer */
+        uint32_t                    handler_;   /* Buffer handler */
+        size_t                      capacity_;  /* Instances the storage holds */
+        size_t                      count_;     /* Instances of the last update */
+        std::vector<InstanceData>   data_;      /* Staging, reused */
+};
+
+#endif
@@ -22,15 +22,16 @@
 
 /* STD */
 #include <vector>
+#include <memory>
 
 #include <glm.hpp>
 #include <string>
 
-struct Vertex {
-    glm::vec3 pos_;
-    glm::vec3 normal_;
-    glm::vec2 texCoords_;
-};
+#include "Vertex.hpp"
+#include "TextureManager.hpp"
+#include "TextureArray.hpp"
+#include "InstanceBuffer.hpp"
+#include "MeshArena.hpp"
 
 /**
  * ******************************************************
@@ -44,37 +45,103 @@ class Mesh {
          * ******************************************************
          * Mesh constructor
          *
+         * Takes the arrays by value; pass them with std::move
+         * to hand them over without a copy. Unless retention is
+         * BR_READBACK the arrays are freed after the upload.
+         *
+         * The EBO uses the narrowest index type that can address
+         * all the vertices, see indexTypeFor(). In the MeshArena
+         * the indices are 32 bit.
+         *
          * @param[in] vertices
          * @param[in] indices
          * @param[in] textures
          * @param[in] drawType
+         * @param[in] retention     - CPU copy policy, see BufferRetention
+         * @param[in] useArena      - place the mesh in the MeshArena
+         *                            instead of its own buffers
          * ******************************************************
         **/
         Mesh(std::vector<Vertex> vertices, 
                 std::vector<unsigned int> indices,
                 std::vector<Texture*> textures, 
-                uint32_t drawType, 
-                std::vector<float> data) :
-            vertices_(vertices),
-            indices_(indices),
-            textures_(textures),
+                uint32_t drawType,
+                BufferRetention retention = BR_DISCARD,
+                bool useArena = false) :
+            vertices_(std::move(vertices)),
+            indices_(std::move(indices)),
+            textures_(std::move(textures)),
             drawType_(drawType),
-            VAO_(),
-            VBO_(GL_ARRAY_BUFFER, drawType_ , (float*)vertices_.data(), vertices_.size()*sizeof(Vertex)),
-            EBO_(GL_ELEMENT_ARRAY_BUFFER, drawType_, indices_.data(), indices_.size()*sizeof(unsigned int))
+            retention_(retention),
+            vertexCount_(vertices_.size()),
+            indexCount_(indices_.size()),
+            indexType_(indexTypeFor(vertexCount_)),
+            instances_(NULL),
+            instanceSerial_(0),
+            inArena_(false)
         {
             //LOG(L_ERR, "MESH EBO:");
-            //VBO_.hexDump();
-            //EBO_.hexDump();
+            //VBO_->hexDump();
+            //EBO_->hexDump();
             /* Positions */
 
-            VAO_.attribPointer(3, sizeof(Vertex), 0);
-            VAO_.attribPointer(3, sizeof(Vertex), offsetof(Vertex, normal_));
-            VAO_.attribPointer(2, sizeof(Vertex), offsetof(Vertex, texCoords_));
-            VAO_.enableAllAttribArrays();
-            VAO_.print();
+            upload(vertices_.data(), indices_.data(), useArena);
+
+            if (retention_ != BR_READBACK) {
+                std::vector<Vertex>().swap(vertices_);
+                std::vector<unsigned int>().swap(indices_);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Mesh constructor from raw arrays, e.g. a mapped mesh cache
+         *
+         * The data is uploaded straight from the arrays and only
+         * copied if retention is BR_READBACK.
+         *
+         * @param[in] vertices
+         * @param[in] vertexCount
+         * @param[in] indices
+         * @param[in] indexCount
+         * @param[in] textures
+         * @param[in] drawType
+         * @param[in] retention     - CPU copy policy, see BufferRetention
+         * @param[in] useArena      - place the mesh in the MeshArena
+         * ******************************************************
+        **/
+        Mesh(const Vertex* vertices, size_t vertexCount,
+                const unsigned int* indices, size_t indexCount,
+                std::vector<Texture*> textures,
+                uint32_t drawType,
+                BufferRetention retention = BR_DISCARD,
+                bool useArena = false) :
+            textures_(std::move(textures)),
+            drawType_(drawType),
+            retention_(retention),
+            vertexCount_(vertexCount),
+            indexCount_(indexCount),
+            indexType_(indexTypeFor(vertexCount_)),
+            instances_(NULL),
+            instanceSerial_(0),
+            inArena_(false)
+        {
+            upload(vertices, indices, useArena);
 
-            glBindVertexArray(0);
+            if (retention_ == BR_READBACK) {
+                vertices_.assign(vertices, vertices + vertexCount);
+                indices_.assign(indices, indices + indexCount);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Destructor, gives the arena range back
+         * ******************************************************
+        **/
+        ~Mesh()
+        {
+            if (inArena_) MeshArena::get().free(range_);
         }
 
     public: /* Metods */
@@ -87,45 +154,338 @@ class Mesh {
         **/
         void draw(Program & program)
         {
+            bindMaterial(program);
+
+            /* The VAO stays bound, the next draw binds its own */
+            GLState::get().bindVertexArray(getVertexArray());
+            glDrawElementsBaseVertex(GL_TRIANGLES, indexCount_, indexType_,
+                    (void*)getIndexOffset(), getBaseVertex());
+        }
+
+        /**
+         * ******************************************************
+         * Draw every instance of a buffer in one call. Needs a
+         * program built with INSTANCED.
+         *
+         * @param[in] program
+         * @param[in] instances
+         * ******************************************************
+        **/
+        void drawInstanced(Program & program, InstanceBuffer & instances)
+        {
+            bindMaterial(program);
+            setInstanceBuffer(instances);
+
+            GLState::get().bindVertexArray(getVertexArray());
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount_, indexType_,
+                    (void*)getIndexOffset(), instances.getCount(), getBaseVertex());
+        }
+
+        /**
+         * ******************************************************
+         * Read the instance attributes from a buffer. Only sets
+         * the attributes up when the buffer changes. Arena meshes
+         * share the arena's VAO, so they share its buffer too.
+         *
+         * @param[in] instances
+         * ******************************************************
+        **/
+        void setInstanceBuffer(InstanceBuffer & instances)
+        {
+            instances_ = &instances;
+            if (inArena_) {
+                MeshArena::get().setInstanceBuffer(instances);
+                return;
+            }
+            if (instanceSerial_ == instances.getSerial()) return;
+
+            instances.attach(*VAO_);
+            instanceSerial_ = instances.getSerial();
+        }
+
+        /**
+         * ******************************************************
+         * Sampler uniforms for the textures, resolved the first
+         * time the mesh is drawn with a program.
+         *
+         * The N in material.diffuseN counts the textures of the
+         * same type; only diffuse and specular are numbered.
+         * With material layers the samplers are diffuseArray,
+         * specularArray... one per slot, in slot order; invalid
+         * for the slots the program doesn't sample.
+         *
+         * @param[in] program
+         * ******************************************************
+        **/
+        const std::vector<UniformHandle>& getSamplers(Program & program)
+        {
+            /* A mesh is drawn by a handful of programs, a linear scan is enough */
+            for (size_t i = 0; i < samplers_.size(); i++) {
+                if (samplers_[i].program == program.getId()) return samplers_[i].handles;
+            }
+
+            SamplerBindings bindings;
+            bindings.program = program.getId();
+            bindings.layers = program.getUniform("materialLayers");
+
+            for (unsigned int i = 0; i < arrays_.size(); i++) {
+                bindings.handles.push_back(program.getUniform(materialArraySampler(i)));
+            }
+
             unsigned int diffuseNr = 1;
             unsigned int specularNr = 1;
-            for(unsigned int i = 0; i < textures_.size(); i++)
-            {
-                glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-                // retrieve texture number (the N in diffuse_textureN)
+            for (unsigned int i = 0; i < textures_.size(); i++) {
                 std::string number;
                 const char* name = textures_[i]->getTypeCstr();
 
-                //TODO Don't like this very much. I will alloc mem and concat strings on every draw
-                //TODO Also, don't understand what's up with multiple textures of the same type
                 if      (strcmp(name, "diffuse") == 0)      number = std::to_string(diffuseNr++);
                 else if (strcmp(name, "specular") == 0)     number = std::to_string(specularNr++);
 
                 std::string uniformName = "material.";
                 uniformName += name;
                 uniformName += number;
-                program.setInt(uniformName.c_str(), i);
-                glBindTexture(GL_TEXTURE_2D, textures_[i]->getHandler());
+                bindings.handles.push_back(program.getUniform(uniformName));
+            }
+
+            LOG(L_DBG, "Resolved %lu samplers for program %d.", bindings.handles.size(), bindings.program);
+            samplers_.push_back(std::move(bindings));
+            return samplers_.back().handles;
+        }
+
+        /* The materialLayers vec4, layer per slot */
+        UniformHandle getLayersUniform(Program & program)
+        {
+            getSamplers(program);
+            for (size_t i = 0; i < samplers_.size(); i++) {
+                if (samplers_[i].program == program.getId()) return samplers_[i].layers;
             }
-            glActiveTexture(GL_TEXTURE0);
+            UniformHandle none = { -1, -1 };
+            return none;
+        }
+
+        /**
+         * ******************************************************
+         * Sample the material from texture arrays instead of the
+         * 2D textures, which are dropped. Needs a program built
+         * with TEXTURE_ARRAYS.
+         *
+         * Slot i binds unit i. A slot the material lacks reads
+         * layer 0 of TextureArray::blank(), black.
+         *
+         * @param[in] material
+         * ******************************************************
+        **/
+        void setMaterialLayers(const MaterialLayers & material)
+        {
+            textures_.clear();
+            arrays_.clear();
+            samplers_.clear();
+
+            for (uint32_t slot = 0; slot < MATERIAL_SLOTS; slot++) {
+                arrays_.push_back(material.arrays[slot] ? material.arrays[slot] : &TextureArray::blank());
+                layers_[slot] = material.arrays[slot] ? material.layers[slot] : 0.0f;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        /* Only filled with BR_READBACK */
+        const std::vector<Vertex>& getVertices() { return vertices_; }
+        const std::vector<unsigned int>& getIndices() { return indices_; }
+
+        /* Bytes held in RAM, mesh arrays and retained buffer copies */
+        size_t getCpuBytes()
+        {
+            return vertices_.capacity() * sizeof(Vertex) +
+                indices_.capacity() * sizeof(unsigned int) +
+                (inArena_ ? 0 : VBO_->getRetainedSize() + EBO_->getRetainedSize());
+        }
+
+        /* Draw state, used by the RenderQueue */
+        const std::vector<Texture*>& getTextures() { return textures_; }
+        const std::vector<TextureArray*>& getTextureArrays() { return arrays_; }
+        const glm::vec4& getLayers() { return layers_; }
+        uint32_t getVertexArray() { return inArena_ ? MeshArena::get().getVertexArray() : VAO_->getHandler(); }
+        InstanceBuffer* getInstanceBuffer() { return instances_; }
+        size_t getIndexCount() { return indexCount_; }
+        uint32_t getIndexType() { return indexType_; }
+
+        /* Where the mesh starts in its buffers, 0 outside the arena */
+        bool isInArena() { return inArena_; }
+        uint32_t getFirstIndex() { return inArena_ ? range_.firstIndex : 0; }
+        int32_t getBaseVertex() { return inArena_ ? range_.firstVertex : 0; }
+        size_t getIndexOffset() { return (size_t)getFirstIndex() * indexSize(indexType_); }
+
+        /* Bytes held in buffer objects, the arena's share when in it */
+        size_t getGpuBytes()
+        {
+            if (inArena_) return vertexCount_ * sizeof(Vertex) + indexCount_ * sizeof(uint32_t);
+            return VBO_->getSize() + EBO_->getSize();
+        }
+
+    private: /* Types */
+        /* Sampler uniforms of one program, one per texture or array */
+        struct SamplerBindings {
+            uint32_t program;
+            std::vector<UniformHandle> handles;
+            UniformHandle layers;           /* materialLayers */
+        };
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Bind the textures, or arrays and layers, of the mesh
+         * ******************************************************
+        **/
+        void bindMaterial(Program & program)
+        {
+            GLState& state = GLState::get();
+            const std::vector<UniformHandle>& samplers = getSamplers(program);
+            for (unsigned int i = 0; i < textures_.size(); i++) TextureManager::get().touch(textures_[i]);
+            for(unsigned int i = 0; i < textures_.size(); i++)
+            {
+                program.setInt(samplers[i], i);
+                state.bindTexture(i, textures_[i]->getHandler());
+            }
+            for (unsigned int i = 0; i < arrays_.size(); i++) {
+                if (!samplers[i].valid()) continue;
+                program.setInt(samplers[i], i);
+                state.bindTexture(i, arrays_[i]->getHandler(), GL_TEXTURE_2D_ARRAY);
+            }
+            if (!arrays_.empty()) program.setVec4(getLayersUniform(program), layers_);
+        }
+
+        /**
+         * ******************************************************
+         * Narrowest index type for a vertex count
+         *
+         * @param[in] vertexCount
+         * ******************************************************
+        **/
+        static uint32_t indexTypeFor(size_t vertexCount)
+        {
+            if (vertexCount <= 0x100)       return GL_UNSIGNED_BYTE;
+            if (vertexCount <= 0x10000)     return GL_UNSIGNED_SHORT;
+            return GL_UNSIGNED_INT;
+        }
+
+        static size_t indexSize(uint32_t indexType)
+        {
+            switch (indexType) {
+                case GL_UNSIGNED_BYTE:      return sizeof(uint8_t);
+                case GL_UNSIGNED_SHORT:     return sizeof(uint16_t);
+                default:                    return sizeof(uint32_t);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Narrow the indices to indexType for the upload
+         *
+         * @param[in] indices
+         * @param[in] count
+         * @param[in] indexType
+         * @param[out] scratch      - holds the narrowed copy, keep it
+         *                            until the data is uploaded
+         *
+         * @return the data to upload
+         * ******************************************************
+        **/
+        static const uint8_t* narrowIndices(const unsigned int* indices, size_t count,
+                uint32_t indexType, std::vector<uint8_t>& scratch)
+        {
+            if (indexType == GL_UNSIGNED_INT) return (const uint8_t*)indices;
+
+            scratch.resize(count * indexSize(indexType));
+            if (indexType == GL_UNSIGNED_BYTE) {
+                for (size_t i = 0; i < count; i++) scratch[i] = (uint8_t)indices[i];
+            } else {
+                uint16_t* narrow = (uint16_t*)scratch.data();
+                for (size_t i = 0; i < count; i++) narrow[i] = (uint16_t)indices[i];
+            }
+            return scratch.data();
+        }
+
+        /**
+         * ******************************************************
+         * The buffers only keep a copy when debugging
+         * ******************************************************
+        **/
+        BufferRetention bufferRetention()
+        {
+            return retention_ == BR_DEBUG ? BR_DEBUG : BR_DISCARD;
+        }
+
+        /**
+         * ******************************************************
+         * Copy the mesh into the arena, or into buffers of its own
+         * if not asked to or the arena can't take it
+         *
+         * @param[in] vertices
+         * @param[in] indices
+         * @param[in] useArena
+         * ******************************************************
+        **/
+        void upload(const Vertex* vertices, const unsigned int* indices, bool useArena)
+        {
+            if (useArena && MeshArena::get().allocate(vertices, vertexCount_, indices, indexCount_, range_)) {
+                inArena_ = true;
+                indexType_ = GL_UNSIGNED_INT;
+                return;
+            }
+
+            std::vector<uint8_t> scratch;
+            VAO_.reset(new VertexArray());
+            VBO_.reset(new Buffer<float>(GL_ARRAY_BUFFER, drawType_, (const float*)vertices,
+                        vertexCount_*sizeof(Vertex), bufferRetention()));
+            EBO_.reset(new Buffer<uint8_t>(GL_ELEMENT_ARRAY_BUFFER, drawType_,
+                        narrowIndices(indices, indexCount_, indexType_, scratch),
+                        indexCount_*indexSize(indexType_), bufferRetention()));
+            setupAttributes();
+            VAO_->print();
+        }
+
+        /**
+         * ******************************************************
+         * Format the vertex attributes, leaves the VAO unbound
+         * ******************************************************
+        **/
+        void setupAttributes()
+        {
+            VAO_->attribPointer(3, sizeof(Vertex), 0);
+            VAO_->attribPointer(3, sizeof(Vertex), offsetof(Vertex, normal_));
+            VAO_->attribPointer(2, sizeof(Vertex), offsetof(Vertex, texCoords_));
+            VAO_->enableAllAttribArrays();
 
-            glBindVertexArray(VAO_.getHandler());
-            glDrawElements(GL_TRIANGLES, indices_.size(), GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
+            GLState::get().bindVertexArray(0);
         }
 
     private: /* Members */
         /*  Mesh Data  */
-        std::vector<Vertex> vertices_;
-        std::vector<unsigned int> indices_;
+        std::vector<Vertex> vertices_;           /* Only kept with BR_READBACK */
+        std::vector<unsigned int> indices_;      /* Only kept with BR_READBACK */
         std::vector<Texture*> textures_;         /* Textures, TODO somewhat faster with uptrs */
+        std::vector<SamplerBindings> samplers_;  /* Sampler uniforms per program */
+        std::vector<TextureArray*> arrays_;      /* One per material slot, replace textures_ when set */
+        glm::vec4 layers_;                       /* Layer per material slot */
 
         uint32_t drawType_;
+        BufferRetention retention_;
+        size_t vertexCount_;
+        size_t indexCount_;
+        uint32_t indexType_;                     /* GL_UNSIGNED_BYTE/SHORT/INT */
+        InstanceBuffer* instances_;              /* Last set, for the draws of this frame; NULL if none */
+        uint64_t instanceSerial_;                /* Of the buffer VAO_ reads, 0 if none */
+        bool inArena_;                           /* Drawn from the MeshArena, no buffers of its own */
+        ArenaRange range_;                       /* Arena range, when inArena_ */
 
-        /*  Render data  */
-        VertexArray VAO_;
-        Buffer<float> VBO_;
-        Buffer<uint32_t> EBO_;
+        /*  Render data, NULL in the arena  */
+        std::unique_ptr<VertexArray> VAO_;
+        std::unique_ptr<Buffer<float>> VBO_;
+        std::unique_ptr<Buffer<uint8_t>> EBO_;   /* Indices, indexType_ wide */
 
 };  
 
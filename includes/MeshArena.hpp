@@ -0,0 +1,367 @@
+/******************************************
+
+* File Name : includes/MeshArena.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * One vertex buffer, one index buffer and one VAO shared by the meshes
+ * of the Vertex layout. A mesh gets a range of each; it draws with its
+ * first index and base vertex, and meshes of the same material draw
+ * together with one glMultiDrawElementsIndirect (see RenderQueue).
+ *
+ * The ranges come from a first fit free list that merges neighbours on
+ * free. A full buffer doubles, the old contents are copied on the GPU;
+ * an allocate that would take it past 2^32 elements fails.
+ * The indices are always 32 bit; a multi draw takes one index type.
+ *
+ * Everything is uploaded through GL_COPY_WRITE_BUFFER, so creating or
+ * filling the index buffer never changes the GL_ELEMENT_ARRAY_BUFFER
+ * of whatever VAO is bound.
+ */
+
+#ifndef _LOGL_MESH_ARENA_HPP_
+#define _LOGL_MESH_ARENA_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* STD */
+#include <map>
+#include <memory>
+#include <iterator>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "Utils.hpp"
+#include "GLState.hpp"
+#include "Buffers.hpp"
+#include "Vertex.hpp"
+#include "InstanceBuffer.hpp"
+
+#define MA_VERTEX_CAPACITY  (256 << 10)     /* Vertices of the first vertex buffer, 8 MiB */
+#define MA_INDEX_CAPACITY   (1 << 20)       /* Indices of the first index buffer, 4 MiB */
+
+/**
+ * ******************************************************
+ * Where a mesh lives in the arena, in elements
+ * ******************************************************
+**/
+struct ArenaRange {
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+/**
+ * ******************************************************
+ * One draw of glMultiDrawElementsIndirect, as laid out
+ * in the GL_DRAW_INDIRECT_BUFFER
+ * ******************************************************
+**/
+struct DrawElementsIndirectCommand {
+    uint32_t count;             /* Indices */
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t  baseVertex;
+    uint32_t baseInstance;
+};
+
+/**
+ * ******************************************************
+ * Occupancy, the grows add up since the start
+ * ******************************************************
+**/
+struct MeshArenaStats {
+    uint32_t    meshes;
+    uint32_t    vertices;
+    uint32_t    vertexCapacity;
+    uint32_t    indices;
+    uint32_t    indexCapacity;
+    uint32_t    grows;
+};
+
+/**
+ * ******************************************************
+ * @brief Shared vertex and index buffers
+ * ******************************************************
+**/
+class MeshArena {
+    public: /* Constructors */
+        MeshArena() :
+            vbo_(0), ebo_(0), vertexCapacity_(0), indexCapacity_(0), instanceSerial_(0)
+        {
+            memset(&stats_, 0, sizeof(stats_));
+        }
+
+        /* The buffers go with the context, which is gone by now */
+        ~MeshArena()
+        {
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * The arena of the (only) context
+         * ******************************************************
+        **/
+        static MeshArena& get()
+        {
+            static MeshArena arena;
+            return arena;
+        }
+
+        /**
+         * ******************************************************
+         * Copy a mesh into the arena
+         *
+         * @param[in] vertices
+         * @param[in] vertexCount
+         * @param[in] indices       - relative to the mesh's vertices
+         * @param[in] indexCount
+         * @param[out] range
+         *
+         * @return false if the mesh has no vertices or indices,
+         *         or the buffers can't grow to fit it
+         * ******************************************************
+        **/
+        bool allocate(const Vertex* vertices, size_t vertexCount,
+                const unsigned int* indices, size_t indexCount, ArenaRange & range)
+        {
+            if (vertexCount == 0 || indexCount == 0 || vertexCount > UINT32_MAX / 2 || indexCount > UINT32_MAX / 2) {
+                return false;
+            }
+            if (vao_.get() == NULL) create();
+
+            if (!take(freeVertices_, vertexCount, range.firstVertex) &&
+                    (!grow(vbo_, vertexCapacity_, vertexCount, sizeof(Vertex), freeVertices_) ||
+                     !take(freeVertices_, vertexCount, range.firstVertex))) {
+                return false;
+            }
+            if (!take(freeIndices_, indexCount, range.firstIndex) &&
+                    (!grow(ebo_, indexCapacity_, indexCount, sizeof(uint32_t), freeIndices_) ||
+                     !take(freeIndices_, indexCount, range.firstIndex))) {
+                release(freeVertices_, range.firstVertex, vertexCount);
+                return false;
+            }
+            range.vertexCount = vertexCount;
+            range.indexCount = indexCount;
+
+            glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (size_t)range.firstVertex * sizeof(Vertex),
+                    vertexCount * sizeof(Vertex), vertices);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (size_t)range.firstIndex * sizeof(uint32_t),
+                    indexCount * sizeof(uint32_t), indices);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            stats_.meshes++;
+            stats_.vertices += vertexCount;
+            stats_.indices += indexCount;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Give a range back
+         *
+         * @param[in] range         - from allocate()
+         * ******************************************************
+        **/
+        void free(const ArenaRange & range)
+        {
+            release(freeVertices_, range.firstVertex, range.vertexCount);
+            release(freeIndices_, range.firstIndex, range.indexCount);
+            stats_.meshes--;
+            stats_.vertices -= range.vertexCount;
+            stats_.indices -= range.indexCount;
+        }
+
+        /**
+         * ******************************************************
+         * Read the instance attributes from a buffer. The VAO is
+         * shared, so is the instance buffer: only one at a time.
+         *
+         * @param[in] instances
+         * ******************************************************
+        **/
+        void setInstanceBuffer(InstanceBuffer & instances)
+        {
+            if (instanceSerial_ == instances.getSerial()) return;
+            instances.attach(*vao_);
+            instanceSerial_ = instances.getSerial();
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        uint32_t getVertexArray() { return vao_.get() ? vao_->getHandler() : 0; }
+
+        MeshArenaStats getStats()
+        {
+            stats_.vertexCapacity = vertexCapacity_;
+            stats_.indexCapacity = indexCapacity_;
+            return stats_;
+        }
+
+    private: /* Types */
+        typedef std::map<uint32_t, uint32_t> FreeList;     /* Free ranges, first element to count */
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Create the buffers and format the VAO
+         * ******************************************************
+        **/
+        void create()
+        {
+            vertexCapacity_ = MA_VERTEX_CAPACITY;
+            indexCapacity_ = MA_INDEX_CAPACITY;
+            glGenBuffers(1, &vbo_);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+            glBufferData(GL_COPY_WRITE_BUFFER, (size_t)vertexCapacity_ * sizeof(Vertex), NULL, GL_STATIC_DRAW);
+            glGenBuffers(1, &ebo_);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+            glBufferData(GL_COPY_WRITE_BUFFER, (size_t)indexCapacity_ * sizeof(uint32_t), NULL, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            freeVertices_[0] = vertexCapacity_;
+            freeIndices_[0] = indexCapacity_;
+
+            vao_.reset(new VertexArray());
+            formatVertexArray();
+            LOG(L_INFO, "Mesh arena: %u vertices, %u indices.", vertexCapacity_, indexCapacity_);
+        }
+
+        /**
+         * ******************************************************
+         * Point the VAO at the current buffers, leaves it unbound
+         * ******************************************************
+        **/
+        void formatVertexArray()
+        {
+            GLState::get().bindVertexArray(vao_->getHandler());
+            glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+            vao_->attribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
+            vao_->attribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, normal_));
+            vao_->attribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), offsetof(Vertex, texCoords_));
+            for (uint32_t id = 0; id < 3; id++) vao_->enableAttribArray(id);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+            GLState::get().bindVertexArray(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        /**
+         * ******************************************************
+         * First fit
+         *
+         * @param[in] list
+         * @param[in] count
+         * @param[out] first
+         *
+         * @return false if no free range is large enough
+         * ******************************************************
+        **/
+        static bool take(FreeList & list, uint32_t count, uint32_t & first)
+        {
+            for (auto it = list.begin(); it != list.end(); ++it) {
+                if (it->second < count) continue;
+                first = it->first;
+                if (it->second > count) list[it->first + count] = it->second - count;
+                list.erase(it);
+                return true;
+            }
+            return false;
+        }
+
+        /* Free a range, merged with the free ranges next to it */
+        static void release(FreeList & list, uint32_t first, uint32_t count)
+        {
+            auto next = list.lower_bound(first);
+            if (next != list.end() && first + count == next->first) {
+                count += next->second;
+                next = list.erase(next);
+            }
+            if (next != list.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == first) {
+                    prev->second += count;
+                    return;
+                }
+            }
+            list[first] = count;
+        }
+
+        /**
+         * ******************************************************
+         * Double a buffer, or more if count doesn't fit, copying
+         * the contents over. The new tail is free.
+         *
+         * @param[in,out] buffer
+         * @param[in,out] capacity  - in elements
+         * @param[in] count         - elements that must fit
+         * @param[in] elementSize
+         * @param[in,out] list      - free list of the buffer
+         *
+         * @return false if the capacity would pass 32 bits, the
+         *         buffer is unchanged
+         * ******************************************************
+        **/
+        bool grow(uint32_t & buffer, uint32_t & capacity, uint32_t count, size_t elementSize, FreeList & list)
+        {
+            uint64_t newCapacity = (uint64_t)capacity * 2;
+            while (newCapacity - capacity < count) newCapacity *= 2;
+            if (newCapacity > UINT32_MAX) {
+                LOG(L_ERR, "Mesh arena can't grow past %u %s, %u more don't fit.", capacity,
+                        &buffer == &vbo_ ? "vertices" : "indices", count);
+                return false;
+            }
+
+            uint32_t grown;
+            glGenBuffers(1, &grown);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+            glBufferData(GL_COPY_WRITE_BUFFER, (size_t)newCapacity * elementSize, NULL, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (size_t)capacity * elementSize);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+
+            release(list, capacity, newCapacity - capacity);
+            LOG(L_INFO, "Mesh arena grown from %u to %u %s.", capacity, (uint32_t)newCapacity,
+                    &buffer == &vbo_ ? "vertices" : "indices");
+            buffer = grown;
+            capacity = newCapacity;
+            stats_.grows++;
+
+            /* The VAO still reads the deleted buffer */
+            formatVertexArray();
+            return true;
+        }
+
+    private: /* Members */
+        std::unique_ptr<VertexArray>    vao_;               /* Created with the buffers */
+        uint32_t                        vbo_;               /* Vertex buffer handler */
+        uint32_t                        ebo_;               /* Index buffer handler, 32 bit indices */
+        uint32_t                        vertexCapacity_;    /* Vertices */
+        uint32_t                        indexCapacity_;     /* Indices */
+        FreeList                        freeVertices_;
+        FreeList                        freeIndices_;
+        uint64_t                        instanceSerial_;    /* Of the buffer the instance attributes read, 0 if none */
+        MeshArenaStats                  stats_;
+};
+
+#endif
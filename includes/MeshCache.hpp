@@ -0,0 +1,489 @@
+/******************************************
+
+* File Name : includes/MeshCache.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Binary mesh cache. After the first Assimp import of a model
+ * the meshes are written next to the source file as
+ * <model>.meshcache. On later runs the cache is mmaped and the
+ * vertex/index data is handed straight to the Mesh buffers.
+ *
+ * Layout (all offsets from the start of the file, 8 byte aligned):
+ *
+ *  | MeshCacheHeader | MeshCacheEntry x meshCount | mesh data ... |
+ *
+ * Each mesh data block contains the vertices, the indices and the
+ * texture references (MeshCacheTexture followed by the path bytes).
+ */
+
+#ifndef _LOGL_MESH_CACHE_HPP_
+#define _LOGL_MESH_CACHE_HPP_
+
+/* STD */
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+/* POSIX */
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Utils.hpp"
+#include "Mesh.hpp"
+
+#define MESH_CACHE_MAGIC    0x434d474c  /* "LGMC" */
+#define MESH_CACHE_VERSION  2
+#define MESH_CACHE_EXT      ".meshcache"
+
+#define MESH_CACHE_OPTIMIZED    0x1     /* Meshes went through the MeshOptimizer */
+
+/**
+ * ******************************************************
+ * On disk structures
+ * ******************************************************
+**/
+struct MeshCacheHeader {
+    uint32_t magic;         /* MESH_CACHE_MAGIC */
+    uint32_t version;       /* MESH_CACHE_VERSION */
+    uint32_t vertexSize;    /* sizeof(Vertex) when written */
+    uint32_t meshCount;     /* Number of MeshCacheEntry following */
+    uint64_t srcSize;       /* Source file size */
+    int64_t  srcMtime;      /* Source file modification time */
+    uint64_t srcHash;       /* FNV-1a of the source file */
+    uint32_t flags;         /* MESH_CACHE_OPTIMIZED */
+    uint32_t pad;
+};
+
+struct MeshCacheEntry {
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t textureOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t textureCount;
+    uint32_t pad;
+};
+
+struct MeshCacheTexture {
+    uint32_t type;          /* aiTextureType */
+    uint32_t pathLen;       /* Path length, without the '\0' */
+};
+
+/**
+ * ******************************************************
+ * Texture reference as found in the model material.
+ * The name is relative to the model directory.
+ * ******************************************************
+**/
+struct MeshTextureRef {
+    uint32_t    type;
+    std::string name;
+};
+
+/**
+ * ******************************************************
+ * Mesh data to be written in the cache. Only points to
+ * the data, which has to outlive the write.
+ * ******************************************************
+**/
+struct MeshCacheRecord {
+    const Vertex*                       vertices;
+    uint32_t                            vertexCount;
+    const uint32_t*                     indices;
+    uint32_t                            indexCount;
+    const std::vector<MeshTextureRef>*  textures;
+};
+
+/**
+ * ******************************************************
+ * @brief Mesh cache
+ *
+ * Reads and writes the binary mesh cache of a model file.
+ * ******************************************************
+**/
+class MeshCache {
+    public: /* Constructors */
+        /**
+         * ******************************************************
+         * Constructor
+         *
+         * @param[in] srcPath       - path of the model source file
+         * ******************************************************
+        **/
+        MeshCache(const std::string& srcPath) :
+            srcPath_(srcPath), cachePath_(srcPath + MESH_CACHE_EXT),
+            base_(NULL), size_(0), header_(NULL), entries_(NULL)
+        {
+        }
+
+        /**
+         * ******************************************************
+         * Destructor
+         * ******************************************************
+        **/
+        ~MeshCache()
+        {
+            close();
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Map the cache file and validate it against the source.
+         *
+         * @param[in] optimized     - the meshes must have (or must not
+         *                            have) gone through the MeshOptimizer
+         *
+         * @return true if the cache can be used
+         * ******************************************************
+        **/
+        bool open(bool optimized = false)
+        {
+            struct stat srcStat;
+            if (stat(srcPath_.c_str(), &srcStat) != 0) {
+                LOG(L_ERR, "Couldn't stat model: %s, error: %s", srcPath_.c_str(), strerror(errno));
+                return false;
+            }
+
+            int fd = ::open(cachePath_.c_str(), O_RDONLY);
+            if (fd < 0) {
+                LOG(L_DBG, "No mesh cache for: %s", srcPath_.c_str());
+                return false;
+            }
+
+            struct stat cacheStat;
+            if (fstat(fd, &cacheStat) != 0 || (size_t)cacheStat.st_size < sizeof(MeshCacheHeader)) {
+                ::close(fd);
+                return false;
+            }
+
+            size_ = cacheStat.st_size;
+            base_ = (uint8_t*) mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (base_ == MAP_FAILED) {
+                LOG(L_ERR, "Couldn't map mesh cache: %s, error: %s", cachePath_.c_str(), strerror(errno));
+                base_ = NULL;
+                return false;
+            }
+
+            header_ = (const MeshCacheHeader*) base_;
+            if (header_->magic != MESH_CACHE_MAGIC ||
+                    header_->version != MESH_CACHE_VERSION ||
+                    header_->vertexSize != sizeof(Vertex)) {
+                LOG(L_INFO, "Mesh cache format changed, rebuilding: %s", cachePath_.c_str());
+                close();
+                return false;
+            }
+
+            if (((header_->flags & MESH_CACHE_OPTIMIZED) != 0) != optimized) {
+                LOG(L_INFO, "Mesh cache was written %s the mesh optimizer, rebuilding: %s",
+                        optimized ? "without" : "with", cachePath_.c_str());
+                close();
+                return false;
+            }
+
+            /* Cheap check first, only hash the source if the mtime moved */
+            if (header_->srcSize != (uint64_t)srcStat.st_size) {
+                LOG(L_INFO, "Mesh cache is stale: %s", cachePath_.c_str());
+                close();
+                return false;
+            }
+            if (header_->srcMtime != (int64_t)srcStat.st_mtime) {
+                if (header_->srcHash != hashFile(srcPath_)) {
+                    LOG(L_INFO, "Mesh cache is stale: %s", cachePath_.c_str());
+                    close();
+                    return false;
+                }
+            }
+
+            if (sizeof(MeshCacheHeader) + header_->meshCount * sizeof(MeshCacheEntry) > size_) {
+                LOG(L_ERR, "Mesh cache is truncated: %s", cachePath_.c_str());
+                close();
+                return false;
+            }
+            entries_ = (const MeshCacheEntry*) (base_ + sizeof(MeshCacheHeader));
+
+            for (uint32_t i = 0; i < header_->meshCount; i++) {
+                if (entries_[i].vertexOffset + (uint64_t)entries_[i].vertexCount * sizeof(Vertex) > size_ ||
+                        entries_[i].indexOffset + (uint64_t)entries_[i].indexCount * sizeof(uint32_t) > size_ ||
+                        !texturesFit(entries_[i])) {
+                    LOG(L_ERR, "Mesh cache is truncated: %s", cachePath_.c_str());
+                    close();
+                    return false;
+                }
+            }
+
+            /* Touched, not changed: store the mtime so the next start doesn't hash again */
+            if (header_->srcMtime != (int64_t)srcStat.st_mtime) updateMtime(srcStat.st_mtime);
+
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Unmap the cache file
+         * ******************************************************
+        **/
+        void close()
+        {
+            if (base_) munmap(base_, size_);
+            base_       = NULL;
+            size_       = 0;
+            header_     = NULL;
+            entries_    = NULL;
+        }
+
+        /**
+         * ******************************************************
+         * Getters. Only valid after a successful open().
+         * ******************************************************
+        **/
+        uint32_t getMeshCount() { return header_->meshCount; }
+        uint32_t getVertexCount(uint32_t mesh) { return entries_[mesh].vertexCount; }
+        uint32_t getIndexCount(uint32_t mesh) { return entries_[mesh].indexCount; }
+
+        const Vertex* getVertices(uint32_t mesh)
+        {
+            return (const Vertex*) (base_ + entries_[mesh].vertexOffset);
+        }
+
+        const uint32_t* getIndices(uint32_t mesh)
+        {
+            return (const uint32_t*) (base_ + entries_[mesh].indexOffset);
+        }
+
+        /**
+         * ******************************************************
+         * Get the texture references of a mesh
+         *
+         * @param[in]  mesh         - mesh index
+         * @param[out] textures     - texture references
+         * ******************************************************
+        **/
+        void getTextures(uint32_t mesh, std::vector<MeshTextureRef>& textures)
+        {
+            const uint8_t* curr = base_ + entries_[mesh].textureOffset;
+            const uint8_t* end = base_ + size_;
+            for (uint32_t i = 0; i < entries_[mesh].textureCount; i++) {
+                const MeshCacheTexture* tex = (const MeshCacheTexture*) curr;
+                if ((size_t)(end - curr) < sizeof(MeshCacheTexture) ||
+                        (size_t)(end - curr) - sizeof(MeshCacheTexture) < tex->pathLen) {
+                    LOG(L_ERR, "Mesh cache is truncated: %s", cachePath_.c_str());
+                    return;
+                }
+                MeshTextureRef ref;
+                ref.type = tex->type;
+                ref.name.assign((const char*)(curr + sizeof(MeshCacheTexture)), tex->pathLen);
+                textures.push_back(ref);
+                curr += align(sizeof(MeshCacheTexture) + tex->pathLen);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Write the cache for the source file
+         *
+         * The data is first written to a temporary file which is
+         * then renamed, so a crash never leaves a half written cache.
+         *
+         * @param[in] meshes        - vertices, indices and textures per mesh
+         * @param[in] optimized     - the meshes went through the MeshOptimizer
+         *
+         * @return true on success
+         * ******************************************************
+        **/
+        bool write(const std::vector<MeshCacheRecord>& meshes, bool optimized = false)
+        {
+            struct stat srcStat;
+            if (stat(srcPath_.c_str(), &srcStat) != 0) {
+                LOG(L_ERR, "Couldn't stat model: %s, error: %s", srcPath_.c_str(), strerror(errno));
+                return false;
+            }
+
+            MeshCacheHeader header;
+            memset(&header, 0, sizeof(header));
+            header.magic        = MESH_CACHE_MAGIC;
+            header.version      = MESH_CACHE_VERSION;
+            header.vertexSize   = sizeof(Vertex);
+            header.meshCount    = meshes.size();
+            header.srcSize      = srcStat.st_size;
+            header.srcMtime     = srcStat.st_mtime;
+            header.srcHash      = hashFile(srcPath_);
+            header.flags        = optimized ? MESH_CACHE_OPTIMIZED : 0;
+
+            /* Lay out the data blocks */
+            std::vector<MeshCacheEntry> entries(meshes.size());
+            uint64_t offset = align(sizeof(MeshCacheHeader) + meshes.size() * sizeof(MeshCacheEntry));
+            for (uint32_t i = 0; i < meshes.size(); i++) {
+                memset(&entries[i], 0, sizeof(MeshCacheEntry));
+                entries[i].vertexCount  = meshes[i].vertexCount;
+                entries[i].indexCount   = meshes[i].indexCount;
+                entries[i].textureCount = meshes[i].textures->size();
+
+                entries[i].vertexOffset = offset;
+                offset += align(meshes[i].vertexCount * sizeof(Vertex));
+                entries[i].indexOffset = offset;
+                offset += align(meshes[i].indexCount * sizeof(uint32_t));
+                entries[i].textureOffset = offset;
+                for (uint32_t t = 0; t < meshes[i].textures->size(); t++) {
+                    offset += align(sizeof(MeshCacheTexture) + (*meshes[i].textures)[t].name.size());
+                }
+            }
+
+            std::string tmpPath = cachePath_ + ".tmp";
+            FILE *stream = fopen(tmpPath.c_str(), "wb");
+            if (stream == NULL) {
+                LOG(L_ERR, "Couldn't create mesh cache: %s, error: %s", tmpPath.c_str(), strerror(errno));
+                return false;
+            }
+
+            bool ok = writeBlock(stream, &header, sizeof(header));
+            ok = ok && writeBlock(stream, entries.data(), entries.size() * sizeof(MeshCacheEntry));
+            ok = ok && pad(stream);
+            for (uint32_t i = 0; ok && i < meshes.size(); i++) {
+                ok = ok && writeBlock(stream, meshes[i].vertices, meshes[i].vertexCount * sizeof(Vertex));
+                ok = ok && pad(stream);
+                ok = ok && writeBlock(stream, meshes[i].indices, meshes[i].indexCount * sizeof(uint32_t));
+                ok = ok && pad(stream);
+                for (uint32_t t = 0; ok && t < meshes[i].textures->size(); t++) {
+                    const MeshTextureRef& ref = (*meshes[i].textures)[t];
+                    MeshCacheTexture tex = { ref.type, (uint32_t)ref.name.size() };
+                    ok = ok && writeBlock(stream, &tex, sizeof(tex));
+                    ok = ok && writeBlock(stream, ref.name.data(), ref.name.size());
+                    ok = ok && pad(stream);
+                }
+            }
+
+            if (fclose(stream) != 0) ok = false;
+            if (!ok || rename(tmpPath.c_str(), cachePath_.c_str()) != 0) {
+                LOG(L_ERR, "Couldn't write mesh cache: %s", cachePath_.c_str());
+                unlink(tmpPath.c_str());
+                return false;
+            }
+
+            LOG(L_INFO, "Wrote mesh cache: %s, %lu bytes", cachePath_.c_str(), (unsigned long)offset);
+            return true;
+        }
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Whether the texture references of a mesh, paths
+         * included, lie inside the mapped file
+         * ******************************************************
+        **/
+        bool texturesFit(const MeshCacheEntry& entry)
+        {
+            if (entry.textureOffset > size_) return false;
+            uint64_t offset = entry.textureOffset;
+            for (uint32_t i = 0; i < entry.textureCount; i++) {
+                if (size_ - offset < sizeof(MeshCacheTexture)) return false;
+                const MeshCacheTexture* tex = (const MeshCacheTexture*) (base_ + offset);
+                if (size_ - offset - sizeof(MeshCacheTexture) < tex->pathLen) return false;
+                offset += align(sizeof(MeshCacheTexture) + tex->pathLen);
+                if (offset > size_) offset = size_;
+            }
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Store a new source mtime in the cache header, in place
+         *
+         * @param[in] mtime
+         * ******************************************************
+        **/
+        void updateMtime(int64_t mtime)
+        {
+            int fd = ::open(cachePath_.c_str(), O_WRONLY);
+            if (fd < 0 || pwrite(fd, &mtime, sizeof(mtime), offsetof(MeshCacheHeader, srcMtime)) != sizeof(mtime)) {
+                LOG(L_DBG, "Couldn't update the mesh cache mtime: %s", cachePath_.c_str());
+            }
+            if (fd >= 0) ::close(fd);
+        }
+
+        /**
+         * ******************************************************
+         * Round up to the block alignment
+         * ******************************************************
+        **/
+        static uint64_t align(uint64_t size) { return (size + 7) & ~(uint64_t)7; }
+
+        /**
+         * ******************************************************
+         * Write helpers
+         * ******************************************************
+        **/
+        static bool writeBlock(FILE* stream, const void* data, size_t size)
+        {
+            if (size == 0) return true;
+            return fwrite(data, 1, size, stream) == size;
+        }
+
+        static bool pad(FILE* stream)
+        {
+            static const uint8_t zeros[8] = {0};
+            long pos = ftell(stream);
+            if (pos < 0) return false;
+            return writeBlock(stream, zeros, align(pos) - pos);
+        }
+
+        /**
+         * ******************************************************
+         * FNV-1a 64 bit hash of a file
+         * ******************************************************
+        **/
+        static uint64_t hashFile(const std::string& path)
+        {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return 0;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                ::close(fd);
+                return hash;
+            }
+
+            const uint8_t* data = (const uint8_t*) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED) return 0;
+
+            for (off_t i = 0; i < st.st_size; i++) {
+                hash ^= data[i];
+                hash *= 0x100000001b3ULL;
+            }
+            munmap((void*)data, st.st_size);
+
+            return hash;
+        }
+
+    private: /* Members */
+        std::string             srcPath_;       /* Model source file */
+        std::string             cachePath_;     /* Cache file */
+        uint8_t                 *base_;         /* Mapped cache */
+        size_t                  size_;          /* Mapped size */
+        const MeshCacheHeader   *header_;       /* Cache header */
+        const MeshCacheEntry    *entries_;      /* Per mesh table */
+};
+
+#endif
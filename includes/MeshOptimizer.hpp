@@ -0,0 +1,384 @@
+/******************************************
+
+* File Name : includes/MeshOptimizer.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Reorders imported triangle lists before their upload:
+ *  - vertex cache order, Tipsify (Sander, Nehab, Barczak 2007)
+ *  - overdraw, the Tipsify clusters sorted outside-in
+ *  - vertex fetch, vertices renumbered in first use order
+ *
+ * A FIFO post-transform cache simulator measures the result without
+ * a GPU: ACMR (cache misses per triangle, 0.5 is the ideal for large
+ * regular meshes, 3 the worst) and ATVR (misses per vertex, 1 ideal).
+ *
+ * CPU only, safe to run on the ThreadPool.
+ */
+
+#ifndef _LOGL_MESH_OPTIMIZER_HPP_
+#define _LOGL_MESH_OPTIMIZER_HPP_
+
+/* STD */
+#include <vector>
+#include <algorithm>
+
+#include <glm.hpp>
+
+#include "Mesh.hpp"
+
+#define MESH_OPT_CACHE_SIZE     16  /* Post-transform cache entries to optimize for */
+
+/**
+ * ******************************************************
+ * Cache simulation result
+ * ******************************************************
+**/
+struct MeshCacheStats {
+    float acmr;         /* Misses per triangle */
+    float atvr;         /* Misses per referenced vertex */
+};
+
+/**
+ * ******************************************************
+ * Before and after of MeshOptimizer::optimize
+ * ******************************************************
+**/
+struct MeshOptimizerReport {
+    bool            optimized;      /* False if the mesh was left alone */
+    MeshCacheStats  before;
+    MeshCacheStats  after;
+};
+
+/**
+ * ******************************************************
+ * @brief Mesh optimizer
+ * ******************************************************
+**/
+class MeshOptimizer {
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Run all the passes
+         *
+         * Meshes which are not plain triangle lists are left as
+         * they are.
+         *
+         * @param[in] vertices      - reordered, unused ones dropped
+         * @param[in] indices       - reordered and renumbered
+         * @param[in] cacheSize     - cache entries to optimize for
+         *
+         * @return the cache stats before and after
+         * ******************************************************
+        **/
+        static MeshOptimizerReport optimize(std::vector<Vertex> & vertices,
+                std::vector<unsigned int> & indices,
+                uint32_t cacheSize = MESH_OPT_CACHE_SIZE)
+        {
+            MeshOptimizerReport report;
+            report.optimized = false;
+            report.before = simulateCache(indices, vertices.size(), cacheSize);
+            report.after = report.before;
+
+            if (indices.size() < 3 || indices.size() % 3 != 0) return report;
+            for (size_t i = 0; i < indices.size(); i++) {
+                if (indices[i] >= vertices.size()) return report;
+            }
+
+            std::vector<uint32_t> clusters;
+            optimizeVertexCache(indices, vertices.size(), cacheSize, clusters);
+            optimizeOverdraw(indices, vertices, clusters);
+            optimizeVertexFetch(vertices, indices);
+
+            report.optimized = true;
+            report.after = simulateCache(indices, vertices.size(), cacheSize);
+            return report;
+        }
+
+        /**
+         * ******************************************************
+         * Tipsify
+         *
+         * Fans around a vertex, then moves to the neighbour that
+         * entered the cache earliest and will still be cached
+         * after its own fan.
+         * Whenever it has to jump to a vertex that is no longer
+         * cached a new cluster starts, those are what
+         * optimizeOverdraw sorts.
+         *
+         * @param[in] indices       - triangle list, reordered in place
+         * @param[in] vertexCount
+         * @param[in] cacheSize
+         * @param[out] clusters     - first triangle of each cluster
+         * ******************************************************
+        **/
+        static void optimizeVertexCache(std::vector<unsigned int> & indices, size_t vertexCount,
+                uint32_t cacheSize, std::vector<uint32_t> & clusters)
+        {
+            size_t triangleCount = indices.size() / 3;
+            clusters.clear();
+            if (triangleCount == 0) return;
+
+            /* Vertex to triangle adjacency, as offsets into one array */
+            std::vector<uint32_t> live(vertexCount, 0);
+            for (size_t i = 0; i < indices.size(); i++) live[indices[i]]++;
+
+            std::vector<uint32_t> offsets(vertexCount + 1, 0);
+            for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + live[v];
+
+            std::vector<uint32_t> adjacency(indices.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triangleCount; t++) {
+                for (int c = 0; c < 3; c++) adjacency[fill[indices[t * 3 + c]]++] = t;
+            }
+
+            std::vector<uint32_t> stamps(vertexCount, 0);     /* Time the vertex entered the cache */
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> deadEnd;                      /* Recently used vertices */
+            std::vector<uint32_t> candidates;
+            std::vector<unsigned int> out;
+            out.reserve(indices.size());
+
+            uint32_t time = cacheSize + 1;
+            size_t cursor = 0;
+            int64_t fan = skipDeadEnd(live, deadEnd, cursor);
+            clusters.push_back(0);
+
+            while (fan >= 0) {
+                candidates.clear();
+                for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++) {
+                    uint32_t t = adjacency[a];
+                    if (emitted[t]) continue;
+
+                    for (int c = 0; c < 3; c++) {
+                        uint32_t v = indices[t * 3 + c];
+                        out.push_back(v);
+                        deadEnd.push_back(v);
+                        candidates.push_back(v);
+                        live[v]--;
+                        if (time - stamps[v] > cacheSize) stamps[v] = time++;
+                    }
+                    emitted[t] = true;
+                }
+
+                /* Next fan: the candidate furthest back in the cache that survives its fan */
+                int64_t next = -1;
+                int64_t best = -1;
+                for (size_t c = 0; c < candidates.size(); c++) {
+                    uint32_t v = candidates[c];
+                    if (live[v] == 0) continue;
+
+                    int64_t priority = 0;
+                    if (time - stamps[v] + 2 * live[v] <= cacheSize) priority = time - stamps[v];
+                    if (priority > best) {
+                        best = priority;
+                        next = v;
+                    }
+                }
+
+                if (next < 0) {
+                    next = skipDeadEnd(live, deadEnd, cursor);
+                    /* Only a jump out of the cache starts a cluster, reordering those costs nothing */
+                    if (next >= 0 && time - stamps[next] > cacheSize) clusters.push_back(out.size() / 3);
+                }
+                fan = next;
+            }
+
+            indices.swap(out);
+        }
+
+        /**
+         * ******************************************************
+         * Overdraw
+         *
+         * Draws the clusters facing away from the mesh center
+         * first; for convex-ish meshes those occlude the rest.
+         * The order inside a cluster, and so the cache
+         * efficiency, is kept.
+         *
+         * @param[in] indices       - reordered in place
+         * @param[in] vertices
+         * @param[in] clusters      - from optimizeVertexCache
+         * ******************************************************
+        **/
+        static void optimizeOverdraw(std::vector<unsigned int> & indices,
+                const std::vector<Vertex> & vertices,
+                const std::vector<uint32_t> & clusters)
+        {
+            size_t triangleCount = indices.size() / 3;
+            if (clusters.size() < 2) return;
+
+            /* Mesh center, area weighted */
+            glm::vec3 center(0.0f, 0.0f, 0.0f);
+            float area = 0.0f;
+            for (size_t t = 0; t < triangleCount; t++) {
+                glm::vec3 normal;
+                float triangleArea;
+                glm::vec3 centroid = triangleCentroid(indices, vertices, t, normal, triangleArea);
+                center += centroid * triangleArea;
+                area += triangleArea;
+            }
+            if (area > 0.0f) center /= area;
+
+            struct Cluster {
+                uint32_t    first;
+                uint32_t    last;
+                float       sortKey;
+            };
+            std::vector<Cluster> sorted(clusters.size());
+
+            for (size_t c = 0; c < clusters.size(); c++) {
+                Cluster & cluster = sorted[c];
+                cluster.first = clusters[c];
+                cluster.last = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+
+                glm::vec3 clusterCenter(0.0f, 0.0f, 0.0f);
+                glm::vec3 clusterNormal(0.0f, 0.0f, 0.0f);
+                float clusterArea = 0.0f;
+                for (uint32_t t = cluster.first; t < cluster.last; t++) {
+                    glm::vec3 normal;
+                    float triangleArea;
+                    glm::vec3 centroid = triangleCentroid(indices, vertices, t, normal, triangleArea);
+                    clusterCenter += centroid * triangleArea;
+                    clusterNormal += normal;
+                    clusterArea += triangleArea;
+                }
+                if (clusterArea > 0.0f) clusterCenter /= clusterArea;
+
+                float length = glm::length(clusterNormal);
+                cluster.sortKey = length > 0.0f ? glm::dot(clusterCenter - center, clusterNormal / length) : 0.0f;
+            }
+
+            std::stable_sort(sorted.begin(), sorted.end(),
+                    [](const Cluster & a, const Cluster & b) { return a.sortKey > b.sortKey; });
+
+            std::vector<unsigned int> out;
+            out.reserve(indices.size());
+            for (size_t c = 0; c < sorted.size(); c++) {
+                out.insert(out.end(), indices.begin() + sorted[c].first * 3, indices.begin() + sorted[c].last * 3);
+            }
+            indices.swap(out);
+        }
+
+        /**
+         * ******************************************************
+         * Vertex fetch
+         *
+         * Renumbers the vertices in the order the indices first
+         * use them, so the fetches walk the VBO forward. Vertices
+         * no triangle uses are dropped.
+         *
+         * @param[in] vertices
+         * @param[in] indices
+         * ******************************************************
+        **/
+        static void optimizeVertexFetch(std::vector<Vertex> & vertices, std::vector<unsigned int> & indices)
+        {
+            const uint32_t UNUSED = 0xFFFFFFFF;
+            std::vector<uint32_t> remap(vertices.size(), UNUSED);
+            std::vector<Vertex> out;
+            out.reserve(vertices.size());
+
+            for (size_t i = 0; i < indices.size(); i++) {
+                uint32_t & slot = remap[indices[i]];
+                if (slot == UNUSED) {
+                    slot = out.size();
+                    out.push_back(vertices[indices[i]]);
+                }
+                indices[i] = slot;
+            }
+            vertices.swap(out);
+        }
+
+        /**
+         * ******************************************************
+         * FIFO post-transform cache simulator
+         *
+         * @param[in] indices       - triangle list
+         * @param[in] vertexCount
+         * @param[in] cacheSize     - FIFO entries
+         * ******************************************************
+        **/
+        static MeshCacheStats simulateCache(const std::vector<unsigned int> & indices,
+                size_t vertexCount, uint32_t cacheSize = MESH_OPT_CACHE_SIZE)
+        {
+            MeshCacheStats stats = { 0.0f, 0.0f };
+            if (indices.size() < 3 || vertexCount == 0) return stats;
+
+            /* A vertex is cached if fewer than cacheSize misses happened since it was loaded */
+            std::vector<uint64_t> loadedAt(vertexCount, 0);
+            std::vector<bool> referenced(vertexCount, false);
+            uint64_t misses = 0;
+            size_t unique = 0;
+
+            for (size_t i = 0; i < indices.size(); i++) {
+                uint32_t v = indices[i];
+                if (v >= vertexCount) continue;
+
+                if (!referenced[v]) {
+                    referenced[v] = true;
+                    unique++;
+                }
+                if (loadedAt[v] == 0 || misses + 1 - loadedAt[v] > cacheSize) {
+                    misses++;
+                    loadedAt[v] = misses;
+                }
+            }
+
+            stats.acmr = (float)misses / (indices.size() / 3);
+            stats.atvr = unique ? (float)misses / unique : 0.0f;
+            return stats;
+        }
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Tipsify's dead end escape: a recently used vertex with
+         * triangles left, else the next such vertex in order.
+         * ******************************************************
+        **/
+        static int64_t skipDeadEnd(const std::vector<uint32_t> & live,
+                std::vector<uint32_t> & deadEnd, size_t & cursor)
+        {
+            while (!deadEnd.empty()) {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) return v;
+            }
+            for (; cursor < live.size(); cursor++) {
+                if (live[cursor] > 0) return cursor;
+            }
+            return -1;
+        }
+
+        /**
+         * ******************************************************
+         * Centroid, area weighted normal and area of triangle t
+         * ******************************************************
+        **/
+        static glm::vec3 triangleCentroid(const std::vector<unsigned int> & indices,
+                const std::vector<Vertex> & vertices, size_t t,
+                glm::vec3 & normal, float & area)
+        {
+            const glm::vec3 & a = vertices[indices[t * 3 + 0]].pos_;
+            const glm::vec3 & b = vertices[indices[t * 3 + 1]].pos_;
+            const glm::vec3 & c = vertices[indices[t * 3 + 2]].pos_;
+
+            normal = glm::cross(b - a, c - a);
+            area = 0.5f * glm::length(normal);
+            return (a + b + c) / 3.0f;
+        }
+};
+
+#endif
@@ -0,0 +1,499 @@
+/******************************************
+
+* File Name : includes/MipChain.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Builds the mip chain of an 8 bit image on the CPU, instead of
+ * glGenerateMipmap. Pure CPU work, runs on the loader threads and in
+ * tools/texcompress.
+ *
+ * Each level is filtered from the float copy of the one above, not
+ * from its 8 bit rounding. With sRGB on, the color channels are
+ * filtered in linear light; averaging the encoded values darkens
+ * every level. Alpha is always linear.
+ *
+ * Level 0 stays 8 bit, its rows are expanded as the filter reaches
+ * them. Only the level being read and the one being written are
+ * whole float copies, at most 5 bytes per source texel, and the
+ * Kaiser rows go through a ring of MIP_KAISER_ROWS.
+ *
+ * Filters: a 2x2 box, or a 6 tap Kaiser windowed sinc that keeps
+ * the next level sharper. The inner loops have scalar, SSE and AVX2
+ * versions with the same operation order, so they agree bit for bit;
+ * AVX2 is picked at runtime, the build needs no -m flags.
+ */
+
+#ifndef _LOGL_MIP_CHAIN_HPP_
+#define _LOGL_MIP_CHAIN_HPP_
+
+/* STD */
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MIP_X86 1
+#include <immintrin.h>
+#endif
+
+#define MIP_KAISER_TAPS     6
+#define MIP_KAISER_ALPHA    4.0     /* Window shape, higher is smoother */
+#define MIP_KAISER_ROWS     8       /* Filtered rows kept, a power of 2 above the taps */
+#define MIP_SRGB_LUT_SIZE   4096    /* Linear to sRGB, under 1 LSB off */
+
+/**
+ * ******************************************************
+ * Downsampling filters
+ * ******************************************************
+**/
+typedef enum {
+    MF_BOX      = 0,
+    MF_KAISER   = 1,
+} MipFilter;
+
+/**
+ * ******************************************************
+ * Inner loop versions
+ * ******************************************************
+**/
+typedef enum {
+    MS_SCALAR   = 0,
+    MS_SSE      = 1,
+    MS_AVX2     = 2,
+} MipSimd;
+
+/**
+ * ******************************************************
+ * @brief Mip chain of an image
+ *
+ * Level 0 is the source and is not copied; getLevel()
+ * returns the levels from 1 down to 1x1.
+ * ******************************************************
+**/
+class MipChain {
+    public: /* Constructors */
+        MipChain() :
+            width_(0), height_(0), channels_(0)
+        {
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Build the chain
+         *
+         * @param[in] pixels        - level 0, tightly packed
+         * @param[in] width
+         * @param[in] height
+         * @param[in] channels      - 1 to 4, 2 is grey and alpha
+         * @param[in] filter
+         * @param[in] srgb          - the color channels are sRGB encoded
+         * @param[in] simd          - inner loop version
+         * ******************************************************
+        **/
+        void build(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+                MipFilter filter, bool srgb, MipSimd simd = bestSimd())
+        {
+            width_ = width;
+            height_ = height;
+            channels_ = channels;
+            levels_.clear();
+            if (width == 0 || height == 0 || channels == 0 || channels > 4) return;
+
+            /* RGBA floats whatever the channel count, one pixel per SSE register */
+            std::vector<float> current, next;
+            const float* src = NULL;    /* Level 0 is read from pixels */
+
+            uint32_t w = width, h = height;
+            while (w > 1 || h > 1) {
+                uint32_t nw = w > 1 ? w / 2 : 1, nh = h > 1 ? h / 2 : 1;
+                next.resize((size_t)nw * nh * 4);
+
+                if (filter == MF_KAISER) {
+                    kaiser(src, pixels, w, h, srgb, next.data(), nw, nh, simd);
+                } else {
+                    box(src, pixels, w, h, srgb, next.data(), nw, nh, simd);
+                }
+
+                levels_.push_back(std::vector<uint8_t>((size_t)nw * nh * channels));
+                pack(next.data(), nw, nh, srgb, levels_.back().data());
+
+                current.swap(next);
+                src = current.data();
+                w = nw;
+                h = nh;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Getters. Levels count from 0, the source.
+         * ******************************************************
+        **/
+        uint32_t getLevelCount() { return levels_.size() + 1; }
+        uint32_t getLevelWidth(uint32_t level) { return (width_ >> level) ? (width_ >> level) : 1; }
+        uint32_t getLevelHeight(uint32_t level) { return (height_ >> level) ? (height_ >> level) : 1; }
+        uint32_t getChannels() { return channels_; }
+
+        /* Level 1 and down */
+        const uint8_t* getLevel(uint32_t level) { return levels_[level - 1].data(); }
+
+        /**
+         * ******************************************************
+         * The fastest version this CPU runs
+         * ******************************************************
+        **/
+        static MipSimd bestSimd()
+        {
+#ifdef MIP_X86
+            return __builtin_cpu_supports("avx2") ? MS_AVX2 : MS_SSE;
+#else
+            return MS_SCALAR;
+#endif
+        }
+
+        static const char* simdName(MipSimd simd)
+        {
+            switch (simd) {
+                case MS_AVX2:   return "AVX2";
+                case MS_SSE:    return "SSE";
+                default:        return "scalar";
+            }
+        }
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * sRGB tables, built once
+         * ******************************************************
+        **/
+        static const float* toLinearTable()
+        {
+            struct Table {
+                Table()
+                {
+                    for (uint32_t i = 0; i < 256; i++) {
+                        double c = i / 255.0;
+                        values[i] = (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+                    }
+                }
+                float values[256];
+            };
+            static Table table;
+            return table.values;
+        }
+
+        static const uint8_t* toSrgbTable()
+        {
+            struct Table {
+                Table()
+                {
+                    for (uint32_t i = 0; i < MIP_SRGB_LUT_SIZE; i++) {
+                        double l = (double)i / (MIP_SRGB_LUT_SIZE - 1);
+                        double c = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+                        values[i] = (uint8_t)(c * 255.0 + 0.5);
+                    }
+                }
+                uint8_t values[MIP_SRGB_LUT_SIZE];
+            };
+            static Table table;
+            return table.values;
+        }
+
+        /**
+         * ******************************************************
+         * Normalized Kaiser windowed sinc for 2:1, the taps sit
+         * at -2.5 .. 2.5 source pixels from the output center
+         * ******************************************************
+        **/
+        static const float* kaiserWeights()
+        {
+            struct Weights {
+                static double bessel0(double x)
+                {
+                    double sum = 1.0, term = 1.0;
+                    for (uint32_t k = 1; k < 20; k++) {
+                        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                        sum += term;
+                    }
+                    return sum;
+                }
+
+                Weights()
+                {
+                    const double radius = MIP_KAISER_TAPS / 4.0; /* In output pixels */
+                    double total = 0;
+                    for (uint32_t k = 0; k < MIP_KAISER_TAPS; k++) {
+                        double t = (k - (MIP_KAISER_TAPS - 1) / 2.0) / 2.0;
+                        double sinc = t == 0 ? 1.0 : sin(M_PI * t) / (M_PI * t);
+                        double r = t / radius;
+                        double window = bessel0(MIP_KAISER_ALPHA * sqrt(1.0 - r * r)) / bessel0(MIP_KAISER_ALPHA);
+                        values[k] = sinc * window;
+                        total += values[k];
+                    }
+                    for (uint32_t k = 0; k < MIP_KAISER_TAPS; k++) values[k] /= total;
+                }
+                float values[MIP_KAISER_TAPS];
+            };
+            static Weights weights;
+            return weights.values;
+        }
+
+        /**
+         * ******************************************************
+         * 8 bit source to linear RGBA floats
+         * ******************************************************
+        **/
+        void expand(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb, float* out)
+        {
+            const float* linear = toLinearTable();
+            uint32_t colors = colorChannels();
+            size_t count = (size_t)width * height;
+            for (size_t i = 0; i < count; i++) {
+                for (uint32_t c = 0; c < 4; c++) {
+                    if (c >= channels_) {
+                        out[i * 4 + c] = 0.0f;
+                    } else {
+                        uint8_t v = pixels[i * channels_ + c];
+                        out[i * 4 + c] = (srgb && c < colors) ? linear[v] : v / 255.0f;
+                    }
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Linear RGBA floats back to 8 bit, clamped; the Kaiser
+         * lobes overshoot at hard edges
+         * ******************************************************
+        **/
+        void pack(const float* in, uint32_t width, uint32_t height, bool srgb, uint8_t* out)
+        {
+            const uint8_t* encode = toSrgbTable();
+            uint32_t colors = colorChannels();
+            size_t count = (size_t)width * height;
+            for (size_t i = 0; i < count; i++) {
+                for (uint32_t c = 0; c < channels_; c++) {
+                    float v = in[i * 4 + c];
+                    v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+                    if (srgb && c < colors) {
+                        out[i * channels_ + c] = encode[(uint32_t)(v * (MIP_SRGB_LUT_SIZE - 1) + 0.5f)];
+                    } else {
+                        out[i * channels_ + c] = (uint8_t)(v * 255.0f + 0.5f);
+                    }
+                }
+            }
+        }
+
+        /* RGB or grey are sRGB, alpha never */
+        uint32_t colorChannels() { return channels_ >= 3 ? 3 : 1; }
+
+        /* Row y of the level read, from the float level or expanded from level 0 into scratch */
+        const float* sourceRow(const float* src, const uint8_t* pixels, uint32_t w, uint32_t y, bool srgb,
+                float* scratch)
+        {
+            if (src != NULL) return src + (size_t)y * w * 4;
+            expand(pixels + (size_t)y * w * channels_, w, 1, srgb, scratch);
+            return scratch;
+        }
+
+        static uint32_t clampIndex(int64_t i, uint32_t size)
+        {
+            return i < 0 ? 0 : (i >= (int64_t)size ? size - 1 : (uint32_t)i);
+        }
+
+        /**
+         * ******************************************************
+         * 2x2 box. An odd last row or column is dropped, a size
+         * of 1 is repeated.
+         * ******************************************************
+        **/
+        void box(const float* src, const uint8_t* pixels, uint32_t w, uint32_t h, bool srgb,
+                float* dst, uint32_t nw, uint32_t nh, MipSimd simd)
+        {
+            std::vector<float> scratch(src != NULL ? 0 : (size_t)w * 8);
+            for (uint32_t y = 0; y < nh; y++) {
+                const float* row0 = sourceRow(src, pixels, w, clampIndex(2 * y, h), srgb, scratch.data());
+                const float* row1 = sourceRow(src, pixels, w, clampIndex(2 * y + 1, h), srgb, scratch.data() + w * 4);
+                float* out = dst + (size_t)y * nw * 4;
+                uint32_t x = 0;
+#ifdef MIP_X86
+                if (simd == MS_AVX2 && w > 1)   x = boxRowAVX2(row0, row1, out, nw);
+                if (simd >= MS_SSE)             x = boxRowSSE(row0, row1, w, out, x, nw);
+#endif
+                for (; x < nw; x++) {
+                    const float* a = row0 + clampIndex(2 * x, w) * 4;
+                    const float* b = row0 + clampIndex(2 * x + 1, w) * 4;
+                    const float* c = row1 + clampIndex(2 * x, w) * 4;
+                    const float* d = row1 + clampIndex(2 * x + 1, w) * 4;
+                    for (uint32_t ch = 0; ch < 4; ch++) {
+                        out[x * 4 + ch] = (((a[ch] + b[ch]) + (c[ch] + d[ch]))) * 0.25f;
+                    }
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Separable Kaiser. Each source row is filtered across
+         * once, into ring slot row % MIP_KAISER_ROWS; the taps of
+         * an output row span 6 rows, so they never share a slot.
+         * ******************************************************
+        **/
+        void kaiser(const float* src, const uint8_t* pixels, uint32_t w, uint32_t h, bool srgb,
+                float* dst, uint32_t nw, uint32_t nh, MipSimd simd)
+        {
+            const float* weights = kaiserWeights();
+            const int32_t first = -(MIP_KAISER_TAPS / 2 - 1);
+
+            std::vector<float> rows((size_t)MIP_KAISER_ROWS * nw * 4 + (src != NULL ? 0 : (size_t)w * 4));
+            float* scratch = rows.data() + (size_t)MIP_KAISER_ROWS * nw * 4;
+            int64_t held[MIP_KAISER_ROWS];  /* Source row in each slot */
+            for (uint32_t i = 0; i < MIP_KAISER_ROWS; i++) held[i] = -1;
+
+            /* Vertical, h -> nh, nw pixels a row */
+            for (uint32_t y = 0; y < nh; y++) {
+                const float* taps[MIP_KAISER_TAPS];
+                for (int32_t k = 0; k < MIP_KAISER_TAPS; k++) {
+                    uint32_t row = h == 1 ? 0 : clampIndex((int64_t)2 * y + first + k, h);
+                    float* slot = rows.data() + (size_t)(row % MIP_KAISER_ROWS) * nw * 4;
+                    if (held[row % MIP_KAISER_ROWS] != row) {
+                        across(sourceRow(src, pixels, w, row, srgb, scratch), w, slot, nw, weights, simd);
+                        held[row % MIP_KAISER_ROWS] = row;
+                    }
+                    taps[k] = slot;
+                }
+                if (h == 1) {
+                    memcpy(dst + (size_t)y * nw * 4, taps[0], (size_t)nw * 4 * sizeof(float));
+                    continue;
+                }
+                weigh(taps, weights, dst + (size_t)y * nw * 4, nw, simd);
+            }
+        }
+
+        /* Horizontal Kaiser of one row, w -> nw; a width of 1 stays */
+        static void across(const float* row, uint32_t w, float* out, uint32_t nw, const float* weights, MipSimd simd)
+        {
+            const int32_t first = -(MIP_KAISER_TAPS / 2 - 1);
+            if (w == 1) {
+                memcpy(out, row, 4 * sizeof(float));
+                return;
+            }
+            for (uint32_t x = 0; x < nw; x++) {
+                const float* taps[MIP_KAISER_TAPS];
+                for (int32_t k = 0; k < MIP_KAISER_TAPS; k++) {
+                    taps[k] = row + clampIndex((int64_t)2 * x + first + k, w) * 4;
+                }
+                weigh(taps, weights, out + x * 4, 1, simd);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * out[i] = sum of weights[k] * taps[k][i], for count RGBA
+         * pixels, taps in order
+         * ******************************************************
+        **/
+        static void weigh(const float* const* taps, const float* weights, float* out, uint32_t count, MipSimd simd)
+        {
+            size_t floats = (size_t)count * 4, i = 0;
+#ifdef MIP_X86
+            if (simd == MS_AVX2)    i = weighAVX2(taps, weights, out, floats);
+            if (simd >= MS_SSE)     i = weighSSE(taps, weights, out, i, floats);
+#endif
+            for (; i < floats; i++) {
+                float sum = 0.0f;
+                for (uint32_t k = 0; k < MIP_KAISER_TAPS; k++) sum = sum + weights[k] * taps[k][i];
+                out[i] = sum;
+            }
+        }
+
+#ifdef MIP_X86
+        /**
+         * ******************************************************
+         * SSE and AVX2 inner loops, return where they stopped
+         * ******************************************************
+        **/
+        static uint32_t boxRowSSE(const float* row0, const float* row1, uint32_t w, float* out,
+                uint32_t x, uint32_t nw)
+        {
+            const __m128 quarter = _mm_set1_ps(0.25f);
+            for (; x < nw; x++) {
+                __m128 a = _mm_loadu_ps(row0 + clampIndex(2 * x, w) * 4);
+                __m128 b = _mm_loadu_ps(row0 + clampIndex(2 * x + 1, w) * 4);
+                __m128 c = _mm_loadu_ps(row1 + clampIndex(2 * x, w) * 4);
+                __m128 d = _mm_loadu_ps(row1 + clampIndex(2 * x + 1, w) * 4);
+                _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)), quarter));
+            }
+            return x;
+        }
+
+        /* Two output pixels from four source pixels per row; only where 2x + 3 < w */
+        __attribute__((target("avx2")))
+        static uint32_t boxRowAVX2(const float* row0, const float* row1, float* out, uint32_t nw)
+        {
+            const __m256 quarter = _mm256_set1_ps(0.25f);
+            uint32_t x = 0;
+            for (; x + 2 <= nw; x += 2) {
+                __m256 a01 = _mm256_loadu_ps(row0 + 2 * x * 4);         /* p0 p1 */
+                __m256 a23 = _mm256_loadu_ps(row0 + 2 * x * 4 + 8);     /* p2 p3 */
+                __m256 c01 = _mm256_loadu_ps(row1 + 2 * x * 4);
+                __m256 c23 = _mm256_loadu_ps(row1 + 2 * x * 4 + 8);
+                __m256 a = _mm256_permute2f128_ps(a01, a23, 0x20);      /* p0 p2 */
+                __m256 b = _mm256_permute2f128_ps(a01, a23, 0x31);      /* p1 p3 */
+                __m256 c = _mm256_permute2f128_ps(c01, c23, 0x20);
+                __m256 d = _mm256_permute2f128_ps(c01, c23, 0x31);
+                _mm256_storeu_ps(out + x * 4,
+                        _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(a, b), _mm256_add_ps(c, d)), quarter));
+            }
+            return x;
+        }
+
+        static size_t weighSSE(const float* const* taps, const float* weights, float* out, size_t i, size_t floats)
+        {
+            for (; i + 4 <= floats; i += 4) {
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t k = 0; k < MIP_KAISER_TAPS; k++) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(taps[k] + i)));
+                }
+                _mm_storeu_ps(out + i, sum);
+            }
+            return i;
+        }
+
+        __attribute__((target("avx2")))
+        static size_t weighAVX2(const float* const* taps, const float* weights, float* out, size_t floats)
+        {
+            size_t i = 0;
+            for (; i + 8 <= floats; i += 8) {
+                __m256 sum = _mm256_setzero_ps();
+                for (uint32_t k = 0; k < MIP_KAISER_TAPS; k++) {
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(taps[k] + i)));
+                }
+                _mm256_storeu_ps(out + i, sum);
+            }
+            return i;
+        }
+#endif
+
+    private: /* Members */
+        uint32_t                            width_;     /* Level 0 width */
+        uint32_t                            height_;    /* Level 0 height */
+        uint32_t                            channels_;  /* Per pixel, as the source */
+        std::vector<std::vector<uint8_t>>   levels_;    /* Level 1 down to 1x1 */
+};
+
+#endif
@@ -23,6 +23,9 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
 
 /* ASSIMP */
 #include <assimp/Importer.hpp>
@@ -30,7 +33,25 @@
 #include <assimp/postprocess.h>
 
 #include "Mesh.hpp"
+#include "MeshCache.hpp"
 #include "Program.hpp"
+#include "ThreadPool.hpp"
+#include "RenderQueue.hpp"
+#include "MeshOptimizer.hpp"
+#include "TextureManager.hpp"
+#include "TextureArray.hpp"
+
+/**
+ * ******************************************************
+ * CPU side data of an imported mesh
+ * ******************************************************
+**/
+struct MeshData {
+    std::vector<Vertex>         vertices;
+    std::vector<unsigned int>   indices;
+    std::vector<MeshTextureRef> textures;
+    MeshOptimizerReport         report;     /* Only filled when optimizing */
+};
 
 /**
  * ******************************************************
@@ -42,125 +63,165 @@ class Model
     public: /* Constructors */
         /**
          * ******************************************************
-         * TODO DOC THIS
+         * Model constructor
+         *
+         * @param[in] path          - model file path
+         * @param[in] drawType      - buffer usage for the meshes
+         * @param[in] useCache      - read/write the binary mesh cache
+         * @param[in] retention     - CPU copy policy for the meshes
+         * @param[in] optimize      - reorder imported meshes for the vertex
+         *                            cache and overdraw, see MeshOptimizer.
+         *                            A mesh cache written with the other
+         *                            setting is rebuilt.
+         * @param[in] packTextures  - pack the material textures into
+         *                            texture arrays, see TextureArray.
+         *                            Draw with a TEXTURE_ARRAYS program.
+         * @param[in] useArena      - place the meshes in the MeshArena,
+         *                            drawn with multi draws, see RenderQueue
          * ******************************************************
         **/
-        Model(char *path, uint32_t drawType)
+        Model(const char *path, uint32_t drawType, bool useCache = true,
+                BufferRetention retention = BR_DISCARD, bool optimize = false, bool packTextures = false,
+                bool useArena = false) :
+            path(path), retention(retention), optimize(optimize), packTextures(packTextures), useArena(useArena)
         {
-            loadModel(path, drawType);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            MeshCache cache(path);
+            bool cached = useCache && cache.open(optimize);
+            if (cached) {
+                loadCache(path, cache, drawType);
+            } else {
+                loadModel(path, drawType, useCache);
+            }
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            LOG(L_INFO, "Loaded model %s in %.2f ms (%s).", path, elapsed.count(),
+                    cached ? "mesh cache" : "assimp import");
+            printMemoryReport();
         }
 
         /**
          * ******************************************************
-         * TODO DOC THIS
+         * Destructor, hands the textures back to the manager
          * ******************************************************
         **/
-        void draw(Program & program)
+        ~Model()
         {
-            for (uint32_t i = 0; i< meshes.size(); i++) {
-                meshes[i].get()->draw(program);
+            meshes.clear();
+            for (auto it = loadedTextures.begin(); it != loadedTextures.end(); ++it) {
+                TextureManager::get().release(it->second);
             }
         }
 
-    private: /* Methods */
+        /**
+         * ******************************************************
+         * Log the memory held by the model meshes
+         * ******************************************************
+        **/
+        void printMemoryReport()
+        {
+            size_t cpuBytes = 0, gpuBytes = 0;
+            for (uint32_t i = 0; i < meshes.size(); i++) {
+                cpuBytes += meshes[i]->getCpuBytes();
+                gpuBytes += meshes[i]->getGpuBytes();
+            }
+            LOG(L_INFO, "Model %s: %lu meshes, buffers %lu KiB, resident CPU copies %lu KiB.",
+                    path.c_str(), (unsigned long)meshes.size(),
+                    (unsigned long)(gpuBytes / 1024), (unsigned long)(cpuBytes / 1024));
+        }
 
         /**
          * ******************************************************
-         * Load Model
+         * Draw the meshes through the render queue, sorted by
+         * material and VAO so shared textures are bound once.
          *
-         * @param[in] path
+         * @param[in] program
          * ******************************************************
         **/
-        void loadModel(std::string path, uint32_t drawType)
+        void draw(Program & program)
         {
-            Assimp::Importer import;
-            const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);    
-            
-            if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) 
-            {
-                LOG(L_ERR, "ERROR::ASSIMP::%s", import.GetErrorString());
-                return;
+            for (uint32_t i = 0; i< meshes.size(); i++) {
+                queue.push(program, meshes[i].get());
             }
-            directory = path.substr(0, path.find_last_of('/'));
-
-            processNode(scene->mRootNode, scene, drawType);
+            queue.submit();
         }
 
         /**
          * ******************************************************
-         * Process Node
-         * TODO Doc this 
+         * Draw every instance of a buffer, one instanced draw per
+         * mesh, through the render queue. Needs a program built
+         * with INSTANCED.
+         *
+         * @param[in] program
+         * @param[in] instances
          * ******************************************************
         **/
-        void processNode(aiNode *node, const aiScene *scene, uint32_t drawType)
+        void drawInstanced(Program & program, InstanceBuffer & instances)
         {
-            // process all the node's meshes (if any)
-            for(unsigned int i = 0; i < node->mNumMeshes; i++)
-            {
-                aiMesh *mesh = scene->mMeshes[node->mMeshes[i]]; 
-                meshes.push_back(std::unique_ptr<Mesh>(processMesh(mesh, scene, drawType)));            
-            }
-            // then do the same for each of its children
-            for(unsigned int i = 0; i < node->mNumChildren; i++)
-            {
-                processNode(node->mChildren[i], scene, drawType);
+            if (instances.getCount() == 0) return;
+            for (uint32_t i = 0; i < meshes.size(); i++) {
+                meshes[i]->setInstanceBuffer(instances);
+                queue.push(program, meshes[i].get(), 0.0f, instances.getCount());
             }
+            queue.submit();
         }
 
+        /**
+         * ******************************************************
+         * State changes issued and saved by draw()
+         * ******************************************************
+        **/
+        const RenderQueueStats& getRenderStats() { return queue.getStats(); }
+        void resetRenderStats() { queue.resetStats(); }
+
+        size_t getMeshCount() { return meshes.size(); }
 
         /**
          * ******************************************************
          * Process Mesh
-         * TODO DOC THIS
+         *
+         * Extracts the vertices, indices and texture references.
+         * Runs on the loader threads, static so it can't touch
+         * the model members; must not touch GL either. Public
+         * for the allocation count test, see tests/importalloc.
+         *
+         * @param[in]  mesh
+         * @param[in]  scene
+         * @param[out] out          - the extracted mesh data
          * ******************************************************
         **/
-        Mesh* processMesh(aiMesh *mesh, const aiScene *scene, uint32_t drawType)
+        static void processMesh(const aiMesh *mesh, const aiScene *scene, MeshData & out)
         {
-            // data to fill
-            std::vector<Vertex> vertices;
-            std::vector<unsigned int> indices;
-            std::vector<float> data;
+            // data to fill, sized exactly once
+            std::vector<Vertex> & vertices = out.vertices;
+            std::vector<unsigned int> & indices = out.indices;
+            vertices.resize(mesh->mNumVertices);
 
             // Walk through each of the mesh's vertices
+            const aiVector3D *texCoords = mesh->mTextureCoords[0];
             for(unsigned int i = 0; i < mesh->mNumVertices; i++)
             {
-                Vertex vertex;
-                glm::vec3 vector; 
+                Vertex & vertex = vertices[i];
                 // positions
-                vector.x = mesh->mVertices[i].x;
-                data.push_back(mesh->mVertices[i].x);
-                vector.y = mesh->mVertices[i].y;
-                data.push_back(mesh->mVertices[i].y);
-                vector.z = mesh->mVertices[i].z;
-                data.push_back(mesh->mVertices[i].z);
-                vertex.pos_ = vector;
+                vertex.pos_ = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
                 // normals
-                vector.x = mesh->mNormals[i].x;
-                data.push_back(mesh->mNormals[i].x);
-                vector.y = mesh->mNormals[i].y;
-                data.push_back(mesh->mNormals[i].y);
-                vector.z = mesh->mNormals[i].z;
-                data.push_back(mesh->mNormals[i].z);
-                vertex.normal_ = vector;
+                if (mesh->mNormals) {
+                    vertex.normal_ = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+                } else {
+                    vertex.normal_ = glm::vec3(0.0f, 0.0f, 0.0f);
+                }
                 // texture coordinates
-                
-                if(mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
+                // a vertex can contain up to 8 different texture coordinates. 
+                // We thus make the assumption that we won't 
+                // use models where a vertex can have multiple texture
+                // coordinates so we always take the first set (0).
+                if(texCoords) // does the mesh contain texture coordinates?
                 {
-                    glm::vec2 vec;
-                    // a vertex can contain up to 8 different texture coordinates. 
-                    // We thus make the assumption that we won't 
-                    // use models where a vertex can have multiple texture
-                    // coordinates so we always take the first set (0).
-                    vec.x = mesh->mTextureCoords[0][i].x; 
-                    data.push_back(mesh->mTextureCoords[0][i].x);
-                    vec.y = mesh->mTextureCoords[0][i].y;
-                    data.push_back(mesh->mTextureCoords[0][i].y);
-                    vertex.texCoords_ = vec;
+                    vertex.texCoords_ = glm::vec2(texCoords[i].x, texCoords[i].y);
                 }
                 else
                 {
-                    data.push_back(0);
-                    data.push_back(0);
                     vertex.texCoords_ = glm::vec2(0.0f, 0.0f);
                 }
 
@@ -174,24 +235,30 @@ class Model
                // vector.y = mesh->mBitangents[i].y;
                // vector.z = mesh->mBitangents[i].z;
                // vertex.Bitangent = vector;
-                vertices.push_back(vertex);
             }
 
             // now wak through each of the mesh's faces
             // (a face is a mesh its triangle) 
             // and retrieve the corresponding vertex indices.
+            // Faces are mostly triangles, but count them, points and lines can remain.
+            size_t indexCount = 0;
+            for(unsigned int i = 0; i < mesh->mNumFaces; i++)
+            {
+                indexCount += mesh->mFaces[i].mNumIndices;
+            }
+            indices.resize(indexCount);
 
+            unsigned int *dst = indices.data();
             for(unsigned int i = 0; i < mesh->mNumFaces; i++)
             {
-                aiFace face = mesh->mFaces[i];
+                const aiFace & face = mesh->mFaces[i];
                 // retrieve all indices of the face and store them in the indices vector
-                for(unsigned int j = 0; j < face.mNumIndices; j++) {
-                    indices.push_back(face.mIndices[j]);
-                }
+                memcpy(dst, face.mIndices, face.mNumIndices * sizeof(unsigned int));
+                dst += face.mNumIndices;
             }
 
             // process materials
-            aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
+            const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
             // we assume a convention for sampler names in the shaders. 
             // Each diffuse texture should be named
             // as 'texture_diffuseN' where N is a 
@@ -202,23 +269,223 @@ class Model
             // specular: texture_specularN
             // normal: texture_normalN
 
-            std::vector<Texture*> meshTextures;
             // 1. diffuse maps
-            loadMaterialTextures(loadedTextures, meshTextures, material, aiTextureType_DIFFUSE);
+            loadMaterialTextures(out.textures, material, aiTextureType_DIFFUSE);
 
             // 2. specular maps
-            loadMaterialTextures(loadedTextures, meshTextures, material, aiTextureType_SPECULAR);
+            loadMaterialTextures(out.textures, material, aiTextureType_SPECULAR);
 
             // 3. normal maps 
-            loadMaterialTextures(loadedTextures, meshTextures, material, aiTextureType_NORMALS);
+            loadMaterialTextures(out.textures, material, aiTextureType_NORMALS);
 
             // 4. height maps
-            loadMaterialTextures(loadedTextures, meshTextures, material, aiTextureType_HEIGHT);
+            loadMaterialTextures(out.textures, material, aiTextureType_HEIGHT);
+        }
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Log the simulated vertex cache efficiency of the
+         * optimized meshes, see MeshOptimizer::simulateCache
+         * ******************************************************
+        **/
+        void printOptimizerReport(const std::vector<MeshData> & meshData)
+        {
+            double trianglesTotal = 0, missesBefore = 0, missesAfter = 0;
+            for (uint32_t i = 0; i < meshData.size(); i++) {
+                const MeshOptimizerReport & report = meshData[i].report;
+                LOG(L_DBG, "Mesh %u: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f%s", i,
+                        report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr,
+                        report.optimized ? "." : ", not a triangle list, skipped.");
+
+                double triangles = meshData[i].indices.size() / 3;
+                trianglesTotal += triangles;
+                missesBefore += report.before.acmr * triangles;
+                missesAfter += report.after.acmr * triangles;
+            }
+            if (trianglesTotal > 0) {
+                LOG(L_INFO, "Mesh optimizer: ACMR %.3f -> %.3f over %lu meshes (FIFO %d).",
+                        missesBefore / trianglesTotal, missesAfter / trianglesTotal,
+                        (unsigned long)meshData.size(), MESH_OPT_CACHE_SIZE);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Load Model
+         *
+         * @param[in] path
+         * ******************************************************
+        **/
+        void loadModel(std::string path, uint32_t drawType, bool writeCache)
+        {
+            Assimp::Importer import;
+            const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);    
             
-            // return a mesh object created from the extracted mesh data
-            return new Mesh(vertices, indices, meshTextures, drawType, data);
+            if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) 
+            {
+                LOG(L_ERR, "ERROR::ASSIMP::%s", import.GetErrorString());
+                return;
+            }
+            directory = path.substr(0, path.find_last_of('/'));
+
+            /* Flatten the node tree, this fixes the mesh (and draw) order */
+            std::vector<const aiMesh*> aiMeshes;
+            processNode(scene->mRootNode, scene, aiMeshes);
+
+            /* CPU side extraction on the pool, one slot per mesh */
+            std::vector<MeshData> meshData(aiMeshes.size());
+            ThreadPool::global().parallelFor(aiMeshes.size(), [&](uint32_t i) {
+                processMesh(aiMeshes[i], scene, meshData[i]);
+                if (optimize) {
+                    meshData[i].report = MeshOptimizer::optimize(meshData[i].vertices, meshData[i].indices);
+                }
+            });
+            if (optimize) printOptimizerReport(meshData);
+
+            size_t vertexCount = 0, indexCount = 0;
+            for (uint32_t i = 0; i < meshData.size(); i++) {
+                vertexCount += meshData[i].vertices.size();
+                indexCount  += meshData[i].indices.size();
+            }
+            LOG(L_INFO, "Imported %lu meshes, %lu vertices, %lu indices, %lu KiB.",
+                    (unsigned long)meshData.size(), (unsigned long)vertexCount, (unsigned long)indexCount,
+                    (unsigned long)((vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int)) / 1024));
+
+            /* Save the imported meshes for the next run, before they are moved into the meshes */
+            if (writeCache) {
+                std::vector<MeshCacheRecord> records(meshData.size());
+                for (uint32_t i = 0; i < meshData.size(); i++) {
+                    records[i].vertices     = meshData[i].vertices.data();
+                    records[i].vertexCount  = meshData[i].vertices.size();
+                    records[i].indices      = meshData[i].indices.data();
+                    records[i].indexCount   = meshData[i].indices.size();
+                    records[i].textures     = &meshData[i].textures;
+                }
+                MeshCache cache(path);
+                cache.write(records, optimize);
+            }
+
+            /* GL side, on the context thread */
+            size_t firstMesh = meshes.size();
+            std::vector<std::vector<MeshTextureRef>> materials;
+            meshes.reserve(meshes.size() + meshData.size());
+            for (uint32_t i = 0; i < meshData.size(); i++) {
+                std::vector<Texture*> meshTextures;
+                if (packTextures) {
+                    materials.push_back(meshData[i].textures);
+                } else {
+                    meshTextures.reserve(meshData[i].textures.size());
+                    for (uint32_t t = 0; t < meshData[i].textures.size(); t++) {
+                        meshTextures.push_back(getTexture(meshData[i].textures[t].name,
+                                    (aiTextureType)meshData[i].textures[t].type));
+                    }
+                }
+                meshes.push_back(std::unique_ptr<Mesh>(new Mesh(std::move(meshData[i].vertices),
+                                std::move(meshData[i].indices), std::move(meshTextures), drawType, retention, useArena)));
+            }
+            if (packTextures) packMaterials(materials, firstMesh);
+        }
+
+        /**
+         * ******************************************************
+         * Load the meshes from the binary mesh cache
+         *
+         * @param[in] path          - model file path
+         * @param[in] cache         - opened mesh cache
+         * @param[in] drawType
+         * ******************************************************
+        **/
+        void loadCache(std::string path, MeshCache & cache, uint32_t drawType)
+        {
+            directory = path.substr(0, path.find_last_of('/'));
+
+            size_t firstMesh = meshes.size();
+            std::vector<std::vector<MeshTextureRef>> materials;
+            for (uint32_t i = 0; i < cache.getMeshCount(); i++) {
+                std::vector<MeshTextureRef> textureRefs;
+                cache.getTextures(i, textureRefs);
+
+                std::vector<Texture*> meshTextures;
+                if (packTextures) {
+                    materials.push_back(textureRefs);
+                } else {
+                    for (uint32_t t = 0; t < textureRefs.size(); t++) {
+                        meshTextures.push_back(getTexture(textureRefs[t].name, (aiTextureType)textureRefs[t].type));
+                    }
+                }
+
+                meshes.push_back(std::unique_ptr<Mesh>(new Mesh(
+                                cache.getVertices(i), cache.getVertexCount(i),
+                                cache.getIndices(i), cache.getIndexCount(i),
+                                meshTextures, drawType, retention, useArena)));
+            }
+            if (packTextures) packMaterials(materials, firstMesh);
+        }
+
+        /**
+         * ******************************************************
+         * Pack the material textures into texture arrays and give
+         * the meshes their layers. The first texture of a type
+         * wins, as diffuse1 does in the shader.
+         *
+         * @param[in] materials     - texture references per mesh
+         * @param[in] firstMesh     - mesh of materials[0]
+         * ******************************************************
+        **/
+        void packMaterials(const std::vector<std::vector<MeshTextureRef>> & materials, size_t firstMesh)
+        {
+            for (size_t i = 0; i < materials.size(); i++) {
+                for (size_t t = 0; t < materials[i].size(); t++) {
+                    int32_t slot = materialSlot(getTypeName((aiTextureType)materials[i][t].type));
+                    if (slot >= 0) packer.add(directory + '/' + materials[i][t].name, slot == 0);
+                }
+            }
+            packer.pack();
+
+            for (size_t i = 0; i < materials.size(); i++) {
+                MaterialLayers layers;
+                memset(&layers, 0, sizeof(layers));
+                for (size_t t = 0; t < materials[i].size(); t++) {
+                    int32_t slot = materialSlot(getTypeName((aiTextureType)materials[i][t].type));
+                    if (slot < 0 || layers.arrays[slot] != NULL) continue;
+
+                    uint32_t layer = 0;
+                    if (packer.get(directory + '/' + materials[i][t].name, layers.arrays[slot], layer)) {
+                        layers.layers[slot] = layer;
+                    }
+                }
+                meshes[firstMesh + i]->setMaterialLayers(layers);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Process Node
+         *
+         * Collects the node meshes depth first, in the order
+         * they will be drawn.
+         *
+         * @param[in]  node
+         * @param[in]  scene
+         * @param[out] aiMeshes     - the meshes of the node tree
+         * ******************************************************
+        **/
+        void processNode(aiNode *node, const aiScene *scene, std::vector<const aiMesh*> & aiMeshes)
+        {
+            // process all the node's meshes (if any)
+            for(unsigned int i = 0; i < node->mNumMeshes; i++)
+            {
+                aiMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+            }
+            // then do the same for each of its children
+            for(unsigned int i = 0; i < node->mNumChildren; i++)
+            {
+                processNode(node->mChildren[i], scene, aiMeshes);
+            }
         }
 
+
         /**
          * ******************************************************
          * Get the texture type name
@@ -253,12 +520,16 @@ class Model
 
         /**
          * ******************************************************
-         * TODO Doc This
+         * Collect the textures of a material. The textures are
+         * loaded later, on the context thread, by getTexture.
+         *
+         * @param[out] textureRefs  - texture references
+         * @param[in]  mat          - the material
+         * @param[in]  type         - texture type to collect
          * ******************************************************
         **/
-        void loadMaterialTextures(std::unordered_map<std::string, Texture*> & loadedTextures,
-                std::vector<Texture*> & meshTextures,
-                aiMaterial *mat, aiTextureType type)
+        static void loadMaterialTextures(std::vector<MeshTextureRef> & textureRefs,
+                const aiMaterial *mat, aiTextureType type)
         {
             unsigned int i = 0;
             for( i= 0; i < mat->GetTextureCount(type); i++)
@@ -266,31 +537,49 @@ class Model
                 aiString str;
                 mat->GetTexture(type, i, &str);
 
-                std::string name = std::string(str.C_Str());
-                std::string path = directory + '/' + name; 
+                MeshTextureRef ref;
+                ref.type = type;
+                ref.name = std::string(str.C_Str());
+                textureRefs.push_back(ref);
+            }
+        }
 
-                /* Check if the texture was ever loaded */
-                if (loadedTextures.find(path) == loadedTextures.end()) {
-                    Texture *texture = new Texture(path.c_str(), GL_RGB, getTypeName(type));
-                    //TODO this can be done better than indexing with 100 character strings.
-                    if (texture == NULL) {
-                        LOG(L_CRIT, "Missing texture: %s", path.c_str());
-                        exit(1);
-                    }
-                    loadedTextures.insert(std::pair<std::string, Texture*>(path.c_str(), texture));
-                }
+        /**
+         * ******************************************************
+         * Get a texture from the TextureManager, one reference
+         * per path and model
+         *
+         * @param[in] name          - texture path relative to the model
+         * @param[in] type          - texture type
+         * ******************************************************
+        **/
+        Texture* getTexture(const std::string & name, aiTextureType type)
+        {
+            std::string path = directory + '/' + name; 
 
-                /* Create the mesh texture here */
-                meshTextures.push_back(loadedTextures[path]);
+            /* Check if the texture was ever loaded */
+            if (loadedTextures.find(path) == loadedTextures.end()) {
+                Texture *texture = TextureManager::get().acquire(path, getTypeName(type), true /* async */);
+                //TODO this can be done better than indexing with 100 character strings.
+                loadedTextures.insert(std::pair<std::string, Texture*>(path.c_str(), texture));
             }
+
+            return loadedTextures[path];
         }
 
 
     private: /* Members */
         /*  Model Data  */
         std::vector<std::unique_ptr<Mesh>> meshes;
+        std::string path;
         std::string directory;
-        std::unordered_map<std::string, Texture*> loadedTextures; //TODO consider a shared_ptr here
+        BufferRetention retention;
+        bool optimize;          /* Run the MeshOptimizer on imports */
+        bool packTextures;      /* Material textures in texture arrays */
+        bool useArena;          /* Meshes in the MeshArena */
+        TextureArrayPacker packer; /* Owns the arrays when packing */
+        std::unordered_map<std::string, Texture*> loadedTextures; /* Held references, by path */
+        RenderQueue queue;      /* Reused by every draw */
 };
 
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -298,131 +587,309 @@ class Model
 
 /**
  * ******************************************************
- * Model loader using tinyobjloader TODO doesn't work atm
+ * Model loader using tinyobjloader
+ *
+ * One mesh per shape and material. The (v, vn, vt) index
+ * triplets are welded, so a vertex shared by faces is
+ * stored once, and textures are shared between meshes
+ * and models through the TextureManager.
  * ******************************************************
 **/
 class TinyObjModel {
     public: /* Constructors */
         /**
          * ******************************************************
-         * TODO DOCTHIS
+         * TinyObjModel constructor
+         *
+         * @param[in] path          - obj file path, the mtl and
+         *                            textures are looked up next to it
+         * @param[in] drawType      - buffer usage for the meshes
+         * @param[in] retention     - CPU copy policy for the meshes
+         * @param[in] useArena      - place the meshes in the MeshArena
          * ******************************************************
         **/
-        TinyObjModel() {
-            loadModel();
+        TinyObjModel(const std::string & path, uint32_t drawType = GL_STATIC_DRAW,
+                BufferRetention retention = BR_DISCARD, bool useArena = false) :
+            path(path), retention(retention), useArena(useArena), vertexCount(0), cornerCount(0),
+            textureLoads(0), textureRefs(0)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+            loadModel(drawType);
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            LOG(L_INFO, "Loaded model %s in %.2f ms (tinyobjloader).", path.c_str(), elapsed.count());
         }
-    private: /* Methods */
 
+        ~TinyObjModel()
+        {
+            meshes.clear();
+            for (auto it = loadedTextures.begin(); it != loadedTextures.end(); ++it) {
+                TextureManager::get().release(it->second);
+            }
+        }
+
+    private: /* Types */
+        /* A face corner, the key vertices are welded by */
+        struct IndexKey {
+            int vertex;
+            int normal;
+            int texcoord;
+
+            bool operator==(const IndexKey & other) const
+            {
+                return vertex == other.vertex && normal == other.normal && texcoord == other.texcoord;
+            }
+        };
+
+        struct IndexKeyHash {
+            size_t operator()(const IndexKey & key) const
+            {
+                uint64_t hash = (uint32_t)key.vertex * 0x9E3779B97F4A7C15ULL;
+                hash ^= (uint32_t)key.normal * 0xC2B2AE3D27D4EB4FULL;
+                hash ^= (uint32_t)key.texcoord * 0x165667B19E3779F9ULL;
+                return (size_t)(hash ^ (hash >> 32));
+            }
+        };
+
+    private: /* Methods */
         /**
          * ******************************************************
-         * TODO DOC THIS
+         * Load Model
+         *
+         * @param[in] drawType
          * ******************************************************
         **/
-        void loadModel() {
-            //std::string MODEL_PATH = "/store/Code/cpp/learnopengl/models/star_cruiser/scene.gltf";
-            std::string MODEL_PATH ="/store/Code/cpp/learnopengl/models/nanosuit.obj"; 
-            std::string MATERIAL_BASE_DIR ="/store/Code/cpp/learnopengl/models/"; 
-			if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, 
-                        MODEL_PATH.c_str(), MATERIAL_BASE_DIR.c_str())) {
-                LOG(L_CRIT, "Error Loading model: %s", MODEL_PATH.c_str());
-                exit(1);
-			}
-            LOG(L_CRIT, "TOL ERROR: %s.", err.c_str());
-
-            std::vector<float> data; // TODO TEMP rm this
-            for (const auto& shape : shapes) {
-                for (const auto& index : shape.mesh.indices) {
-                    Vertex vertex = {};
-                    vertex.pos_ = {
-                        attrib.vertices[3 * index.vertex_index + 0],
-                        attrib.vertices[3 * index.vertex_index + 1],
-                        attrib.vertices[3 * index.vertex_index + 2]
-                    };
-
-                    vertex.texCoords_ = {
-                        attrib.texcoords[2 * index.texcoord_index + 0],
-                        attrib.texcoords[2 * index.texcoord_index + 1]
-                    };
+        void loadModel(uint32_t drawType)
+        {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string err;
+
+            directory = path.substr(0, path.find_last_of('/') + 1);
+            if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, path.c_str(), directory.c_str())) {
+                LOG(L_ERR, "Error loading model %s: %s", path.c_str(), err.c_str());
+                return;
+            }
+            if (!err.empty()) {
+                LOG(L_DBG, "tinyobjloader: %s", err.c_str());
+            }
 
-                    vertex.normal_ = {1.0f, 1.0f, 1.0f};
+            /* Textures per material, loaded once however many shapes use them */
+            std::vector<std::vector<Texture*>> materialTextures(materials.size());
+            for (uint32_t m = 0; m < materials.size(); m++) {
+                loadMaterialTextures(materialTextures[m], materials[m]);
+            }
 
-                    vertex.texCoords_ = {
-                        attrib.texcoords[2 * index.texcoord_index + 0],
-                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                    };
+            /* Faces by material + 1, the faces without a material first */
+            std::vector<std::vector<size_t>> materialFaces(materials.size() + 1);
+            std::unordered_map<IndexKey, unsigned int, IndexKeyHash> welded;
+            for (const auto& shape : shapes) {
+                const std::vector<tinyobj::index_t> & corners = shape.mesh.indices;
+                const std::vector<int> & faceMaterials = shape.mesh.material_ids;
+
+                /* Faces are triangulated by LoadObj; split them by material in one pass */
+                for (uint32_t m = 0; m < materialFaces.size(); m++) materialFaces[m].clear();
+                for (size_t f = 0; f < corners.size() / 3; f++) {
+                    int faceMaterial = f < faceMaterials.size() ? faceMaterials[f] : -1;
+                    if (faceMaterial < 0 || (size_t)faceMaterial >= materials.size()) faceMaterial = -1;
+                    materialFaces[faceMaterial + 1].push_back(f);
+                }
 
-                    vertices.push_back(vertex);
-                    indices.push_back(indices.size());
+                for (uint32_t sm = 0; sm < materialFaces.size(); sm++) {
+                    const std::vector<size_t> & faces = materialFaces[sm];
+                    if (faces.empty()) continue;
+
+                    int material = (int)sm - 1;
+                    std::vector<Vertex> vertices;
+                    std::vector<unsigned int> indices;
+                    indices.reserve(faces.size() * 3);
+                    welded.clear();
+
+                    for (size_t f : faces) {
+                        for (size_t c = 3 * f; c < 3 * f + 3; c++) {
+                            const tinyobj::index_t & index = corners[c];
+                            IndexKey key = { index.vertex_index, index.normal_index, index.texcoord_index };
+
+                            auto found = welded.find(key);
+                            if (found != welded.end()) {
+                                indices.push_back(found->second);
+                                continue;
+                            }
+
+                            unsigned int next = vertices.size();
+                            welded.insert(std::make_pair(key, next));
+                            vertices.push_back(makeVertex(attrib, index));
+                            indices.push_back(next);
+                        }
+                    }
 
-                }
+                    std::vector<Texture*> meshTextures;
+                    if (material >= 0) {
+                        meshTextures = materialTextures[material];
+                    }
 
-                LOG(L_DBG, "Shape: %s", shape.name.c_str());
-                for(uint32_t m=0; m<shape.mesh.material_ids.size(); m++) {
-                    LOG(L_DBG, "Shape Material: %s", materials[m].name.c_str());
+                    LOG(L_DBG, "Shape %s, material %d: %lu vertices, %lu indices.", shape.name.c_str(), material,
+                            (unsigned long)vertices.size(), (unsigned long)indices.size());
+                    cornerCount += indices.size();
+                    vertexCount += vertices.size();
+                    meshes.push_back(std::unique_ptr<Mesh>(new Mesh(std::move(vertices), std::move(indices),
+                                    std::move(meshTextures), drawType, retention, useArena)));
                 }
+            }
 
-                std::string fullTexPath;
-                Texture * texture = NULL;
-                //for (uint32_t i=0; i<shap.mesh.material_ids.size() - 1; i++) {
-                for (uint32_t i=0; i<materials.size(); i++) {
-                    //if (materials[i].name.empty()) continue;
-                    LOG(L_DBG, "Material: %s", materials[i].name.c_str());
-                    LOG(L_DBG, "Material Texture file: %s", materials[i].diffuse_texname.c_str());
-
-                    /* Diffuse */
-                    if (!materials[i].diffuse_texname.empty()) {
-                        fullTexPath = MATERIAL_BASE_DIR + materials[i].diffuse_texname;
-                        texture = new Texture(fullTexPath.c_str(), GL_RGB, "texture_diffuse");
-                        meshTextures.push_back(texture);
-                    }
+            LOG(L_INFO, "Imported %lu meshes, %lu vertices for %lu corners, %lu textures loaded for %lu references.",
+                    (unsigned long)meshes.size(), (unsigned long)vertexCount, (unsigned long)cornerCount,
+                    (unsigned long)textureLoads, (unsigned long)textureRefs);
+        }
 
-                    /* Specular */
-                    if (!materials[i].specular_texname.empty()) {
-                        fullTexPath = MATERIAL_BASE_DIR + materials[i].specular_texname;
-                        texture = new Texture(fullTexPath.c_str(), GL_RGB, "texture_specular");
-                        meshTextures.push_back(texture);
-                    }
+        /**
+         * ******************************************************
+         * Build the vertex of a face corner. Missing normals and
+         * texture coordinates are zero, as in Model.
+         * ******************************************************
+        **/
+        static Vertex makeVertex(const tinyobj::attrib_t & attrib, const tinyobj::index_t & index)
+        {
+            Vertex vertex = {};
+            vertex.pos_ = glm::vec3(
+                    attrib.vertices[3 * index.vertex_index + 0],
+                    attrib.vertices[3 * index.vertex_index + 1],
+                    attrib.vertices[3 * index.vertex_index + 2]);
+
+            if (index.normal_index >= 0) {
+                vertex.normal_ = glm::vec3(
+                        attrib.normals[3 * index.normal_index + 0],
+                        attrib.normals[3 * index.normal_index + 1],
+                        attrib.normals[3 * index.normal_index + 2]);
+            } else {
+                vertex.normal_ = glm::vec3(0.0f, 0.0f, 0.0f);
+            }
 
-                    /* Normal */
-                    if (!materials[i].normal_texname.empty()) {
-                        fullTexPath = MATERIAL_BASE_DIR + materials[i].normal_texname;
-                        texture = new Texture(fullTexPath.c_str(), GL_RGB, "texture_normal");
-                        meshTextures.push_back(texture);
-                    }
+            if (index.texcoord_index >= 0) {
+                /* Flipped, same as aiProcess_FlipUVs */
+                vertex.texCoords_ = glm::vec2(
+                        attrib.texcoords[2 * index.texcoord_index + 0],
+                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]);
+            } else {
+                vertex.texCoords_ = glm::vec2(0.0f, 0.0f);
+            }
+            return vertex;
+        }
 
-                    //[> Height <] //TODO HEIGHT VS BUMP
-                    if (!materials[i].bump_texname.empty()) {
-                        fullTexPath = MATERIAL_BASE_DIR + materials[i].bump_texname;
-                        texture = new Texture(fullTexPath.c_str(), GL_RGB, "texture_height");
-                        meshTextures.push_back(texture);
-                    }
+        /**
+         * ******************************************************
+         * Collect the textures of a material, in the order Model
+         * uses: diffuse, specular, normals, height.
+         *
+         * @param[out] textures
+         * @param[in]  material
+         * ******************************************************
+        **/
+        void loadMaterialTextures(std::vector<Texture*> & textures, const tinyobj::material_t & material)
+        {
+            static const struct {
+                std::string tinyobj::material_t::*  name;
+                const char*                         type;
+            } slots[] = {
+                { &tinyobj::material_t::diffuse_texname,    "diffuse" },
+                { &tinyobj::material_t::specular_texname,   "specular" },
+                { &tinyobj::material_t::normal_texname,     "normals" },
+                { &tinyobj::material_t::bump_texname,       "height" },
+            };
 
-                }
-                meshes.push_back(std::unique_ptr<Mesh>(new Mesh(vertices, indices, meshTextures, GL_STATIC_DRAW, data)));            
+            for (uint32_t i = 0; i < sizeof(slots) / sizeof(slots[0]); i++) {
+                const std::string & name = material.*(slots[i].name);
+                if (name.empty()) continue;
+                textures.push_back(getTexture(name, slots[i].type));
             }
         }
+
+        /**
+         * ******************************************************
+         * Get a texture from the TextureManager, one reference
+         * per path and model
+         *
+         * @param[in] name          - texture path relative to the model
+         * @param[in] type          - texture type
+         * ******************************************************
+        **/
+        Texture* getTexture(const std::string & name, const char* type)
+        {
+            std::string texturePath = directory + name;
+            textureRefs++;
+
+            auto found = loadedTextures.find(texturePath);
+            if (found != loadedTextures.end()) return found->second;
+
+            Texture *texture = TextureManager::get().acquire(texturePath, type, true /* async */);
+            loadedTextures.insert(std::make_pair(texturePath, texture));
+            textureLoads++;
+            return texture;
+        }
+
     public: /* Methods */
+        /**
+         * ******************************************************
+         * Draw the meshes through the render queue
+         *
+         * @param[in] program
+         * ******************************************************
+        **/
+        void draw(Program & program)
+        {
+            for (uint32_t i = 0; i < meshes.size(); i++) {
+                queue.push(program, meshes[i].get());
+            }
+            queue.submit();
+        }
 
         /**
          * ******************************************************
-         * TODO DOC THIS
+         * Draw every instance of a buffer, one instanced draw per
+         * mesh, through the render queue. Needs a program built
+         * with INSTANCED.
+         *
+         * @param[in] program
+         * @param[in] instances
          * ******************************************************
         **/
-        void draw(Program & program) {
-            for (uint32_t i = 0; i< meshes.size(); i++) {
-                meshes[i].get()->draw(program);
+        void drawInstanced(Program & program, InstanceBuffer & instances)
+        {
+            if (instances.getCount() == 0) return;
+            for (uint32_t i = 0; i < meshes.size(); i++) {
+                meshes[i]->setInstanceBuffer(instances);
+                queue.push(program, meshes[i].get(), 0.0f, instances.getCount());
             }
+            queue.submit();
         }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        size_t getMeshCount() { return meshes.size(); }
+        size_t getVertexCount() { return vertexCount; }
+        size_t getCornerCount() { return cornerCount; }
+        size_t getTextureLoads() { return textureLoads; }
+        size_t getTextureRefs() { return textureRefs; }
+        const RenderQueueStats& getRenderStats() { return queue.getStats(); }
+        void resetRenderStats() { queue.resetStats(); }
+
     private: /* Members */
-			tinyobj::attrib_t attrib;
-			std::vector<tinyobj::shape_t> shapes;
-			std::vector<tinyobj::material_t> materials;
-			std::string err;
-            std::vector<Vertex> vertices;
-            std::vector<uint32_t> indices;
-            std::vector<std::unique_ptr<Mesh>> meshes;
-            std::vector<Texture*> meshTextures;
+        std::vector<std::unique_ptr<Mesh>> meshes;
+        std::string path;
+        std::string directory;      /* With the trailing '/' */
+        BufferRetention retention;
+        bool useArena;              /* Meshes in the MeshArena */
+        std::unordered_map<std::string, Texture*> loadedTextures;
+        size_t vertexCount;         /* Welded vertices of all the meshes */
+        size_t cornerCount;         /* Face corners, the vertices without welding */
+        size_t textureLoads;        /* Textures acquired, one per path */
+        size_t textureRefs;         /* Textures asked for by the materials */
+        RenderQueue queue;          /* Reused by every draw */
 };
 
-
 #endif
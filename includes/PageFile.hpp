@@ -0,0 +1,281 @@
+/******************************************
+
+* File Name : includes/PageFile.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Page file of a virtual texture: the mip chain of one large image,
+ * cut into fixed size RGBA tiles. tools/vttiler writes these and
+ * VirtualTexture streams the tiles the camera needs into its cache.
+ * No GL in here.
+ *
+ * The virtual texture is square, a power of two number of tiles per
+ * side at level 0 and one tile at the last level, so every level
+ * halves the tiles of the one above and the indirection is a plain
+ * mip chain. The image sits at the origin; the rest is padded with
+ * its edge texels and never sampled.
+ *
+ * Every tile carries a border of texels from its neighbours, so the
+ * cache can filter bilinear across tile edges. The rows are bottom
+ * up, like the images Texture uploads.
+ *
+ * Layout: | PageFileHeader | tile 0 | tile 1 | ... |
+ * Level 0 first, row major within a level. The tiles are all the
+ * same size, their offset is computed, not stored.
+ */
+
+#ifndef _LOGL_PAGE_FILE_HPP_
+#define _LOGL_PAGE_FILE_HPP_
+
+/* STD */
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+/* POSIX */
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Utils.hpp"
+
+#define PAGE_FILE_MAGIC     0x3150544c  /* "LTP1" */
+#define PAGE_FILE_VERSION   1
+#define PAGE_FILE_EXT       ".vtp"
+
+#define VT_TILE_SIZE        128     /* Texels per tile side, without the border */
+#define VT_TILE_BORDER      4       /* Texels borrowed from each neighbour */
+
+/**
+ * ******************************************************
+ * On disk header
+ * ******************************************************
+**/
+struct PageFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;         /* Of the image */
+    uint32_t height;
+    uint32_t tileSize;      /* Texels, without the border */
+    uint32_t border;
+    uint32_t levels;        /* The last one is a single tile */
+    uint32_t tileCount;     /* Over all levels */
+};
+
+/**
+ * ******************************************************
+ * @brief Reads and writes page files
+ *
+ * readTile() and writeTile() use pread/pwrite, any number
+ * of threads can call them on the same PageFile.
+ * ******************************************************
+**/
+class PageFile {
+    public: /* Constructors */
+        PageFile() :
+            fd_(-1)
+        {
+            memset(&header_, 0, sizeof(header_));
+        }
+
+        ~PageFile()
+        {
+            close();
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Create a page file, sized for all of its tiles
+         *
+         * @param[in] path
+         * @param[in] width         - of the image
+         * @param[in] height
+         * @param[in] tileSize
+         * @param[in] border
+         *
+         * @return false if the file could not be created
+         * ******************************************************
+        **/
+        bool create(const char* path, uint32_t width, uint32_t height,
+                uint32_t tileSize = VT_TILE_SIZE, uint32_t border = VT_TILE_BORDER)
+        {
+            close();
+            header_.magic       = PAGE_FILE_MAGIC;
+            header_.version     = PAGE_FILE_VERSION;
+            header_.width       = width;
+            header_.height      = height;
+            header_.tileSize    = tileSize;
+            header_.border      = border;
+            layout(header_);
+
+            fd_ = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd_ < 0) {
+                LOG(L_ERR, "Could not create %s, error: %s", path, strerror(errno));
+                return false;
+            }
+            if (pwrite(fd_, &header_, sizeof(header_), 0) != (ssize_t)sizeof(header_) ||
+                    ftruncate(fd_, getTileOffset(header_.tileCount)) != 0) {
+                LOG(L_ERR, "Could not write %s, error: %s", path, strerror(errno));
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Open a page file for reading
+         *
+         * @return false if missing, not a page file, or its level
+         *         and tile counts don't follow from its size
+         * ******************************************************
+        **/
+        bool open(const char* path)
+        {
+            close();
+            fd_ = ::open(path, O_RDONLY);
+            if (fd_ < 0) {
+                LOG(L_ERR, "Could not open %s, error: %s", path, strerror(errno));
+                return false;
+            }
+
+            struct stat fileStat;
+            if (pread(fd_, &header_, sizeof(header_), 0) != (ssize_t)sizeof(header_) ||
+                    header_.magic != PAGE_FILE_MAGIC || header_.version != PAGE_FILE_VERSION ||
+                    header_.tileSize == 0 || header_.levels == 0 || header_.levels > 16 ||
+                    fstat(fd_, &fileStat) != 0 || (uint64_t)fileStat.st_size < getTileOffset(header_.tileCount)) {
+                LOG(L_ERR, "%s is not a page file, or it is truncated.", path);
+                close();
+                return false;
+            }
+
+            /* Tile addressing trusts levels and tileCount, they must be the ones create() writes */
+            PageFileHeader expected = header_;
+            layout(expected);
+            if (expected.levels != header_.levels || expected.tileCount != header_.tileCount) {
+                LOG(L_ERR, "%s: %u levels and %u tiles, a %ux%u image in %u texel tiles has %u and %u.", path,
+                        header_.levels, header_.tileCount, header_.width, header_.height, header_.tileSize,
+                        expected.levels, expected.tileCount);
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close()
+        {
+            if (fd_ >= 0) ::close(fd_);
+            fd_ = -1;
+        }
+
+        /**
+         * ******************************************************
+         * Read a tile
+         *
+         * @param[in] tile          - from getTileIndex()
+         * @param[out] rgba         - getPageBytes() bytes
+         * ******************************************************
+        **/
+        bool readTile(uint32_t tile, uint8_t* rgba)
+        {
+            if (tile >= header_.tileCount) return false;
+            return pread(fd_, rgba, getPageBytes(), getTileOffset(tile)) == (ssize_t)getPageBytes();
+        }
+
+        /**
+         * ******************************************************
+         * Write a tile
+         *
+         * @param[in] tile          - from getTileIndex()
+         * @param[in] rgba          - getPageBytes() bytes, border included
+         * ******************************************************
+        **/
+        bool writeTile(uint32_t tile, const uint8_t* rgba)
+        {
+            if (tile >= header_.tileCount) return false;
+            return pwrite(fd_, rgba, getPageBytes(), getTileOffset(tile)) == (ssize_t)getPageBytes();
+        }
+
+        /**
+         * ******************************************************
+         * Tile addressing
+         * ******************************************************
+        **/
+        uint32_t getTilesPerSide(uint32_t level) { return 1u << (header_.levels - 1 - level); }
+
+        uint32_t getTileIndex(uint32_t level, uint32_t x, uint32_t y)
+        {
+            uint32_t first = 0;
+            for (uint32_t l = 0; l < level; l++) first += getTilesPerSide(l) * getTilesPerSide(l);
+            return first + y * getTilesPerSide(level) + x;
+        }
+
+        /* Inverse of getTileIndex() */
+        void getTileCoords(uint32_t tile, uint32_t& level, uint32_t& x, uint32_t& y)
+        {
+            level = 0;
+            while (tile >= getTilesPerSide(level) * getTilesPerSide(level)) {
+                tile -= getTilesPerSide(level) * getTilesPerSide(level);
+                level++;
+            }
+            x = tile % getTilesPerSide(level);
+            y = tile / getTilesPerSide(level);
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        bool isOpen() { return fd_ >= 0; }
+        uint32_t getWidth() { return header_.width; }
+        uint32_t getHeight() { return header_.height; }
+        uint32_t getTileSize() { return header_.tileSize; }
+        uint32_t getBorder() { return header_.border; }
+        uint32_t getLevelCount() { return header_.levels; }
+        uint32_t getTileCount() { return header_.tileCount; }
+
+        /* Texels per side of level 0, padding included */
+        uint32_t getVirtualSize() { return header_.tileSize << (header_.levels - 1); }
+
+        /* A tile with its border */
+        uint32_t getPageSize() { return header_.tileSize + 2 * header_.border; }
+        size_t getPageBytes() { return (size_t)getPageSize() * getPageSize() * 4; }
+
+    private: /* Methods */
+        uint64_t getTileOffset(uint32_t tile) { return sizeof(PageFileHeader) + (uint64_t)tile * getPageBytes(); }
+
+        /* Levels down to a single tile, and the tiles over all of them, from the size */
+        static void layout(PageFileHeader & header)
+        {
+            uint32_t side = header.width > header.height ? header.width : header.height;
+            header.levels = 1;
+            while (((uint64_t)header.tileSize << (header.levels - 1)) < side) header.levels++;
+            header.tileCount = 0;
+            for (uint32_t level = 0; level < header.levels; level++) {
+                /* 64 bits, a corrupt header can ask for more than 32 levels */
+                uint64_t tiles = 1ull << (header.levels - 1 - level);
+                header.tileCount += (uint32_t)(tiles * tiles);
+            }
+        }
+
+    private: /* Members */
+        int             fd_;        /* -1 if closed */
+        PageFileHeader  header_;
+};
+
+#endif
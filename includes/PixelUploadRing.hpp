@@ -0,0 +1,250 @@
+/******************************************
+
+* File Name : includes/PixelUploadRing.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Streams texture uploads through a ring of pixel unpack buffers.
+ * The pixels are copied into a slot and glTexSubImage2D reads them
+ * from there, so the call returns without waiting for the transfer.
+ * Each slot gets a fence; a slot is only written again once the GPU
+ * is done reading it.
+ *
+ * With GL 4.4 / ARB_buffer_storage the slots are mapped once,
+ * persistent and coherent. Otherwise each use maps the slot
+ * unsynchronized, the fence already did the syncing. A band whose
+ * slot can't be mapped is uploaded straight from client memory.
+ */
+
+#ifndef _LOGL_PIXEL_UPLOAD_RING_HPP_
+#define _LOGL_PIXEL_UPLOAD_RING_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* STD */
+#include <vector>
+#include <chrono>
+#include <stdint.h>
+#include <string.h>
+
+#include "Utils.hpp"
+
+#define PUR_SLOT_COUNT      3
+#define PUR_SLOT_SIZE       (16 << 20)      /* A 2K RGBA level, a 4K one goes in 4 bands */
+#define PUR_WAIT_TIMEOUT    1000000000ULL   /* ns, a fence that takes longer is lost */
+
+/**
+ * ******************************************************
+ * Staging counters, reset once per frame
+ * ******************************************************
+**/
+struct PixelUploadStats {
+    uint64_t uploads;       /* glTexSubImage2D calls */
+    uint64_t bytes;         /* Bytes staged */
+    uint64_t stalls;        /* Slots still read by the GPU when needed */
+    double   stallMs;       /* Time waited on those */
+    uint64_t unmapped;      /* Bands uploaded from client memory, the map failed */
+};
+
+/**
+ * ******************************************************
+ * @brief Pixel unpack buffer ring
+ * ******************************************************
+**/
+class PixelUploadRing {
+    public: /* Constructors */
+        /**
+         * ******************************************************
+         * Constructor. The buffers are created on first use, on
+         * the context thread.
+         *
+         * @param[in] slotSize      - bytes per slot
+         * @param[in] slotCount     - slots in the ring
+         * ******************************************************
+        **/
+        PixelUploadRing(size_t slotSize = PUR_SLOT_SIZE, uint32_t slotCount = PUR_SLOT_COUNT) :
+            slotSize_(slotSize), next_(0), enabled_(true), persistent_(false)
+        {
+            slots_.resize(slotCount);
+            resetStats();
+        }
+
+        ~PixelUploadRing()
+        {
+            /* The context is gone by the time the static ring dies, nothing to release */
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * The ring of the (only) context
+         * ******************************************************
+        **/
+        static PixelUploadRing& get()
+        {
+            static PixelUploadRing ring;
+            return ring;
+        }
+
+        /**
+         * ******************************************************
+         * Upload a level, or a rectangle of it, of the GL_TEXTURE_2D
+         * bound on the active unit, in bands of rows that fit a
+         * slot. The level must already have storage.
+         *
+         * @param[in] level
+         * @param[in] width
+         * @param[in] height
+         * @param[in] format        - GL_RED, GL_RG, GL_RGB or GL_RGBA
+         * @param[in] pixelSize     - bytes per pixel
+         * @param[in] pixels        - tightly packed rows
+         * @param[in] xOffset       - of the rectangle in the level
+         * @param[in] yOffset
+         *
+         * @return false if a row doesn't fit a slot, nothing was uploaded
+         * ******************************************************
+        **/
+        bool upload(int level, int width, int height, uint32_t format,
+                uint32_t pixelSize, const uint8_t* pixels, int xOffset = 0, int yOffset = 0)
+        {
+            size_t rowSize = (size_t)width * pixelSize;
+            size_t bandRows = slotSize_ / rowSize;
+            if (rowSize == 0 || bandRows == 0) return false;
+            if (slots_[0].buffer == 0) create();
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (int y = 0; y < height; y += bandRows) {
+                int rows = height - y < (int)bandRows ? height - y : (int)bandRows;
+                size_t size = rows * rowSize;
+
+                Slot & slot = acquire();
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+                if (slot.mapped != NULL) {
+                    memcpy(slot.mapped, pixels + y * rowSize, size);
+                } else {
+                    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+                    if (dst == NULL) {
+                        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                        glTexSubImage2D(GL_TEXTURE_2D, level, xOffset, yOffset + y, width, rows, format,
+                                GL_UNSIGNED_BYTE, pixels + y * rowSize);
+                        stats_.uploads++;
+                        stats_.unmapped++;
+                        continue;
+                    }
+                    memcpy(dst, pixels + y * rowSize, size);
+                    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                }
+
+                /* Reads from the bound unpack buffer, offset 0 */
+                glTexSubImage2D(GL_TEXTURE_2D, level, xOffset, yOffset + y, width, rows, format, GL_UNSIGNED_BYTE, (void*)0);
+                slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+                stats_.uploads++;
+                stats_.bytes += size;
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Switch the ring off, Texture uploads straight from
+         * client memory again. For comparing the frame times.
+         * ******************************************************
+        **/
+        void setEnabled(bool enabled) { enabled_ = enabled; }
+        bool isEnabled() { return enabled_; }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        bool isPersistent() { return persistent_; }
+        const PixelUploadStats& getStats() { return stats_; }
+        void resetStats() { memset(&stats_, 0, sizeof(stats_)); }
+
+    private: /* Types */
+        struct Slot {
+            Slot() : buffer(0), mapped(NULL), fence(0) {}
+
+            uint32_t    buffer;     /* Unpack buffer */
+            uint8_t     *mapped;    /* Persistent mapping, NULL: mapped per upload */
+            GLsync      fence;      /* Signaled once the GPU read the slot */
+        };
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Create and, if possible, persistently map the slots
+         * ******************************************************
+        **/
+        void create()
+        {
+            persistent_ = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+            for (size_t i = 0; i < slots_.size(); i++) {
+                Slot & slot = slots_[i];
+                glGenBuffers(1, &slot.buffer);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+                if (persistent_) {
+                    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slotSize_, NULL, flags);
+                    slot.mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotSize_, flags);
+                    if (slot.mapped == NULL) LOG(L_ERR, "Pixel upload slot %lu isn't mapped, mapping it per upload.", (unsigned long)i);
+                } else {
+                    glBufferData(GL_PIXEL_UNPACK_BUFFER, slotSize_, NULL, GL_STREAM_DRAW);
+                }
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            LOG(L_INFO, "Pixel upload ring: %lu slots of %lu KiB, %s.", (unsigned long)slots_.size(),
+                    (unsigned long)(slotSize_ / 1024), persistent_ ? "persistently mapped" : "mapped per upload");
+        }
+
+        /**
+         * ******************************************************
+         * The next slot, once the GPU is done with it
+         * ******************************************************
+        **/
+        Slot& acquire()
+        {
+            Slot & slot = slots_[next_];
+            next_ = (next_ + 1) % slots_.size();
+            if (slot.fence == 0) return slot;
+
+            if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+                /* The ring is outrun; only happens when a frame uploads more than it holds */
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, PUR_WAIT_TIMEOUT);
+                std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - start;
+                stats_.stalls++;
+                stats_.stallMs += waited.count();
+            }
+            glDeleteSync(slot.fence);
+            slot.fence = 0;
+            return slot;
+        }
+
+    private: /* Members */
+        size_t              slotSize_;      /* Bytes per slot */
+        std::vector<Slot>   slots_;         /* The ring */
+        size_t              next_;          /* Next slot to write */
+        bool                enabled_;       /* Used by Texture uploads */
+        bool                persistent_;    /* Slots mapped once */
+        PixelUploadStats    stats_;         /* Per frame counters */
+};
+
+#endif
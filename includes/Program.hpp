@@ -22,7 +22,29 @@
 /* Glew */
 #include <GL/glew.h>
 
+/* STD */
+#include <vector>
+#include <string>
+#include <string.h>
+
 #include <Shader.hpp>
+#include "GLState.hpp"
+
+/**
+ * ******************************************************
+ * @brief Resolved uniform
+ *
+ * Returned by Program::getUniform. Resolve once, outside
+ * of the render loop, then set through the handle without
+ * any name lookup.
+ * ******************************************************
+**/
+struct UniformHandle {
+    int32_t slot;       /* Index in the program uniform table, -1 if not active */
+    int32_t location;   /* GL location, -1 if not active */
+
+    bool valid() const { return location >= 0; }
+};
 
 /**
  * ******************************************************
@@ -41,7 +63,8 @@ class Program {
          * @param fragment id
          * ******************************************************
         **/
-        Program(uint32_t vertex, uint32_t fragment)
+        Program(uint32_t vertex, uint32_t fragment) :
+            uploadsIssued_(0), uploadsSkipped_(0)
         {
             //TODO some checks are needed here to see wether shader handlers are valid
             id_ = glCreateProgram();
@@ -50,6 +73,7 @@ class Program {
             glLinkProgram       (id_);
 
             linked_ = checkLinkStatus();
+            if (linked_) introspectUniforms();
         }
 
 
@@ -58,7 +82,38 @@ class Program {
          * Use the program
          * ******************************************************
         **/
-        void use() { glUseProgram(id_); };
+        void use() { GLState::get().useProgram(id_); };
+
+        /**
+         * ******************************************************
+         * Resolve a uniform. Doesn't allocate, but still hashes
+         * the name: resolve once and keep the handle.
+         *
+         * @param name      - uniform name, e.g. "light.position"
+         *
+         * @return the handle, invalid if the uniform isn't active
+         * ******************************************************
+        **/
+        UniformHandle getUniform(const char* name) const
+        {
+            UniformHandle handle = { -1, -1 };
+            if (nameTable_.empty()) return handle;
+
+            uint32_t hash = hashName(name);
+            uint32_t mask = nameTable_.size() - 1;
+            for (uint32_t i = hash & mask; nameTable_[i].slot >= 0; i = (i + 1) & mask) {
+                const NameSlot &entry = nameTable_[i];
+                if (entry.hash != hash || strcmp(entry.name.c_str(), name) != 0) continue;
+                handle.slot     = entry.slot;
+                handle.location = uniforms_[entry.slot].location;
+                break;
+            }
+            return handle;
+        }
+        UniformHandle getUniform(const std::string &name) const
+        {
+            return getUniform(name.c_str());
+        }
 
         /**
          * ******************************************************
@@ -70,7 +125,11 @@ class Program {
         **/
         void setBool(const char* name, bool value) const
         {         
-            glUniform1i(glGetUniformLocation(id_, name), (int)value); 
+            setInt(getUniform(name), (int)value); 
+        }
+        void setBool(UniformHandle uniform, bool value) const
+        {         
+            setInt(uniform, (int)value); 
         }
 
         /**
@@ -83,7 +142,11 @@ class Program {
         **/
         void setInt(const char* name, int value) const
         { 
-            glUniform1i(glGetUniformLocation(id_, name), value); 
+            setInt(getUniform(name), value); 
+        }
+        void setInt(UniformHandle uniform, int value) const
+        { 
+            if (changed(uniform, &value, sizeof(value))) glUniform1i(uniform.location, value); 
         }
 
         /**
@@ -96,7 +159,11 @@ class Program {
         **/
         void setFloat(const char* name, float value) const
         { 
-            glUniform1f(glGetUniformLocation(id_, name), value); 
+            setFloat(getUniform(name), value); 
+        }
+        void setFloat(UniformHandle uniform, float value) const
+        { 
+            if (changed(uniform, &value, sizeof(value))) glUniform1f(uniform.location, value); 
         }
 
         /**
@@ -109,50 +176,120 @@ class Program {
         **/
         void setMat4f(const char* name, const float *value) const
         { 
+            setMat4f(getUniform(name), value); 
+        }
+        void setMat4f(UniformHandle uniform, const float *value) const
+        { 
+            if (!changed(uniform, value, 16 * sizeof(float))) return;
             glUniformMatrix4fv(
-                    glGetUniformLocation(id_, name), 
+                    uniform.location, 
                     1           /* Number of Matrices to send */, 
                     GL_FALSE    /* Whether to transpose matrix */, 
                     value); 
         }
 
-        void setVec2(const std::string &name, const glm::vec2 &value) const
+        void setVec2(const char* name, const glm::vec2 &value) const
+        {
+            setVec2(getUniform(name), value);
+        }
+        void setVec2(const char* name, float x, float y) const
+        {
+            setVec2(getUniform(name), x, y);
+        }
+        void setVec2(UniformHandle uniform, const glm::vec2 &value) const
         {
-            glUniform2fv(glGetUniformLocation(id_, name.c_str()), 1, &value[0]);
+            if (changed(uniform, &value[0], 2 * sizeof(float))) glUniform2fv(uniform.location, 1, &value[0]);
         }
-        void setVec2(const std::string &name, float x, float y) const
+        void setVec2(UniformHandle uniform, float x, float y) const
         {
-            glUniform2f(glGetUniformLocation(id_, name.c_str()), x, y);
+            setVec2(uniform, glm::vec2(x, y));
         }
         // ------------------------------------------------------------------------
-        void setVec3(const std::string &name, const glm::vec3 &value) const
+        void setVec3(const char* name, const glm::vec3 &value) const
+        {
+            setVec3(getUniform(name), value);
+        }
+        void setVec3(const char* name, float x, float y, float z) const
+        {
+            setVec3(getUniform(name), x, y, z);
+        }
+        void setVec3(UniformHandle uniform, const glm::vec3 &value) const
         {
-            glUniform3fv(glGetUniformLocation(id_, name.c_str()), 1, &value[0]);
+            if (changed(uniform, &value[0], 3 * sizeof(float))) glUniform3fv(uniform.location, 1, &value[0]);
         }
-        void setVec3(const std::string &name, float x, float y, float z) const
+        void setVec3(UniformHandle uniform, float x, float y, float z) const
         {
-            glUniform3f(glGetUniformLocation(id_, name.c_str()), x, y, z);
+            setVec3(uniform, glm::vec3(x, y, z));
         }
         // ------------------------------------------------------------------------
-        void setVec4(const std::string &name, const glm::vec4 &value) const
+        void setVec4(const char* name, const glm::vec4 &value) const
         {
-            glUniform4fv(glGetUniformLocation(id_, name.c_str()), 1, &value[0]);
+            setVec4(getUniform(name), value);
         }
-        void setVec4(const std::string &name, float x, float y, float z, float w)
+        void setVec4(const char* name, float x, float y, float z, float w) const
         {
-            glUniform4f(glGetUniformLocation(id_, name.c_str()), x, y, z, w);
+            setVec4(getUniform(name), x, y, z, w);
+        }
+        void setVec4(UniformHandle uniform, const glm::vec4 &value) const
+        {
+            if (changed(uniform, &value[0], 4 * sizeof(float))) glUniform4fv(uniform.location, 1, &value[0]);
+        }
+        void setVec4(UniformHandle uniform, float x, float y, float z, float w) const
+        {
+            setVec4(uniform, glm::vec4(x, y, z, w));
         }
         // ------------------------------------------------------------------------
-        void setMat2(const std::string &name, const glm::mat2 &mat) const
+        void setMat2(const char* name, const glm::mat2 &mat) const
         {
-            glUniformMatrix2fv(glGetUniformLocation(id_, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+            setMat2(getUniform(name), mat);
+        }
+        void setMat2(UniformHandle uniform, const glm::mat2 &mat) const
+        {
+            if (!changed(uniform, &mat[0][0], 4 * sizeof(float))) return;
+            glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
         }
         // ------------------------------------------------------------------------
-        void setMat3(const std::string &name, const glm::mat3 &mat) const
+        void setMat3(const char* name, const glm::mat3 &mat) const
+        {
+            setMat3(getUniform(name), mat);
+        }
+        void setMat3(UniformHandle uniform, const glm::mat3 &mat) const
         {
-            glUniformMatrix3fv(glGetUniformLocation(id_, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+            if (!changed(uniform, &mat[0][0], 9 * sizeof(float))) return;
+            glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
         }
 
+        /**
+         * ******************************************************
+         * Bind a uniform block to a binding point
+         *
+         * @param name      - block name, e.g. "Camera"
+         * @param binding   - binding point of the UniformBuffer
+         *
+         * @return false if the program has no such block
+         * ******************************************************
+        **/
+        bool bindUniformBlock(const char* name, uint32_t binding)
+        {
+            uint32_t index = glGetUniformBlockIndex(id_, name);
+            if (index == GL_INVALID_INDEX) {
+                LOG(L_DBG, "Program %d has no uniform block %s.", id_, name);
+                return false;
+            }
+            glUniformBlockBinding(id_, index, binding);
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Uniform upload counters. Reset them once per frame to
+         * get per frame numbers.
+         * ******************************************************
+        **/
+        uint64_t getUploadsIssued() const { return uploadsIssued_; }
+        uint64_t getUploadsSkipped() const { return uploadsSkipped_; }
+        void resetUploadStats() { uploadsIssued_ = 0; uploadsSkipped_ = 0; }
+
         /**
          * ******************************************************
          * Check if the program linked successfully
@@ -186,9 +323,158 @@ class Program {
         uint32_t getId() { return id_; };
 
 
+    private:
+        /**
+         * ******************************************************
+         * Active uniform, as reported after linking
+         * ******************************************************
+        **/
+        struct Uniform {
+            std::string name;       /* Full name, e.g. "material.diffuse1" */
+            int32_t     location;   /* GL location */
+            uint32_t    type;       /* GL type, e.g. GL_FLOAT_VEC3 */
+        };
+
+        /**
+         * ******************************************************
+         * Entry of the name table, slot -1 if empty
+         * ******************************************************
+        **/
+        struct NameSlot {
+            std::string name;       /* "name[0]" and its alias "name" get one each */
+            uint32_t    hash;       /* hashName(name) */
+            int32_t     slot;       /* Index in uniforms_ */
+        };
+
+        /**
+         * ******************************************************
+         * Last value uploaded to a uniform. Large enough for a mat4.
+         * ******************************************************
+        **/
+        struct UniformShadow {
+            uint8_t     value[16 * sizeof(float)];
+            uint32_t    size;       /* 0 until the first upload */
+        };
+
+        /**
+         * ******************************************************
+         * Compare with the shadow copy and update it
+         *
+         * @param uniform   - the uniform to be set
+         * @param value     - new value
+         * @param size      - value size in bytes
+         *
+         * @return true if the value has to be uploaded
+         * ******************************************************
+        **/
+        bool changed(UniformHandle uniform, const void *value, uint32_t size) const
+        {
+            if (uniform.slot < 0) return false;
+
+            UniformShadow &shadow = shadows_[uniform.slot];
+            if (shadow.size == size && memcmp(shadow.value, value, size) == 0) {
+                uploadsSkipped_++;
+                return false;
+            }
+
+            memcpy(shadow.value, value, size);
+            shadow.size = size;
+            uploadsIssued_++;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Build the name to location table from the active
+         * uniforms. Arrays are registered per element, and
+         * "name" is an alias for "name[0]".
+         * ******************************************************
+        **/
+        void introspectUniforms()
+        {
+            int32_t count = 0, maxLen = 0;
+            glGetProgramiv(id_, GL_ACTIVE_UNIFORMS, &count);
+            glGetProgramiv(id_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLen);
+            if (count <= 0 || maxLen <= 0) return;
+
+            std::vector<char> buff(maxLen);
+            std::vector<std::pair<std::string, uint32_t>> aliases;  /* "name" of the "name[0]" slots */
+            for (int32_t i = 0; i < count; i++) {
+                int32_t len = 0, size = 0;
+                uint32_t type = 0;
+                glGetActiveUniform(id_, i, maxLen, &len, &size, &type, buff.data());
+                std::string name(buff.data(), len);
+
+                /* Uniform block members have no location */
+                int32_t location = glGetUniformLocation(id_, name.c_str());
+                if (location < 0) continue;
+
+                addUniform(name, location, type);
+
+                size_t bracket = name.rfind("[0]");
+                if (bracket == std::string::npos || bracket + 3 != name.size()) continue;
+
+                /* Same slot, so both names share one shadow copy */
+                std::string base = name.substr(0, bracket);
+                aliases.push_back(std::make_pair(base, uniforms_.size() - 1));
+                for (int32_t e = 1; e < size; e++) {
+                    std::string element = base + "[" + std::to_string(e) + "]";
+                    addUniform(element, glGetUniformLocation(id_, element.c_str()), type);
+                }
+            }
+
+            /* Open addressing, at most half full */
+            uint32_t names = uniforms_.size() + aliases.size(), tableSize = 1;
+            while (tableSize < 2 * names) tableSize <<= 1;
+            NameSlot empty = { std::string(), 0, -1 };
+            nameTable_.assign(tableSize, empty);
+            for (uint32_t slot = 0; slot < uniforms_.size(); slot++) addName(uniforms_[slot].name, slot);
+            for (size_t i = 0; i < aliases.size(); i++) addName(aliases[i].first, aliases[i].second);
+
+            LOG(L_DBG, "Program %d: %lu uniform locations.", id_, (unsigned long)uniforms_.size());
+        }
+
+        void addUniform(const std::string &name, int32_t location, uint32_t type)
+        {
+            Uniform uniform = { name, location, type };
+            UniformShadow shadow;
+            shadow.size = 0;
+            uniforms_.push_back(uniform);
+            shadows_.push_back(shadow);
+        }
+
+        /* Insert into the name table, a name already there keeps its slot */
+        void addName(const std::string &name, uint32_t slot)
+        {
+            uint32_t hash = hashName(name.c_str());
+            uint32_t mask = nameTable_.size() - 1;
+            uint32_t i = hash & mask;
+            for (; nameTable_[i].slot >= 0; i = (i + 1) & mask) {
+                if (nameTable_[i].hash == hash && nameTable_[i].name == name) return;
+            }
+            nameTable_[i].name = name;
+            nameTable_[i].hash = hash;
+            nameTable_[i].slot = slot;
+        }
+
+        /* FNV-1a */
+        static uint32_t hashName(const char* name)
+        {
+            uint32_t hash = 2166136261u;
+            for (; *name != '\0'; name++) hash = (hash ^ (uint8_t)*name) * 16777619u;
+            return hash;
+        }
+
     private:
         uint32_t    id_;        /* Program id */
         bool        linked_;    /* Whether it linked successfully */
+
+        std::vector<Uniform>                        uniforms_;      /* Active uniforms, by slot */
+        std::vector<NameSlot>                       nameTable_;     /* Name to slot, see getUniform */
+
+        mutable std::vector<UniformShadow>          shadows_;       /* Last uploaded values, by slot */
+        mutable uint64_t                            uploadsIssued_; /* glUniform* calls made */
+        mutable uint64_t                            uploadsSkipped_;/* Calls skipped, value unchanged */
 }; 
 
 
@@ -0,0 +1,348 @@
+/******************************************
+
+* File Name : includes/RenderQueue.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Collects mesh draws, sorts them by a 64 bit state key and submits
+ * them through GLState, which drops the program, texture and VAO binds
+ * that would set what is already bound. Meshes sharing textures (the
+ * Model texture cache hands out the same Texture*) end up next to each
+ * other, so most of their binds are dropped. Meshes with material
+ * layers (see TextureArray) share their arrays and only change the
+ * layer uniform. Instanced items draw every instance of their mesh's
+ * InstanceBuffer in one call.
+ *
+ * Meshes in the MeshArena share one VAO, so after sorting the plain
+ * draws of a program and material are runs of arena meshes. A run is
+ * drawn with one glMultiDrawElementsIndirect, its commands written on
+ * the CPU into an indirect buffer uploaded once per submit. Without
+ * GL 4.3 or ARB_multi_draw_indirect the run loops over the same
+ * commands with glDrawElementsBaseVertex.
+ *
+ * Sort key, most significant first:
+ *  | program 8 | material 16 | VAO 16 | instanced 1 | depth 23 |
+ *
+ * The instanced bit puts the plain draws of a VAO before its instanced
+ * ones, whatever their depth, so the arena runs aren't split by an
+ * instanced draw sorting between them.
+ */
+
+#ifndef _LOGL_RENDER_QUEUE_HPP_
+#define _LOGL_RENDER_QUEUE_HPP_
+
+/* STD */
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+#include "Utils.hpp"
+#include "GLState.hpp"
+#include "Program.hpp"
+#include "Mesh.hpp"
+#include "MeshArena.hpp"
+#include "TextureManager.hpp"
+
+/**
+ * ******************************************************
+ * State changes issued and saved by the queue
+ * ******************************************************
+**/
+struct RenderQueueStats {
+    uint64_t draws;             /* Meshes drawn, one per command of a multi draw */
+    uint64_t multiDraws;        /* glMultiDrawElementsIndirect calls */
+    uint64_t instances;         /* Drawn by the instanced draws */
+    uint64_t programBinds;
+    uint64_t programBindsSaved;
+    uint64_t textureBinds;
+    uint64_t textureBindsSaved;
+    uint64_t vaoBinds;
+    uint64_t vaoBindsSaved;
+};
+
+/**
+ * ******************************************************
+ * @brief Render queue
+ * ******************************************************
+**/
+class RenderQueue {
+    public: /* Constructors */
+        RenderQueue() :
+            indirectBuffer_(0), indirectCapacity_(0), multiDraw_(true)
+        {
+            resetStats();
+        }
+
+        ~RenderQueue()
+        {
+            if (indirectBuffer_ != 0) glDeleteBuffers(1, &indirectBuffer_);
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Queue a mesh
+         *
+         * @param[in] program       - program to draw with
+         * @param[in] mesh
+         * @param[in] depth         - normalized view depth [0, 1],
+         *                            nearer is drawn first
+         * @param[in] instances     - instances to draw from the mesh's
+         *                            InstanceBuffer, 0 for a plain draw
+         * ******************************************************
+        **/
+        void push(Program & program, Mesh * mesh, float depth = 0.0f, size_t instances = 0)
+        {
+            DrawItem item;
+            item.key        = makeKey(program, mesh, depth, instances != 0);
+            item.program    = &program;
+            item.mesh       = mesh;
+            item.instances  = instances;
+            items_.push_back(item);
+        }
+
+        /**
+         * ******************************************************
+         * Sort and draw the queued meshes, then clear the queue.
+         * The storage is kept, so a reused queue doesn't allocate.
+         * ******************************************************
+        **/
+        void submit()
+        {
+            std::sort(items_.begin(), items_.end(),
+                    [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+
+            buildBatches();
+            bool multiDraw = multiDraw_ && (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+            if (multiDraw && !commands_.empty()) uploadCommands();
+
+            for (size_t b = 0; b < batches_.size(); b++) {
+                const Batch& batch = batches_[b];
+                const DrawItem& item = items_[batch.first];
+                Mesh& mesh = *item.mesh;
+                bindState(*item.program, mesh);
+
+                if (batch.commands != 0) {
+                    if (multiDraw) {
+                        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                (void*)(batch.firstCommand * sizeof(DrawElementsIndirectCommand)), batch.commands, 0);
+                        stats_.multiDraws++;
+                    } else {
+                        for (uint32_t c = batch.firstCommand; c < batch.firstCommand + batch.commands; c++) {
+                            glDrawElementsBaseVertex(GL_TRIANGLES, commands_[c].count, GL_UNSIGNED_INT,
+                                    (void*)((size_t)commands_[c].firstIndex * sizeof(uint32_t)), commands_[c].baseVertex);
+                        }
+                    }
+                    stats_.draws += batch.commands;
+                } else if (item.instances != 0) {
+                    /* Arena meshes share the VAO, and so the instance buffer */
+                    if (mesh.isInArena()) MeshArena::get().setInstanceBuffer(*mesh.getInstanceBuffer());
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.getIndexCount(), mesh.getIndexType(),
+                            (void*)mesh.getIndexOffset(), item.instances, mesh.getBaseVertex());
+                    stats_.instances += item.instances;
+                    stats_.draws++;
+                } else {
+                    glDrawElementsBaseVertex(GL_TRIANGLES, mesh.getIndexCount(), mesh.getIndexType(),
+                            (void*)mesh.getIndexOffset(), mesh.getBaseVertex());
+                    stats_.draws++;
+                }
+            }
+            if (multiDraw && !commands_.empty()) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+            items_.clear();
+        }
+
+        /**
+         * ******************************************************
+         * Draw the arena runs with glMultiDrawElementsIndirect,
+         * when the context has it. On by default.
+         * ******************************************************
+        **/
+        void setMultiDraw(bool multiDraw) { multiDraw_ = multiDraw; }
+
+        /**
+         * ******************************************************
+         * Counters, accumulated until reset
+         * ******************************************************
+        **/
+        const RenderQueueStats& getStats() { return stats_; }
+        void resetStats() { memset(&stats_, 0, sizeof(stats_)); }
+
+        size_t size() { return items_.size(); }
+
+    private: /* Types */
+        struct DrawItem {
+            uint64_t    key;
+            Program*    program;
+            Mesh*       mesh;
+            size_t      instances;  /* 0 for a plain draw */
+        };
+
+        /* Sorted items drawn with the state of the first one */
+        struct Batch {
+            size_t      first;          /* Item */
+            uint32_t    firstCommand;
+            uint32_t    commands;       /* 0 for a single draw of the item */
+        };
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Group the sorted items. Plain draws of arena meshes with
+         * the same program and material become one batch, with a
+         * command per mesh; the others are batches of their own.
+         * ******************************************************
+        **/
+        void buildBatches()
+        {
+            batches_.clear();
+            commands_.clear();
+            for (size_t i = 0; i < items_.size(); i++) {
+                Mesh& mesh = *items_[i].mesh;
+                Batch batch = { i, 0, 0 };
+                if (items_[i].instances != 0 || !mesh.isInArena()) {
+                    batches_.push_back(batch);
+                    continue;
+                }
+
+                if (!batches_.empty() && batches_.back().commands != 0 &&
+                        sameState(items_[batches_.back().first], items_[i])) {
+                    batches_.back().commands++;
+                } else {
+                    batch.firstCommand = commands_.size();
+                    batch.commands = 1;
+                    batches_.push_back(batch);
+                }
+
+                DrawElementsIndirectCommand command;
+                command.count           = mesh.getIndexCount();
+                command.instanceCount   = 1;
+                command.firstIndex      = mesh.getFirstIndex();
+                command.baseVertex      = mesh.getBaseVertex();
+                command.baseInstance    = 0;
+                commands_.push_back(command);
+            }
+        }
+
+        /* Whether b draws with the program and material a left bound */
+        static bool sameState(const DrawItem& a, const DrawItem& b)
+        {
+            Mesh& x = *a.mesh;
+            Mesh& y = *b.mesh;
+            return a.program == b.program &&
+                x.getTextures() == y.getTextures() &&
+                x.getTextureArrays() == y.getTextureArrays() &&
+                (x.getTextureArrays().empty() || x.getLayers() == y.getLayers());
+        }
+
+        /**
+         * ******************************************************
+         * Write the commands into the indirect buffer, orphaning
+         * last frame's. Leaves it bound for the multi draws.
+         * ******************************************************
+        **/
+        void uploadCommands()
+        {
+            if (indirectBuffer_ == 0) glGenBuffers(1, &indirectBuffer_);
+            if (commands_.size() > indirectCapacity_) indirectCapacity_ = commands_.size();
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer_);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectCapacity_ * sizeof(DrawElementsIndirectCommand),
+                    NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands_.size() * sizeof(DrawElementsIndirectCommand),
+                    commands_.data());
+        }
+
+        /**
+         * ******************************************************
+         * Bind the program, material and VAO of a mesh
+         * ******************************************************
+        **/
+        void bindState(Program & program, Mesh & mesh)
+        {
+            GLState& state = GLState::get();
+            TextureManager& textureManager = TextureManager::get();
+
+            if (state.useProgram(program.getId())) stats_.programBinds++;
+            else                                    stats_.programBindsSaved++;
+
+            const std::vector<Texture*>& textures = mesh.getTextures();
+            const std::vector<UniformHandle>& samplers = mesh.getSamplers(program);
+            for (uint32_t unit = 0; unit < textures.size(); unit++) textureManager.touch(textures[unit]);
+            for (uint32_t unit = 0; unit < textures.size(); unit++) {
+                /* The program keeps a shadow copy, unchanged units are not uploaded */
+                program.setInt(samplers[unit], unit);
+
+                if (state.bindTexture(unit, textures[unit]->getHandler())) stats_.textureBinds++;
+                else                                                        stats_.textureBindsSaved++;
+            }
+
+            const std::vector<TextureArray*>& arrays = mesh.getTextureArrays();
+            for (uint32_t unit = 0; unit < arrays.size(); unit++) {
+                /* Slots the program doesn't sample keep their unit */
+                if (!samplers[unit].valid()) continue;
+                program.setInt(samplers[unit], unit);
+
+                if (state.bindTexture(unit, arrays[unit]->getHandler(), GL_TEXTURE_2D_ARRAY)) stats_.textureBinds++;
+                else                                                                       stats_.textureBindsSaved++;
+            }
+            if (!arrays.empty()) program.setVec4(mesh.getLayersUniform(program), mesh.getLayers());
+
+            if (state.bindVertexArray(mesh.getVertexArray())) stats_.vaoBinds++;
+            else                                               stats_.vaoBindsSaved++;
+        }
+
+        /**
+         * ******************************************************
+         * Build the sort key
+         *
+         * The material bits hash the texture (or array) handles in
+         * unit order, so meshes with the same texture set share them.
+         * ******************************************************
+        **/
+        static uint64_t makeKey(Program & program, Mesh * mesh, float depth, bool instanced)
+        {
+            uint32_t material = 2166136261u; /* FNV-1a */
+            const std::vector<Texture*>& textures = mesh->getTextures();
+            for (size_t i = 0; i < textures.size(); i++) {
+                material = (material ^ textures[i]->getHandler()) * 16777619u;
+            }
+            const std::vector<TextureArray*>& arrays = mesh->getTextureArrays();
+            for (size_t i = 0; i < arrays.size(); i++) {
+                material = (material ^ arrays[i]->getHandler()) * 16777619u;
+            }
+            material = (material >> 16) ^ (material & 0xFFFF);
+
+            if (depth < 0.0f) depth = 0.0f;
+            if (depth > 1.0f) depth = 1.0f;
+            uint64_t depthBits = (uint64_t)(depth * 0x7FFFFF);
+
+            return ((uint64_t)(program.getId() & 0xFF)          << 56) |
+                   ((uint64_t)(material & 0xFFFF)               << 40) |
+                   ((uint64_t)(mesh->getVertexArray() & 0xFFFF) << 24) |
+                   ((uint64_t)(instanced ? 1 : 0)               << 23) |
+                   (depthBits & 0x7FFFFF);
+        }
+
+    private: /* Members */
+        std::vector<DrawItem>   items_;             /* Queued draws, storage is reused */
+        std::vector<Batch>      batches_;           /* Of the sorted items, reused */
+        std::vector<DrawElementsIndirectCommand> commands_;     /* Of the arena batches, reused */
+        uint32_t                indirectBuffer_;    /* GL_DRAW_INDIRECT_BUFFER, created on first use */
+        size_t                  indirectCapacity_;  /* Commands the indirect buffer holds */
+        bool                    multiDraw_;         /* Use glMultiDrawElementsIndirect if available */
+        RenderQueueStats        stats_;             /* State change counters */
+};
+
+#endif
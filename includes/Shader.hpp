@@ -7,6 +7,7 @@
 #include "Files.hpp"
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -32,14 +33,43 @@ class Shader {
          * ******************************************************
          */
         Shader(const char* path, uint32_t type, const char* log = SHADER_LOG)
+            : Shader(path, type, std::vector<std::string>(), log)
+        {
+        }
+
+        /**
+         * ******************************************************
+         * Shader constructor with preprocessor defines
+         *
+         * The defines go right after the #version line, which
+         * must come first; #line keeps the error line numbers of
+         * the file.
+         *
+         * @param shader path 
+         * @param shader type 
+         * @param defines   - "NAME" or "NAME VALUE"
+         * @param shader log 
+         * ******************************************************
+         */
+        Shader(const char* path, uint32_t type, const std::vector<std::string> & defines,
+                const char* log = SHADER_LOG)
             : file_(path), type_(type), log_(log) 
         {
-            const char* buff = 0;
+            std::string code = file_.getBuff();
+            std::string header, body = code;
+            if (!defines.empty() && code.compare(0, 8, "#version") == 0) {
+                size_t eol = code.find('\n');
+                eol = eol == std::string::npos ? code.size() : eol + 1;
+                header = code.substr(0, eol);
+                for (size_t i = 0; i < defines.size(); i++) header += "#define " + defines[i] + "\n";
+                header += "#line 2\n";
+                body = code.substr(eol);
+            }
+
             /* Compile shaders */
-            buff        = file_.getBuff();
-            handler_    = compileShader(type, 1, &buff, NULL);
+            const char* buff[2] = { header.c_str(), body.c_str() };
+            handler_    = compileShader(type, 2, buff, NULL);
             compiled_   = checkCompileErrors(); 
-
         }
 
         /**
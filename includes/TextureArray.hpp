@@ -0,0 +1,355 @@
+/******************************************
+
+* File Name : includes/TextureArray.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Material textures packed into GL_TEXTURE_2D_ARRAY layers. The
+ * packer groups the textures of a model by size and channel count,
+ * one array per group, so meshes with different textures bind the
+ * same arrays and only switch a layer uniform. The RenderQueue then
+ * binds each array once per frame instead of a texture set per mesh.
+ *
+ * The layers are decoded, mipmapped and uploaded like Texture does,
+ * through the TextureLoader. The layers are cleared to black when
+ * allocated and read black until their image arrives. DDS files are
+ * not packed, the arrays always hold the images.
+ *
+ * A material slot without a texture samples blank(), one black layer,
+ * so no sampler is left on the unit of the previous mesh.
+ */
+
+#ifndef _LOGL_TEXTURE_ARRAY_HPP_
+#define _LOGL_TEXTURE_ARRAY_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* STD */
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdint.h>
+#include <string.h>
+
+#include <stb_image.h>
+
+#include "Utils.hpp"
+#include "GLState.hpp"
+#include "TextureLoader.hpp"
+
+#define MATERIAL_SLOTS      4       /* diffuse, specular, normals, height */
+
+/**
+ * ******************************************************
+ * Material slot of a texture type, -1 if not packed
+ * ******************************************************
+**/
+static inline int32_t materialSlot(const char* type)
+{
+    static const char* names[MATERIAL_SLOTS] = { "diffuse", "specular", "normals", "height" };
+    for (int32_t slot = 0; slot < MATERIAL_SLOTS; slot++) {
+        if (strcmp(type, names[slot]) == 0) return slot;
+    }
+    return -1;
+}
+
+/* Sampler uniform of a slot, e.g. diffuseArray */
+static inline std::string materialArraySampler(uint32_t slot)
+{
+    static const char* names[MATERIAL_SLOTS] = { "diffuseArray", "specularArray", "normalsArray", "heightArray" };
+    return names[slot];
+}
+
+/**
+ * ******************************************************
+ * @brief A GL_TEXTURE_2D_ARRAY of same sized images
+ * ******************************************************
+**/
+class TextureArray {
+    public: /* Constructors */
+        /**
+         * ******************************************************
+         * Constructor, allocates the layers and their mip chains
+         *
+         * @param[in] width
+         * @param[in] height
+         * @param[in] channels      - 1 to 4, as stb_image decodes
+         * @param[in] layers
+         * ******************************************************
+        **/
+        TextureArray(uint32_t width, uint32_t height, uint32_t channels, uint32_t layers) :
+            width_(width), height_(height), channels_(channels), layers_(layers), levels_(1)
+        {
+            while ((width >> levels_) || (height >> levels_)) levels_++;
+
+            if (channels_ == 1)         format_ = GL_RED;
+            else if (channels_ == 2)    format_ = GL_RG;
+            else if (channels_ == 3)    format_ = GL_RGB;
+            else                        format_ = GL_RGBA;
+
+            glGenTextures(1, &handler_);
+            GLState::get().bindTexture(0, handler_, GL_TEXTURE_2D_ARRAY);
+            for (uint32_t level = 0; level < levels_; level++) {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format_, levelSize(width_, level), levelSize(height_, level),
+                        layers_, 0, format_, GL_UNSIGNED_BYTE, NULL);
+            }
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels_ - 1);
+            clear();
+        }
+
+        ~TextureArray()
+        {
+            for (size_t i = 0; i < tickets_.size(); i++) TextureLoader::get().cancel(tickets_[i]);
+            glDeleteTextures(1, &handler_);
+            GLState::get().forgetTexture(handler_);
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * One black 1x1 RGBA layer, for the material slots a mesh
+         * doesn't have. Lives as long as the context, never
+         * deleted.
+         * ******************************************************
+        **/
+        static TextureArray& blank()
+        {
+            static TextureArray* array = new TextureArray(1, 1, 4, 1);
+            return *array;
+        }
+
+        /**
+         * ******************************************************
+         * Decode an image into a layer, on the TextureLoader
+         *
+         * @param[in] layer
+         * @param[in] path          - same size and channels as the array
+         * @param[in] srgb          - filter the mips as sRGB color
+         * ******************************************************
+        **/
+        void load(uint32_t layer, const std::string & path, bool srgb)
+        {
+            tickets_.push_back(TextureLoader::get().load(path, [this, layer, path](const DecodedImage& image) {
+                upload(layer, path, image);
+            }, MF_KAISER, srgb));
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        uint32_t getHandler() { return handler_; }
+        uint32_t getWidth() { return width_; }
+        uint32_t getHeight() { return height_; }
+        uint32_t getChannels() { return channels_; }
+        uint32_t getLayerCount() { return layers_; }
+
+        /* Estimated VRAM, RGB counted as RGBA */
+        size_t getBytes()
+        {
+            size_t bytes = 0;
+            for (uint32_t level = 0; level < levels_; level++) {
+                bytes += (size_t)levelSize(width_, level) * levelSize(height_, level) * (channels_ == 3 ? 4 : channels_);
+            }
+            return bytes * layers_;
+        }
+
+    private: /* Methods */
+        static uint32_t levelSize(uint32_t size, uint32_t level) { return (size >> level) ? (size >> level) : 1; }
+
+        /**
+         * ******************************************************
+         * Every level of every layer to black. Without
+         * ARB_clear_texture one layer of zeros is uploaded per
+         * layer and level, to the array bound on unit 0.
+         * ******************************************************
+        **/
+        void clear()
+        {
+            if (GLEW_VERSION_4_4 || GLEW_ARB_clear_texture) {
+                for (uint32_t level = 0; level < levels_; level++) {
+                    glClearTexImage(handler_, level, format_, GL_UNSIGNED_BYTE, NULL);
+                }
+                return;
+            }
+
+            std::vector<uint8_t> zeros((size_t)width_ * height_ * channels_, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (uint32_t level = 0; level < levels_; level++) {
+                for (uint32_t layer = 0; layer < layers_; layer++) {
+                    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+                            levelSize(width_, level), levelSize(height_, level), 1,
+                            format_, GL_UNSIGNED_BYTE, zeros.data());
+                }
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+        /**
+         * ******************************************************
+         * Upload a decoded layer and its mip chain
+         * ******************************************************
+        **/
+        void upload(uint32_t layer, const std::string & path, const DecodedImage& image)
+        {
+            if (image.data == NULL) return; /* Stays black */
+            if ((uint32_t)image.width != width_ || (uint32_t)image.height != height_ ||
+                    (uint32_t)image.channels != channels_ || image.mips == NULL) {
+                LOG(L_ERR, "%s changed since it was packed, layer %u left empty.", path.c_str(), layer);
+                return;
+            }
+
+            GLState::get().bindTexture(0, handler_, GL_TEXTURE_2D_ARRAY);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (uint32_t level = 0; level < levels_; level++) {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+                        levelSize(width_, level), levelSize(height_, level), 1,
+                        format_, GL_UNSIGNED_BYTE, level == 0 ? image.data : image.mips->getLevel(level));
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+    private: /* Members */
+        uint32_t                handler_;   /* Texture handler */
+        uint32_t                width_;     /* Of every layer */
+        uint32_t                height_;    /* Of every layer */
+        uint32_t                channels_;  /* Of every layer */
+        uint32_t                layers_;
+        uint32_t                levels_;    /* Full chain */
+        GLenum                  format_;    /* Pixel and internal format */
+        std::vector<uint32_t>   tickets_;   /* TextureLoader tickets, for cancel() */
+};
+
+/**
+ * ******************************************************
+ * Where a mesh finds its material textures. arrays[slot]
+ * is NULL for a slot the material doesn't have.
+ * ******************************************************
+**/
+struct MaterialLayers {
+    TextureArray    *arrays[MATERIAL_SLOTS];
+    float           layers[MATERIAL_SLOTS];
+};
+
+/**
+ * ******************************************************
+ * @brief Packs the textures of a model into arrays
+ *
+ * add() every texture, pack() once, then get() the layer
+ * of each. The packer owns the arrays.
+ * ******************************************************
+**/
+class TextureArrayPacker {
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Register a texture, the same path is packed once
+         *
+         * @param[in] path
+         * @param[in] srgb          - filter the mips as sRGB color
+         * ******************************************************
+        **/
+        void add(const std::string & path, bool srgb)
+        {
+            if (entries_.find(path) != entries_.end()) return;
+            Entry entry;
+            entry.srgb = srgb;
+            entry.missing = false;
+            entry.array = NULL;
+            entry.layer = 0;
+            entries_.insert(std::make_pair(path, entry));
+        }
+
+        /**
+         * ******************************************************
+         * Group the textures by size and channels, read from the
+         * image headers, and queue the layer loads. A texture
+         * that can't be read still gets a (black) layer.
+         * ******************************************************
+        **/
+        void pack()
+        {
+            std::map<uint64_t, std::vector<Entry*>> groups;
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                int width = 1, height = 1, channels = 4;
+                if (!stbi_info(it->first.c_str(), &width, &height, &channels)) {
+                    LOG(L_ERR, "Could not open texture: %s!", it->first.c_str());
+                    width = height = 1;
+                    channels = 4;
+                    it->second.missing = true;
+                }
+                it->second.path = &it->first;
+                uint64_t key = ((uint64_t)width << 32) | ((uint64_t)height << 8) | channels;
+                groups[key].push_back(&it->second);
+            }
+
+            for (auto it = groups.begin(); it != groups.end(); ++it) {
+                std::vector<Entry*> & group = it->second;
+                TextureArray* array = new TextureArray(it->first >> 32, (it->first >> 8) & 0xFFFFFF,
+                        it->first & 0xFF, group.size());
+                arrays_.push_back(std::unique_ptr<TextureArray>(array));
+
+                for (uint32_t layer = 0; layer < group.size(); layer++) {
+                    group[layer]->array = array;
+                    group[layer]->layer = layer;
+                    if (!group[layer]->missing) array->load(layer, *group[layer]->path, group[layer]->srgb);
+                }
+            }
+
+            size_t bytes = 0;
+            for (size_t i = 0; i < arrays_.size(); i++) bytes += arrays_[i]->getBytes();
+            LOG(L_INFO, "Packed %lu textures into %lu texture arrays, %lu KiB.", (unsigned long)entries_.size(),
+                    (unsigned long)arrays_.size(), (unsigned long)(bytes / 1024));
+        }
+
+        /**
+         * ******************************************************
+         * Array and layer of a packed texture
+         *
+         * @return false if the path was never added
+         * ******************************************************
+        **/
+        bool get(const std::string & path, TextureArray*& array, uint32_t& layer)
+        {
+            auto found = entries_.find(path);
+            if (found == entries_.end() || found->second.array == NULL) return false;
+            array = found->second.array;
+            layer = found->second.layer;
+            return true;
+        }
+
+        size_t getArrayCount() { return arrays_.size(); }
+
+    private: /* Types */
+        struct Entry {
+            const std::string   *path;  /* Key of the entry */
+            bool                srgb;
+            bool                missing;    /* Unreadable, the layer stays black */
+            TextureArray        *array;
+            uint32_t            layer;
+        };
+
+    private: /* Members */
+        std::map<std::string, Entry>                entries_;   /* By path */
+        std::vector<std::unique_ptr<TextureArray>>  arrays_;    /* One per size and channel count */
+};
+
+#endif
@@ -0,0 +1,240 @@
+/******************************************
+
+* File Name : includes/TextureLoader.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Decodes image files on the ThreadPool and hands the pixels back to
+ * the context thread, which uploads them from poll(). Knows nothing
+ * about GL or Texture; the owner gets a callback with the pixels.
+ * The mip chain is built on the worker too, right after the decode.
+ */
+
+#ifndef _LOGL_TEXTURE_LOADER_HPP_
+#define _LOGL_TEXTURE_LOADER_HPP_
+
+/* STD */
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+
+#include <stb_image.h>
+
+#include "Utils.hpp"
+#include "ThreadPool.hpp"
+#include "MipChain.hpp"
+
+/**
+ * ******************************************************
+ * Decoded pixels, NULL data if the file could not be read.
+ * Owned by the loader, freed after the callback returns.
+ * ******************************************************
+**/
+struct DecodedImage {
+    uint8_t     *data;
+    int         width;
+    int         height;
+    int         channels;
+    MipChain    *mips;      /* Levels 1 and down, NULL to build them on upload */
+};
+
+/**
+ * ******************************************************
+ * @brief Asynchronous image decoder
+ * ******************************************************
+**/
+class TextureLoader {
+    public: /* Constructors */
+        TextureLoader() :
+            nextTicket_(1), pending_(0), decoded_(0)
+        {
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * The loader of the (only) context
+         * ******************************************************
+        **/
+        static TextureLoader& get()
+        {
+            static TextureLoader loader;
+            return loader;
+        }
+
+        /**
+         * ******************************************************
+         * Queue a file for decoding
+         *
+         * @param[in] path
+         * @param[in] onReady       - called from poll(), on the
+         *                            context thread
+         * @param[in] filter        - mip chain filter
+         * @param[in] srgb          - the color channels are sRGB
+         *
+         * @return ticket, for cancel()
+         * ******************************************************
+        **/
+        uint32_t load(const std::string & path, std::function<void(const DecodedImage&)> onReady,
+                MipFilter filter = MF_KAISER, bool srgb = false)
+        {
+            /* Global in stb_image; every loader here wants it, set it before any worker reads it */
+            stbi_set_flip_vertically_on_load(true);
+
+            std::shared_ptr<Job> job(new Job());
+            job->path = path;
+            job->onReady = onReady;
+            job->canceled = false;
+            job->image.data = NULL;
+            job->image.mips = NULL;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                job->ticket = nextTicket_++;
+                if (pending_ == 0) {
+                    batchStart_ = std::chrono::steady_clock::now();
+                    decoded_ = 0;
+                }
+                pending_++;
+                jobs_.push_back(job);
+            }
+
+            ThreadPool::global().enqueue([this, job, filter, srgb]() {
+                DecodedImage & image = job->image;
+                image.data = stbi_load(job->path.c_str(), &image.width, &image.height, &image.channels, 0);
+                if (image.data != NULL) {
+                    job->mips.build(image.data, image.width, image.height, image.channels, filter, srgb);
+                    image.mips = &job->mips;
+                }
+
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.push_back(job);
+            });
+            return job->ticket;
+        }
+
+        /**
+         * ******************************************************
+         * Drop the callback of a queued file, its owner is gone.
+         * The decode itself still runs and is thrown away.
+         *
+         * @param[in] ticket
+         * ******************************************************
+        **/
+        void cancel(uint32_t ticket)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < jobs_.size(); i++) {
+                if (jobs_[i]->ticket == ticket) jobs_[i]->canceled = true;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Hand the decoded images to their owners. Call once per
+         * frame on the context thread.
+         *
+         * @param[in] maxUploads    - callbacks run this call, 0 for all
+         *
+         * @return callbacks run
+         * ******************************************************
+        **/
+        uint32_t poll(uint32_t maxUploads = 0)
+        {
+            std::vector<std::shared_ptr<Job>> ready;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (ready_.empty()) return 0;
+
+                size_t count = ready_.size();
+                if (maxUploads != 0 && count > maxUploads) count = maxUploads;
+                ready.assign(ready_.begin(), ready_.begin() + count);
+                ready_.erase(ready_.begin(), ready_.begin() + count);
+            }
+
+            uint32_t uploads = 0;
+            for (size_t i = 0; i < ready.size(); i++) {
+                Job & job = *ready[i];
+
+                /* cancel() runs on this thread too, the flag can't change under us */
+                if (!job.canceled) {
+                    if (job.image.data == NULL) {
+                        LOG(L_ERR, "Could not open texture: %s!", job.path.c_str());
+                    }
+                    job.onReady(job.image);
+                    uploads++;
+                }
+                stbi_image_free(job.image.data);
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < ready.size(); i++) {
+                jobs_.erase(std::find(jobs_.begin(), jobs_.end(), ready[i]));
+            }
+            pending_ -= ready.size();
+            decoded_ += ready.size();
+            if (pending_ == 0) {
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - batchStart_;
+                LOG(L_INFO, "Texture queue drained, %u textures decoded in %.2f ms.", decoded_, elapsed.count());
+            }
+            return uploads;
+        }
+
+        /**
+         * ******************************************************
+         * Block until everything queued was handed out
+         * ******************************************************
+        **/
+        void finish()
+        {
+            while (getPending() != 0) {
+                if (poll() == 0) std::this_thread::yield();
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        uint32_t getPending()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return pending_;
+        }
+
+    private: /* Types */
+        struct Job {
+            uint32_t                                    ticket;
+            std::string                                 path;
+            std::function<void(const DecodedImage&)>    onReady;
+            bool                                        canceled;
+            DecodedImage                                image;
+            MipChain                                    mips;
+        };
+
+    private: /* Members */
+        std::mutex                              mutex_;         /* Guards everything below */
+        uint32_t                                nextTicket_;    /* Next ticket handed out */
+        uint32_t                                pending_;       /* Queued, not handed out yet */
+        uint32_t                                decoded_;       /* Handed out since the queue was last empty */
+        std::chrono::steady_clock::time_point   batchStart_;    /* When the queue was last empty */
+        std::vector<std::shared_ptr<Job>>      jobs_;          /* Queued jobs, for cancel() */
+        std::vector<std::shared_ptr<Job>>      ready_;         /* Decoded, waiting for poll() */
+};
+
+#endif
@@ -0,0 +1,252 @@
+/******************************************
+
+* File Name : includes/TextureManager.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Owns the model textures. Models acquire a texture by path and
+ * release it when they go; the texture is shared between models and
+ * deleted with its last reference.
+ *
+ * Keeps the estimated VRAM of the textures under a budget. Once per
+ * frame the least recently bound textures are evicted down to their
+ * small levels (TEXTURE_EVICT_SIZE), and an evicted texture that is
+ * bound again is reloaded through the TextureLoader. Textures bound
+ * in the last TM_KEEP_FRAMES frames are never evicted, a scene that
+ * needs more than the budget every frame stays over it.
+ *
+ * The draws only queue the reloads, update() starts them before the
+ * next frame's draws. A reload reads the file (a DDS synchronously)
+ * and binds unit 0, neither belongs between two texture binds of a
+ * material; until then the draws sample the tail.
+ */
+
+#ifndef _LOGL_TEXTURE_MANAGER_HPP_
+#define _LOGL_TEXTURE_MANAGER_HPP_
+
+/* STD */
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Utils.hpp"
+#include "Textures.hpp"
+
+#define TM_DEFAULT_BUDGET   ((size_t)512 << 20)
+#define TM_KEEP_FRAMES      2           /* Frames a bound texture is safe from eviction */
+
+/**
+ * ******************************************************
+ * Residency counters. Evictions and reloads add up until
+ * reset, the rest is the current state.
+ * ******************************************************
+**/
+struct TextureManagerStats {
+    size_t      textures;       /* Textures held */
+    size_t      evicted;        /* Of those, down to their tail */
+    size_t      residentBytes;  /* Estimated VRAM */
+    size_t      budget;
+    uint64_t    evictions;
+    uint64_t    reloads;
+};
+
+/**
+ * ******************************************************
+ * @brief Refcounted texture cache with a VRAM budget
+ * ******************************************************
+**/
+class TextureManager {
+    public: /* Constructors */
+        TextureManager() :
+            budget_(TM_DEFAULT_BUDGET), frame_(0), evictions_(0), reloads_(0)
+        {
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * The manager of the (only) context
+         * ******************************************************
+        **/
+        static TextureManager& get()
+        {
+            static TextureManager manager;
+            return manager;
+        }
+
+        /**
+         * ******************************************************
+         * Get a texture, loading it if nobody holds it
+         *
+         * @param[in] path
+         * @param[in] type          - texture type, see Texture
+         * @param[in] async         - decode on the TextureLoader
+         *
+         * @return the texture, release() it when done
+         * ******************************************************
+        **/
+        Texture* acquire(const std::string & path, const char* type, bool async = true)
+        {
+            auto found = textures_.find(path);
+            if (found != textures_.end()) {
+                found->second.refs++;
+                return found->second.texture;
+            }
+
+            Entry entry;
+            entry.texture = new Texture(path.c_str(), GL_RGB, type, async);
+            entry.refs = 1;
+            textures_.insert(std::make_pair(path, entry));
+            return entry.texture;
+        }
+
+        /**
+         * ******************************************************
+         * Drop a reference, the last one deletes the texture
+         *
+         * @param[in] texture       - from acquire()
+         * ******************************************************
+        **/
+        void release(Texture* texture)
+        {
+            auto found = textures_.find(texture->getPath());
+            if (found == textures_.end() || found->second.texture != texture) {
+                LOG(L_ERR, "Releasing a texture the manager doesn't hold: %s.", texture->getPath().c_str());
+                return;
+            }
+            if (--found->second.refs == 0) {
+                reloadQueue_.erase(std::remove(reloadQueue_.begin(), reloadQueue_.end(), texture), reloadQueue_.end());
+                delete texture;
+                textures_.erase(found);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Mark a texture as used this frame, queueing a reload if
+         * it was evicted. Called for every bind by the draws, no
+         * GL calls.
+         * ******************************************************
+        **/
+        void touch(Texture* texture)
+        {
+            /* Once a frame is enough */
+            if (texture->getLastUse() == frame_) return;
+            texture->setLastUse(frame_);
+            if (texture->isEvicted() && !texture->isPending()) reloadQueue_.push_back(texture);
+        }
+
+        /**
+         * ******************************************************
+         * Start a frame, reload what the last one touched and
+         * evict down to the budget. Call once per frame on the
+         * context thread, before the draws.
+         * ******************************************************
+        **/
+        void update()
+        {
+            for (size_t i = 0; i < reloadQueue_.size(); i++) {
+                Texture* texture = reloadQueue_[i];
+                if (!texture->isEvicted() || texture->isPending()) continue;
+                texture->reload();
+                reloads_++;
+            }
+            reloadQueue_.clear();
+
+            frame_++;
+
+            size_t resident = 0;
+            std::vector<Texture*> idle;
+            for (auto it = textures_.begin(); it != textures_.end(); ++it) {
+                Texture* texture = it->second.texture;
+                resident += texture->getBytes();
+                if (!texture->isEvicted() && !texture->isPending() && texture->getLastUse() + TM_KEEP_FRAMES < frame_) {
+                    idle.push_back(texture);
+                }
+            }
+            if (resident <= budget_) return;
+
+            /* Least recently used first */
+            std::sort(idle.begin(), idle.end(),
+                    [](Texture* a, Texture* b) { return a->getLastUse() < b->getLastUse(); });
+
+            uint32_t evicted = 0;
+            for (size_t i = 0; i < idle.size() && resident > budget_; i++) {
+                size_t bytes = idle[i]->getBytes();
+                if (!idle[i]->evict()) continue;
+                resident -= bytes - idle[i]->getBytes();
+                evicted++;
+            }
+            evictions_ += evicted;
+
+            if (evicted != 0) {
+                LOG(L_DBG, "Evicted %u textures, %lu KiB resident of %lu KiB.", evicted,
+                        (unsigned long)(resident / 1024), (unsigned long)(budget_ / 1024));
+            }
+        }
+
+        /**
+         * ******************************************************
+         * VRAM budget in bytes, applied from the next update()
+         * ******************************************************
+        **/
+        void setBudget(size_t budget) { budget_ = budget; }
+        size_t getBudget() { return budget_; }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        TextureManagerStats getStats()
+        {
+            TextureManagerStats stats;
+            stats.textures = textures_.size();
+            stats.evicted = 0;
+            stats.residentBytes = 0;
+            for (auto it = textures_.begin(); it != textures_.end(); ++it) {
+                stats.residentBytes += it->second.texture->getBytes();
+                if (it->second.texture->isEvicted()) stats.evicted++;
+            }
+            stats.budget = budget_;
+            stats.evictions = evictions_;
+            stats.reloads = reloads_;
+            return stats;
+        }
+
+        void resetStats()
+        {
+            evictions_ = 0;
+            reloads_ = 0;
+        }
+
+        uint64_t getFrame() { return frame_; }
+
+    private: /* Types */
+        struct Entry {
+            Texture     *texture;
+            uint32_t    refs;
+        };
+
+    private: /* Members */
+        std::unordered_map<std::string, Entry>  textures_;  /* By path */
+        size_t                                  budget_;    /* Bytes */
+        uint64_t                                frame_;     /* update() calls */
+        uint64_t                                evictions_; /* Since resetStats() */
+        uint64_t                                reloads_;   /* Since resetStats() */
+        std::vector<Texture*>                   reloadQueue_; /* Touched while evicted, for update() */
+};
+
+#endif
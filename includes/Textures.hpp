@@ -23,6 +23,21 @@
 #define STB_IMAGE_IMPLEMENTATION 1
 #include <stb_image.h>
 
+/* STD */
+#include <vector>
+#include <string>
+
+/* POSIX */
+#include <sys/stat.h>
+
+#include "GLState.hpp"
+#include "DDSFile.hpp"
+#include "TextureLoader.hpp"
+#include "PixelUploadRing.hpp"
+
+#define TEXTURE_MIP_FILTER  MF_KAISER   /* MF_BOX is what glGenerateMipmap did, minus the sRGB */
+#define TEXTURE_EVICT_SIZE  64          /* Levels this small stay in RAM, evict() falls back to them */
+
 /**
  * ******************************************************
  * @brief Textures class
@@ -38,10 +53,15 @@ class Texture {
          * @param[in] path          - texture file path
          * @param[in] pixelDataFormat TODO should I remove this? is this determined by nrChannels?
          * @param[in] type          - texture type, save as string 
+         * @param[in] async         - decode on the TextureLoader; a 1x1
+         *                            placeholder is bound until the
+         *                            context thread polls the upload
          * ******************************************************
         **/
-        Texture(const char* path, uint32_t pixelDataFormat, std::string type) :
-            path_(path), pixelDataFormat_(pixelDataFormat), type_(type)
+        Texture(const char* path, uint32_t pixelDataFormat, std::string type, bool async = false) :
+            path_(path), ticket_(0), pixelDataFormat_(pixelDataFormat), type_(type),
+            width_(0), height_(0), levels_(0), bytes_(0), lastUse_(0), evicted_(false),
+            tailLevel_(0), tailFormat_(0), tailCompressed_(false)
         {
             if (type_.empty()) {
                 LOG(L_CRIT, "Texture needs a name.");
@@ -49,7 +69,7 @@ class Texture {
             }
 
             LOG(L_DBG, "Pixel Data Format: %d, %s", pixelDataFormat_, type_.c_str());
-            createTexture(path_.c_str());
+            createTexture(path_.c_str(), async);
         }
 
         /**
@@ -59,8 +79,9 @@ class Texture {
         **/
         ~Texture()
         {
-            //stbi_image_free(data_);       // TODO this proved to be a bad idea already a few times now
-            //glDeleteTextures(1, &handler_); // TODO If this stays, textures need to be global
+            if (ticket_ != 0) TextureLoader::get().cancel(ticket_);
+            glDeleteTextures(1, &handler_);
+            GLState::get().forgetTexture(handler_);
         }
 
     public: /* Methods */
@@ -76,8 +97,7 @@ class Texture {
                 exit(1);
             }
             /* Bind textures */
-            glActiveTexture(GL_TEXTURE0 + unit);
-            glBindTexture(GL_TEXTURE_2D, handler_);
+            GLState::get().bindTexture(unit, handler_);
         }
 
         /**
@@ -89,62 +109,369 @@ class Texture {
         std::string getType() { return type_; }
         const char* getTypeCstr() { return type_.c_str(); }
 
+        /* Holds sRGB encoded color, the rest (normals, heights, specular) is linear data */
+        bool isColor() { return type_ == "diffuse" || type_ == "ambient" || type_ == "emissive"; }
+
+        /* Still showing the placeholder, or the tail of an evicted texture */
+        bool isPending() { return ticket_ != 0; }
+
+        const std::string& getPath() { return path_; }
+        uint32_t getWidth() { return width_; }
+        uint32_t getHeight() { return height_; }
+        uint32_t getLevelCount() { return levels_; }
+
+        /**
+         * ******************************************************
+         * Residency, see TextureManager
+         * ******************************************************
+        **/
+        /* Estimated VRAM of the levels uploaded now, RGB counted as RGBA */
+        size_t getBytes() { return bytes_; }
+        bool isEvicted() { return evicted_; }
+        uint64_t getLastUse() { return lastUse_; }
+        void setLastUse(uint64_t frame) { lastUse_ = frame; }
+
+        /**
+         * ******************************************************
+         * Drop the levels above TEXTURE_EVICT_SIZE. The kept tail
+         * is uploaded again as the whole chain, same handle.
+         *
+         * @return false if loading, already evicted or too small
+         * ******************************************************
+        **/
+        bool evict()
+        {
+            if (ticket_ != 0 || evicted_ || tail_.empty() || tailLevel_ == 0) return false;
+
+            GLState::get().bindTexture(0, handler_);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            bytes_ = 0;
+            for (uint32_t i = 0; i < tail_.size(); i++) {
+                uint32_t width = levelSize(width_, tailLevel_ + i), height = levelSize(height_, tailLevel_ + i);
+                if (tailCompressed_) {
+                    glCompressedTexImage2D(GL_TEXTURE_2D, i, tailFormat_, width, height, 0,
+                            tail_[i].size(), tail_[i].data());
+                    bytes_ += tail_[i].size();
+                } else {
+                    glTexImage2D(GL_TEXTURE_2D, i, tailFormat_, width, height, 0,
+                            tailFormat_, GL_UNSIGNED_BYTE, tail_[i].data());
+                    bytes_ += (size_t)width * height * gpuPixelSize(tailFormat_);
+                }
+            }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, tail_.size() - 1);
+
+            evicted_ = true;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Load the full chain of an evicted texture again. The
+         * tail stays bound until the upload.
+         * ******************************************************
+        **/
+        void reload()
+        {
+            if (!evicted_ || ticket_ != 0) return;
+            if (!loadCompressed()) loadAsync();
+        }
+
     private: /* Methods */
         /**
          * ******************************************************
          * Create Textures
          *
          * @param[in] path
+         * @param[in] async         - decode on the TextureLoader
          * ******************************************************
          */
-        void createTexture(const char* path)
+        void createTexture(const char* path, bool async)
         {
             /* Generate textures */
             glGenTextures(1 /* Generate one texture */, &handler_);
-            glBindTexture(GL_TEXTURE_2D, handler_);
+            GLState::get().bindTexture(0, handler_);
 
             /* Set texture wraping parameters */
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-            /* Set texture filtering parameters */
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+            if (loadCompressed()) return;
+
+            if (async) {
+                /* Same handle before and after, meshes and sort keys never see the swap */
+                createPlaceholder();
+                loadAsync();
+                return;
+            }
+
             /* Load file */
-            int width, height, nrChannels;
+            DecodedImage image;
+            image.mips = NULL;
             stbi_set_flip_vertically_on_load(true);
-            data_ = stbi_load(path, &width, &height, &nrChannels, 0);
-            GLenum format;
-            if (nrChannels == 1) format = GL_RED;
-            else if (nrChannels == 3) format = GL_RGB;
-            else if (nrChannels == 4) format = GL_RGBA;
-
-            if (data_) {
-                glTexImage2D(
-                        GL_TEXTURE_2D,      // Texture target
-                        0,                  // Mipmap level. Level of detail.
-                        format,             // Internal format. Number of color components
-                        width,              // Width of teture image
-                        height,             // Height of texture image
-                        0,                  // Legacy. Must be 0.
-                        format,             // Format of pixel data
-                        GL_UNSIGNED_BYTE,   // Data type of pixel data
-                        data_);             // Pointer to binary image
-                glGenerateMipmap(GL_TEXTURE_2D);
-                stbi_image_free(data_); // Freeing here proved safer than in destr.
+            image.data = stbi_load(path, &image.width, &image.height, &image.channels, 0);
+            if (image.data) {
+                upload(image);
             } else {
                 LOG(L_ERR, "Could not open texture: %s!", path);
-                stbi_image_free(data_); // Freeing here proved safer than in destr.
+                createPlaceholder();
+            }
+            stbi_image_free(image.data); // Freeing here proved safer than in destr.
+        }
+
+        /**
+         * ******************************************************
+         * A DDS from tools/texcompress next to the image wins,
+         * it's only read, never decoded
+         *
+         * @return false if there is none or it can't be used
+         * ******************************************************
+        **/
+        bool loadCompressed()
+        {
+            std::string compressed = compressedPath(path_);
+            return !compressed.empty() && createCompressed(compressed.c_str());
+        }
+
+        /**
+         * ******************************************************
+         * Queue the image on the TextureLoader, upload() swaps
+         * it in
+         * ******************************************************
+        **/
+        void loadAsync()
+        {
+            ticket_ = TextureLoader::get().load(path_, [this](const DecodedImage& image) {
+                ticket_ = 0;
+                upload(image);
+            }, TEXTURE_MIP_FILTER, isColor());
+        }
+
+        /**
+         * ******************************************************
+         * The DDS to load instead of the image, empty if none
+         * ******************************************************
+        **/
+        static std::string compressedPath(const std::string& path)
+        {
+            size_t dot = path.find_last_of('.');
+            if (dot == std::string::npos) return std::string();
+            if (path.compare(dot, std::string::npos, ".dds") == 0) return path;
+
+            std::string dds = path.substr(0, dot) + ".dds";
+            struct stat st;
+            return stat(dds.c_str(), &st) == 0 ? dds : std::string();
+        }
+
+        /**
+         * ******************************************************
+         * Upload the blocks and mip chain of a DDS as they are
+         *
+         * @param[in] path
+         *
+         * @return false if unreadable or the format isn't
+         *         supported here, the image is loaded instead
+         * ******************************************************
+        **/
+        bool createCompressed(const char* path)
+        {
+            DDSFile dds;
+            if (!dds.read(path)) return false;
+
+            GLenum format;
+            bool supported;
+            switch (dds.getFormat()) {
+                case BF_BC1: format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;  supported = GLEW_EXT_texture_compression_s3tc; break;
+                case BF_BC3: format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; supported = GLEW_EXT_texture_compression_s3tc; break;
+                case BF_BC5: format = GL_COMPRESSED_RG_RGTC2;           supported = true; break; /* Core since 3.0 */
+                case BF_BC7: format = GL_COMPRESSED_RGBA_BPTC_UNORM;    supported = GLEW_ARB_texture_compression_bptc; break;
+                default:     return false;
+            }
+            if (!supported) {
+                LOG(L_ERR, "%s: block format BC%d not supported.", path, dds.getFormat());
+                return false;
+            }
+
+            GLState::get().bindTexture(0, handler_);
+            for (uint32_t level = 0; level < dds.getLevelCount(); level++) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, level, format,
+                        dds.getLevelWidth(level), dds.getLevelHeight(level), 0,
+                        dds.getLevelSize(level), dds.getLevel(level));
+            }
+
+            resident(dds.getWidth(), dds.getHeight(), dds.getLevelCount(), format, true);
+            for (uint32_t level = 0; level < dds.getLevelCount(); level++) {
+                bytes_ += dds.getLevelSize(level);
+                keepTail(level, dds.getLevel(level), dds.getLevelSize(level));
+            }
+
+            /* A chain cut short is still complete */
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, dds.getLevelCount() - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    dds.getLevelCount() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+            LOG(L_DBG, "Texture %s: BC%d %ux%u, %u levels, %lu KiB.", path, dds.getFormat(),
+                    dds.getWidth(), dds.getHeight(), dds.getLevelCount(), (unsigned long)(dds.getSize() / 1024));
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * A single white texel, complete without mipmaps
+         * ******************************************************
+        **/
+        void createPlaceholder()
+        {
+            static const uint8_t white[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+            resident(1, 1, 1, GL_RGBA, false);
+            bytes_ = sizeof(white);
+        }
+
+        /**
+         * ******************************************************
+         * Upload decoded pixels and their mip chain, built here
+         * if the loader didn't
+         *
+         * @param[in] image
+         * ******************************************************
+        **/
+        void upload(const DecodedImage& image)
+        {
+            if (image.data == NULL) {
+                /* Keeps the placeholder, or the tail for good if the file went away */
+                evicted_ = false;
+                return;
+            }
+
+            GLenum format;
+            if (image.channels == 1)        format = GL_RED;
+            else if (image.channels == 2)   format = GL_RG;
+            else if (image.channels == 3)   format = GL_RGB;
+            else                            format = GL_RGBA;
+
+            MipChain local, *mips = image.mips;
+            if (mips == NULL) {
+                local.build(image.data, image.width, image.height, image.channels, TEXTURE_MIP_FILTER, isColor());
+                mips = &local;
+            }
+
+            GLState::get().bindTexture(0, handler_);
+            uploadLevel(0, image.width, image.height, format, image.channels, image.data);
+            for (uint32_t level = 1; level < mips->getLevelCount(); level++) {
+                uploadLevel(level, mips->getLevelWidth(level), mips->getLevelHeight(level),
+                        format, image.channels, mips->getLevel(level));
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mips->getLevelCount() - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+            resident(image.width, image.height, mips->getLevelCount(), format, false);
+            for (uint32_t level = 0; level < mips->getLevelCount(); level++) {
+                uint32_t width = mips->getLevelWidth(level), height = mips->getLevelHeight(level);
+                bytes_ += (size_t)width * height * gpuPixelSize(format);
+                keepTail(level, level == 0 ? image.data : mips->getLevel(level),
+                        (size_t)width * height * image.channels);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Start the bookkeeping of a fresh upload, full chain
+         * ******************************************************
+        **/
+        void resident(uint32_t width, uint32_t height, uint32_t levels, GLenum format, bool compressed)
+        {
+            width_ = width;
+            height_ = height;
+            levels_ = levels;
+            bytes_ = 0;
+            evicted_ = false;
+            tail_.clear();
+            tailLevel_ = 0;
+            tailFormat_ = format;
+            tailCompressed_ = compressed;
+        }
+
+        /**
+         * ******************************************************
+         * Keep a copy of a level if it's small enough to evict to
+         * ******************************************************
+        **/
+        void keepTail(uint32_t level, const uint8_t* data, size_t size)
+        {
+            uint32_t width = levelSize(width_, level), height = levelSize(height_, level);
+            if (width > TEXTURE_EVICT_SIZE || height > TEXTURE_EVICT_SIZE) return;
+            if (tail_.empty()) tailLevel_ = level;
+            tail_.push_back(std::vector<uint8_t>(data, data + size));
+        }
+
+        static uint32_t levelSize(uint32_t size, uint32_t level) { return (size >> level) ? (size >> level) : 1; }
+
+        /* Drivers pad RGB8 to four bytes */
+        static uint32_t gpuPixelSize(GLenum format)
+        {
+            switch (format) {
+                case GL_RED:    return 1;
+                case GL_RG:     return 2;
+                default:        return 4;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Upload one level of the bound texture
+         *
+         * @param[in] level
+         * @param[in] width
+         * @param[in] height
+         * @param[in] format
+         * @param[in] pixelSize     - bytes per pixel
+         * @param[in] pixels        - tightly packed rows
+         * ******************************************************
+        **/
+        void uploadLevel(int level, int width, int height, GLenum format, uint32_t pixelSize, const uint8_t* pixels)
+        {
+            /* Staged through the ring the storage is allocated empty and filled from there */
+            PixelUploadRing & ring = PixelUploadRing::get();
+            bool staged = ring.isEnabled();
+
+            /* Rows of odd sized RGB levels aren't 4 byte aligned */
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(
+                    GL_TEXTURE_2D,      // Texture target
+                    level,              // Mipmap level. Level of detail.
+                    format,             // Internal format. Number of color components
+                    width,              // Width of teture image
+                    height,             // Height of texture image
+                    0,                  // Legacy. Must be 0.
+                    format,             // Format of pixel data
+                    GL_UNSIGNED_BYTE,   // Data type of pixel data
+                    staged ? NULL : pixels); // Pointer to binary image
+            if (staged && !ring.upload(level, width, height, format, pixelSize, pixels)) {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
             }
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         }
 
     private: /* Members */
         std::string     path_;              /* Path to texture */
-        uint8_t         *data_;             /* Binary image data */
+        uint32_t        ticket_;            /* TextureLoader ticket, 0 once uploaded */
         uint32_t        handler_;           /* Texture handler */
         uint32_t        pixelDataFormat_;   /* Pixel data format */
         std::string     type_;              /* Texture type */
+        uint32_t        width_;             /* Level 0 of the full chain */
+        uint32_t        height_;            /* Level 0 of the full chain */
+        uint32_t        levels_;            /* Levels of the full chain */
+        size_t          bytes_;             /* Estimated VRAM now */
+        uint64_t        lastUse_;           /* TextureManager frame of the last bind */
+        bool            evicted_;           /* Only the tail is uploaded */
+        std::vector<std::vector<uint8_t>> tail_; /* CPU copy of the levels evict() keeps */
+        uint32_t        tailLevel_;         /* Full chain level of tail_[0] */
+        GLenum          tailFormat_;        /* Pixel format, or block format if compressed */
+        bool            tailCompressed_;    /* tail_ holds blocks */
 };
 
 /**
@@ -0,0 +1,191 @@
+/******************************************
+
+* File Name : includes/ThreadPool.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * A small worker pool for CPU side loading work (mesh extraction,
+ * image decoding). Nothing in here may touch GL; the results are
+ * handed back to the context thread.
+ */
+
+#ifndef _LOGL_THREAD_POOL_HPP_
+#define _LOGL_THREAD_POOL_HPP_
+
+/* STD */
+#include <vector>
+#include <queue>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+#include "Utils.hpp"
+
+/**
+ * ******************************************************
+ * @brief Thread pool
+ * ******************************************************
+**/
+class ThreadPool {
+    public: /* Constructors */
+        /**
+         * ******************************************************
+         * Constructor
+         *
+         * @param[in] threads       - number of workers, 0 for one per core
+         * ******************************************************
+        **/
+        ThreadPool(uint32_t threads = 0) :
+            stop_(false)
+        {
+            if (threads == 0) threads = std::thread::hardware_concurrency();
+            if (threads == 0) threads = 2;
+
+            LOG(L_DBG, "Starting thread pool with %u workers.", threads);
+            for (uint32_t i = 0; i < threads; i++) {
+                workers_.push_back(std::thread(&ThreadPool::work, this));
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Destructor. Finishes the queued tasks and joins.
+         * ******************************************************
+        **/
+        ~ThreadPool()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for (uint32_t i = 0; i < workers_.size(); i++) {
+                workers_[i].join();
+            }
+        }
+
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * The pool shared by the loaders
+         * ******************************************************
+        **/
+        static ThreadPool& global()
+        {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        /**
+         * ******************************************************
+         * Queue a task
+         *
+         * @param[in] task
+         * ******************************************************
+        **/
+        void enqueue(std::function<void()> task)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                tasks_.push(task);
+            }
+            cv_.notify_one();
+        }
+
+        /**
+         * ******************************************************
+         * Run fn(0) ... fn(count-1) on the pool and wait for all
+         * of them. The calling thread takes part in the work, so
+         * this never waits on a worker busy with something else.
+         *
+         * @param[in] count         - number of items
+         * @param[in] fn            - called once per item index
+         * ******************************************************
+        **/
+        void parallelFor(uint32_t count, std::function<void(uint32_t)> fn)
+        {
+            if (count == 0) return;
+
+            /* Shared with the helpers, which may start after we return */
+            std::shared_ptr<ParallelFor> job(new ParallelFor(count, fn));
+
+            uint32_t helpers = std::min<uint32_t>(workers_.size(), count - 1);
+            for (uint32_t i = 0; i < helpers; i++) {
+                enqueue([job]() { job->run(); });
+            }
+            job->run();
+
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->cv.wait(lock, [&job]() { return job->finished == job->count; });
+        }
+
+        uint32_t size() { return workers_.size(); }
+
+    private: /* Types */
+        struct ParallelFor {
+            ParallelFor(uint32_t c, std::function<void(uint32_t)> f) :
+                count(c), fn(f), next(0), finished(0) {}
+
+            void run()
+            {
+                uint32_t i;
+                while ((i = next++) < count) {
+                    fn(i);
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (++finished == count) cv.notify_all();
+                }
+            }
+
+            uint32_t                        count;
+            std::function<void(uint32_t)>   fn;
+            std::atomic<uint32_t>           next;
+            uint32_t                        finished;
+            std::mutex                      mutex;
+            std::condition_variable         cv;
+        };
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Worker loop
+         * ******************************************************
+        **/
+        void work()
+        {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                    if (stop_ && tasks_.empty()) return;
+                    task = tasks_.front();
+                    tasks_.pop();
+                }
+                task();
+            }
+        }
+
+    private: /* Members */
+        std::vector<std::thread>            workers_;   /* Workers */
+        std::queue<std::function<void()>>   tasks_;     /* Pending tasks */
+        std::mutex                          mutex_;     /* Guards tasks_ and stop_ */
+        std::condition_variable             cv_;        /* Signals new tasks */
+        bool                                stop_;      /* Shutting down */
+};
+
+#endif
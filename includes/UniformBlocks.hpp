@@ -0,0 +1,150 @@
+/******************************************
+
+* File Name : includes/UniformBlocks.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * C++ mirrors of the std140 uniform blocks declared in the shaders.
+ * std140 aligns vec3 (and structs) to 16 bytes, so the vec3 members
+ * are padded by hand. The static_asserts make sure the offsets match
+ * what the GLSL side expects; change both sides together.
+ */
+
+#ifndef _LOGL_UNIFORM_BLOCKS_HPP_
+#define _LOGL_UNIFORM_BLOCKS_HPP_
+
+/* STD */
+#include <stddef.h>
+
+#include <glm.hpp>
+
+/**
+ * ******************************************************
+ * Uniform block binding points
+ * ******************************************************
+**/
+typedef enum {
+    UBO_CAMERA      = 0,    /* "Camera" block */
+    UBO_LIGHTS      = 1,    /* "Lights" block */
+} UniformBlockBinding;
+
+static_assert(sizeof(glm::vec3) == 12, "glm::vec3 must be tightly packed");
+static_assert(sizeof(glm::mat4) == 64, "glm::mat4 must be tightly packed");
+
+/**
+ * ******************************************************
+ * layout(std140) uniform Camera
+ * ******************************************************
+**/
+struct CameraBlock {
+    glm::mat4   view;
+    glm::mat4   vp;
+    glm::mat4   mov;
+    glm::mat4   mvp;
+};
+
+static_assert(offsetof(CameraBlock, view) == 0,     "std140 Camera.view");
+static_assert(offsetof(CameraBlock, vp)   == 64,    "std140 Camera.vp");
+static_assert(offsetof(CameraBlock, mov)  == 128,   "std140 Camera.mov");
+static_assert(offsetof(CameraBlock, mvp)  == 192,   "std140 Camera.mvp");
+static_assert(sizeof(CameraBlock)         == 256,   "std140 Camera size");
+
+/**
+ * ******************************************************
+ * struct DirectionalLight
+ * ******************************************************
+**/
+struct DirectionalLightStd140 {
+    glm::vec3   direction;  float pad0;
+    glm::vec3   ambient;    float pad1;
+    glm::vec3   diffuse;    float pad2;
+    glm::vec3   specular;   float pad3;
+};
+
+static_assert(offsetof(DirectionalLightStd140, direction) == 0,  "std140 DirectionalLight.direction");
+static_assert(offsetof(DirectionalLightStd140, ambient)   == 16, "std140 DirectionalLight.ambient");
+static_assert(offsetof(DirectionalLightStd140, diffuse)   == 32, "std140 DirectionalLight.diffuse");
+static_assert(offsetof(DirectionalLightStd140, specular)  == 48, "std140 DirectionalLight.specular");
+static_assert(sizeof(DirectionalLightStd140)              == 64, "std140 DirectionalLight size");
+
+/**
+ * ******************************************************
+ * struct Light. The scalars pack into the tail of specular.
+ * ******************************************************
+**/
+struct LightStd140 {
+    glm::vec3   position;   float pad0;
+    glm::vec3   ambient;    float pad1;
+    glm::vec3   diffuse;    float pad2;
+    glm::vec3   specular;
+    float       constant;
+    float       linear;
+    float       quadratic;
+    float       pad3[2];
+};
+
+static_assert(offsetof(LightStd140, position)  == 0,  "std140 Light.position");
+static_assert(offsetof(LightStd140, ambient)   == 16, "std140 Light.ambient");
+static_assert(offsetof(LightStd140, diffuse)   == 32, "std140 Light.diffuse");
+static_assert(offsetof(LightStd140, specular)  == 48, "std140 Light.specular");
+static_assert(offsetof(LightStd140, constant)  == 60, "std140 Light.constant");
+static_assert(offsetof(LightStd140, linear)    == 64, "std140 Light.linear");
+static_assert(offsetof(LightStd140, quadratic) == 68, "std140 Light.quadratic");
+static_assert(sizeof(LightStd140)              == 80, "std140 Light size");
+
+/**
+ * ******************************************************
+ * struct Spotlight
+ * ******************************************************
+**/
+struct SpotlightStd140 {
+    glm::vec3   position;   float pad0;
+    glm::vec3   direction;  float pad1;
+    glm::vec3   diffuse;    float pad2;
+    glm::vec3   specular;
+    float       cutOff;
+    float       outerCutOff;
+    float       constant;
+    float       linear;
+    float       quadratic;
+};
+
+static_assert(offsetof(SpotlightStd140, position)    == 0,  "std140 Spotlight.position");
+static_assert(offsetof(SpotlightStd140, direction)   == 16, "std140 Spotlight.direction");
+static_assert(offsetof(SpotlightStd140, diffuse)     == 32, "std140 Spotlight.diffuse");
+static_assert(offsetof(SpotlightStd140, specular)    == 48, "std140 Spotlight.specular");
+static_assert(offsetof(SpotlightStd140, cutOff)      == 60, "std140 Spotlight.cutOff");
+static_assert(offsetof(SpotlightStd140, outerCutOff) == 64, "std140 Spotlight.outerCutOff");
+static_assert(offsetof(SpotlightStd140, constant)    == 68, "std140 Spotlight.constant");
+static_assert(offsetof(SpotlightStd140, linear)      == 72, "std140 Spotlight.linear");
+static_assert(offsetof(SpotlightStd140, quadratic)   == 76, "std140 Spotlight.quadratic");
+static_assert(sizeof(SpotlightStd140)                == 80, "std140 Spotlight size");
+
+/**
+ * ******************************************************
+ * layout(std140) uniform Lights
+ * ******************************************************
+**/
+struct LightsBlock {
+    DirectionalLightStd140  dirLight;
+    LightStd140             light;
+    SpotlightStd140         spotlight;
+};
+
+static_assert(offsetof(LightsBlock, dirLight)  == 0,   "std140 Lights.dirLight");
+static_assert(offsetof(LightsBlock, light)     == 64,  "std140 Lights.light");
+static_assert(offsetof(LightsBlock, spotlight) == 144, "std140 Lights.spotlight");
+static_assert(sizeof(LightsBlock)              == 224, "std140 Lights size");
+
+#endif
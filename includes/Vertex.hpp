@@ -0,0 +1,34 @@
+/******************************************
+
+* File Name : includes/Vertex.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * The vertex layout of every mesh, shared by Mesh, the MeshCache
+ * and the MeshArena. Attribute 0 is the position, 1 the normal and
+ * 2 the texture coordinates.
+ */
+
+#ifndef _LOGL_VERTEX_HPP_
+#define _LOGL_VERTEX_HPP_
+
+#include <glm.hpp>
+
+struct Vertex {
+    glm::vec3 pos_;
+    glm::vec3 normal_;
+    glm::vec2 texCoords_;
+};
+
+#endif
@@ -0,0 +1,615 @@
+/******************************************
+
+* File Name : includes/VirtualTexture.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Virtual texturing for images too large to load whole. The tiles of
+ * a page file (see PageFile, tools/vttiler) are streamed into a cache
+ * texture of fixed size slots, only the ones the camera needs.
+ *
+ * Each frame:
+ *  - The objects are drawn into a small feedback buffer with the
+ *    VT_FEEDBACK shader, every fragment writes the tile it samples.
+ *  - update() reads the buffer of the previous frame back (through a
+ *    pixel pack buffer, no stall), requests the tiles it names and
+ *    their parents, reads the missing ones on the ThreadPool, uploads
+ *    at most maxUploads of them into free or least recently used
+ *    slots and patches the indirection texture.
+ *  - The shader looks each fragment up in the indirection, a mip chain
+ *    with one texel per tile, which points at the slot holding the
+ *    tile or its nearest resident parent.
+ *
+ * The single tile of the last level is loaded up front and never
+ * evicted, every lookup finds at least that one.
+ */
+
+#ifndef _LOGL_VIRTUAL_TEXTURE_HPP_
+#define _LOGL_VIRTUAL_TEXTURE_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* STD */
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <glm.hpp>
+
+#include "Utils.hpp"
+#include "GLState.hpp"
+#include "ThreadPool.hpp"
+#include "PixelUploadRing.hpp"
+#include "PageFile.hpp"
+#include "Program.hpp"
+
+#define VT_CACHE_PAGES          16      /* Slots per cache side, 16x16 pages of 136 texels is 18 MiB */
+#define VT_UPLOADS_PER_FRAME    8       /* Tiles uploaded into the cache per update() */
+#define VT_LOADS_IN_FLIGHT      32      /* Tile reads queued on the ThreadPool */
+#define VT_FEEDBACK_SCALE       8       /* The feedback buffer is the viewport / 8 */
+#define VT_MAX_LEVELS           13      /* 12 bits of tile coordinates in the feedback */
+
+/**
+ * ******************************************************
+ * Streaming counters. Uploads, evictions and drops add up
+ * until reset, the rest is the current state.
+ * ******************************************************
+**/
+struct VirtualTextureStats {
+    uint32_t    requested;  /* Tiles the last feedback asked for, parents included */
+    uint32_t    resident;   /* Slots in use */
+    uint32_t    loading;    /* Reads on the ThreadPool or waiting for an upload */
+    uint64_t    uploads;
+    uint64_t    evictions;
+    uint64_t    dropped;    /* Loads with no slot to go in, every slot was in use */
+};
+
+/**
+ * ******************************************************
+ * @brief Tile streamed virtual texture
+ * ******************************************************
+**/
+class VirtualTexture {
+    public: /* Constructors */
+        /**
+         * ******************************************************
+         * Constructor. Opens the page file and loads its last
+         * level, check isValid().
+         *
+         * @param[in] path          - page file
+         * @param[in] cachePages    - cache slots per side, 255 at most
+         * ******************************************************
+        **/
+        VirtualTexture(const char* path, uint32_t cachePages = VT_CACHE_PAGES) :
+            cache_(0), indirection_(0), feedbackFbo_(0), feedbackColor_(0), feedbackDepth_(0),
+            feedbackWidth_(0), feedbackHeight_(0), feedbackFrames_(0), inFeedback_(false),
+            cachePages_(cachePages > 255 ? 255 : cachePages), frame_(0), inFlight_(0),
+            stream_(new Stream())
+        {
+            memset(feedbackPbos_, 0, sizeof(feedbackPbos_));
+            memset(&stats_, 0, sizeof(stats_));
+            PageFile & file = stream_->file;
+            if (!file.open(path)) return;
+            if (file.getLevelCount() > VT_MAX_LEVELS) {
+                LOG(L_ERR, "%s has %u levels, the feedback addresses %u.", path, file.getLevelCount(), VT_MAX_LEVELS);
+                file.close();
+                return;
+            }
+
+            state_.assign(file.getTileCount(), VT_NOT_RESIDENT);
+            requested_.assign(file.getTileCount(), 0);
+            slots_.resize(cachePages_ * cachePages_);
+            for (uint32_t slot = 0; slot < slots_.size(); slot++) {
+                slots_[slot].tile = -1;
+                slots_[slot].lastUse = 0;
+                free_.push_back(slots_.size() - 1 - slot);
+            }
+
+            /* Cache, no mips: the indirection picks the level */
+            uint32_t cacheSize = cachePages_ * file.getPageSize();
+            glGenTextures(1, &cache_);
+            GLState::get().bindTexture(0, cache_);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+            /* Indirection, a texel per tile, read with texelFetch */
+            entries_.resize(file.getLevelCount());
+            glGenTextures(1, &indirection_);
+            GLState::get().bindTexture(0, indirection_);
+            for (uint32_t level = 0; level < file.getLevelCount(); level++) {
+                uint32_t tiles = file.getTilesPerSide(level);
+                entries_[level].assign(tiles * tiles, 0);
+                glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, tiles, tiles, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, file.getLevelCount() - 1);
+
+            /* The root tile, pinned */
+            std::shared_ptr<TileLoad> root(new TileLoad());
+            root->tile = file.getTileIndex(file.getLevelCount() - 1, 0, 0);
+            root->data.resize(file.getPageBytes());
+            root->ok = file.readTile(root->tile, root->data.data());
+            if (!root->ok) {
+                LOG(L_ERR, "Could not read the root tile of %s.", path);
+                file.close();
+                return;
+            }
+            upload(*root);
+            slots_[state_[root->tile]].lastUse = UINT64_MAX;
+            rebuildIndirection();
+
+            LOG(L_INFO, "Virtual texture %s: %ux%u, %u levels, %u tiles, cache %ux%u pages.", path,
+                    file.getWidth(), file.getHeight(), file.getLevelCount(), file.getTileCount(), cachePages_, cachePages_);
+        }
+
+        /* Reads still queued finish on the shared stream, and are dropped */
+        ~VirtualTexture()
+        {
+            glDeleteTextures(1, &cache_);
+            glDeleteTextures(1, &indirection_);
+            GLState::get().forgetTexture(cache_);
+            GLState::get().forgetTexture(indirection_);
+            if (feedbackFbo_ != 0) {
+                glDeleteFramebuffers(1, &feedbackFbo_);
+                glDeleteRenderbuffers(1, &feedbackColor_);
+                glDeleteRenderbuffers(1, &feedbackDepth_);
+                glDeleteBuffers(2, feedbackPbos_);
+            }
+        }
+
+    public: /* Methods */
+        bool isValid() { return stream_->file.isOpen(); }
+
+        /**
+         * ******************************************************
+         * Redirect the draws into the feedback buffer, which is
+         * (re)created for the current viewport. Draw the objects
+         * with the VT_FEEDBACK program, then endFeedback().
+         * ******************************************************
+        **/
+        void beginFeedback()
+        {
+            glGetIntegerv(GL_VIEWPORT, viewport_);
+            glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor_);
+
+            uint32_t width = viewport_[2] / VT_FEEDBACK_SCALE, height = viewport_[3] / VT_FEEDBACK_SCALE;
+            if (width == 0) width = 1;
+            if (height == 0) height = 1;
+            if (width != feedbackWidth_ || height != feedbackHeight_) createFeedback(width, height);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, feedbackFbo_);
+            glViewport(0, 0, feedbackWidth_, feedbackHeight_);
+            /* Alpha 0 is no request */
+            glClearColor(0, 0, 0, 0);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            inFeedback_ = true;
+        }
+
+        /**
+         * ******************************************************
+         * Start reading the feedback back and restore the default
+         * framebuffer. update() picks it up next frame.
+         * ******************************************************
+        **/
+        void endFeedback()
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPbos_[feedbackFrames_ & 1]);
+            glReadPixels(0, 0, feedbackWidth_, feedbackHeight_, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            feedbackFrames_++;
+
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+            glClearColor(clearColor_[0], clearColor_[1], clearColor_[2], clearColor_[3]);
+            inFeedback_ = false;
+        }
+
+        /**
+         * ******************************************************
+         * Stream tiles. Call once per frame on the context thread,
+         * after endFeedback() and before the textured draws.
+         *
+         * @param[in] maxUploads    - tiles uploaded this call
+         * ******************************************************
+        **/
+        void update(uint32_t maxUploads = VT_UPLOADS_PER_FRAME)
+        {
+            if (!isValid()) return;
+            frame_++;
+
+            std::vector<uint32_t> wanted;
+            analyzeFeedback(wanted);
+
+            /* Coarse levels first, a blurry tile now beats a sharp one later. Later levels have higher indices. */
+            std::sort(wanted.begin(), wanted.end(), [](uint32_t a, uint32_t b) { return a > b; });
+
+            /* Only read what can go in a slot; with the cache full of needed tiles the rest waits */
+            uint32_t slots = 0;
+            for (size_t s = 0; s < slots_.size(); s++) {
+                if (slots_[s].lastUse < frame_) slots++;
+            }
+            uint32_t loads = slots > inFlight_ ? slots - inFlight_ : 0;
+            for (size_t i = 0; i < wanted.size() && i < loads && inFlight_ < VT_LOADS_IN_FLIGHT; i++) {
+                requestTile(wanted[i]);
+            }
+
+            std::vector<std::shared_ptr<TileLoad>> ready;
+            {
+                std::unique_lock<std::mutex> lock(stream_->mutex);
+                size_t count = stream_->ready.size() < maxUploads ? stream_->ready.size() : maxUploads;
+                ready.assign(stream_->ready.begin(), stream_->ready.begin() + count);
+                stream_->ready.erase(stream_->ready.begin(), stream_->ready.begin() + count);
+            }
+
+            bool dirty = false;
+            for (size_t i = 0; i < ready.size(); i++) {
+                inFlight_--;
+                if (!ready[i]->ok) {
+                    LOG(L_ERR, "Could not read virtual texture tile %u.", ready[i]->tile);
+                    state_[ready[i]->tile] = VT_MISSING;
+                    continue;
+                }
+                if (upload(*ready[i])) {
+                    dirty = true;
+                } else {
+                    state_[ready[i]->tile] = VT_NOT_RESIDENT;
+                    stats_.dropped++;
+                }
+            }
+            if (dirty) rebuildIndirection();
+        }
+
+        /**
+         * ******************************************************
+         * Bind the cache and the indirection and set the lookup
+         * uniforms of a virtualTexture.fs program, either version.
+         *
+         * @param[in] program
+         * @param[in] unit          - cache unit, the indirection
+         *                            goes in the next one
+         * ******************************************************
+        **/
+        void bind(Program & program, uint32_t unit)
+        {
+            PageFile & file = stream_->file;
+            const Uniforms & uniforms = getUniforms(program);
+            GLState::get().bindTexture(unit, cache_);
+            GLState::get().bindTexture(unit + 1, indirection_);
+            program.setInt(uniforms.cache, unit);
+            program.setInt(uniforms.indirection, unit + 1);
+            program.setVec4(uniforms.info, (float)file.getVirtualSize(), (float)file.getLevelCount(),
+                    (float)file.getTileSize(), (float)file.getBorder());
+            program.setVec2(uniforms.scale, (float)file.getWidth() / file.getVirtualSize(),
+                    (float)file.getHeight() / file.getVirtualSize());
+            program.setFloat(uniforms.cacheSize, (float)(cachePages_ * file.getPageSize()));
+            /* The feedback pixels are larger, their level would be too coarse */
+            program.setFloat(uniforms.lodBias, inFeedback_ ? -log2f((float)VT_FEEDBACK_SCALE) : 0.0f);
+        }
+
+        /**
+         * ******************************************************
+         * Getters
+         * ******************************************************
+        **/
+        VirtualTextureStats getStats()
+        {
+            stats_.resident = slots_.size() - free_.size();
+            stats_.loading = inFlight_;
+            return stats_;
+        }
+
+        void resetStats()
+        {
+            stats_.uploads = 0;
+            stats_.evictions = 0;
+            stats_.dropped = 0;
+        }
+
+    private: /* Types */
+        enum TileState {
+            VT_NOT_RESIDENT = -1,
+            VT_LOADING      = -2,
+            VT_MISSING      = -3,   /* Read failed, not asked for again */
+        };
+
+        struct Slot {
+            int64_t     tile;       /* -1 if free */
+            uint64_t    lastUse;    /* Frame, UINT64_MAX for the root */
+        };
+
+        struct TileLoad {
+            uint32_t                tile;
+            bool                    ok;
+            std::vector<uint8_t>    data;
+        };
+
+        /* Lookup uniforms of one program */
+        struct Uniforms {
+            uint32_t        program;
+            UniformHandle   cache;          /* vtCache */
+            UniformHandle   indirection;    /* vtIndirection */
+            UniformHandle   info;           /* vtInfo */
+            UniformHandle   scale;          /* vtScale */
+            UniformHandle   cacheSize;      /* vtCacheSize */
+            UniformHandle   lodBias;        /* vtLodBias */
+        };
+
+        /* Outlives the VirtualTexture while reads are queued */
+        struct Stream {
+            PageFile                                file;
+            std::mutex                              mutex;  /* Guards ready */
+            std::vector<std::shared_ptr<TileLoad>>  ready;  /* Read, waiting for update() */
+        };
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Uniform handles of a program, resolved the first time
+         * it is bound with
+         * ******************************************************
+        **/
+        const Uniforms& getUniforms(Program & program)
+        {
+            /* The sampling and the feedback program, a linear scan is enough */
+            for (size_t i = 0; i < uniforms_.size(); i++) {
+                if (uniforms_[i].program == program.getId()) return uniforms_[i];
+            }
+
+            Uniforms uniforms;
+            uniforms.program        = program.getId();
+            uniforms.cache          = program.getUniform("vtCache");
+            uniforms.indirection    = program.getUniform("vtIndirection");
+            uniforms.info           = program.getUniform("vtInfo");
+            uniforms.scale          = program.getUniform("vtScale");
+            uniforms.cacheSize      = program.getUniform("vtCacheSize");
+            uniforms.lodBias        = program.getUniform("vtLodBias");
+            uniforms_.push_back(uniforms);
+            return uniforms_.back();
+        }
+
+        /**
+         * ******************************************************
+         * Create the feedback framebuffer and its read back
+         * buffers
+         * ******************************************************
+        **/
+        void createFeedback(uint32_t width, uint32_t height)
+        {
+            if (feedbackFbo_ == 0) {
+                glGenFramebuffers(1, &feedbackFbo_);
+                glGenRenderbuffers(1, &feedbackColor_);
+                glGenRenderbuffers(1, &feedbackDepth_);
+                glGenBuffers(2, feedbackPbos_);
+            }
+            feedbackWidth_ = width;
+            feedbackHeight_ = height;
+            feedbackFrames_ = 0;
+
+            glBindRenderbuffer(GL_RENDERBUFFER, feedbackColor_);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+            glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth_);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, feedbackFbo_);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, feedbackColor_);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth_);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                LOG(L_ERR, "Virtual texture feedback framebuffer is incomplete.");
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+            for (uint32_t i = 0; i < 2; i++) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPbos_[i]);
+                glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, NULL, GL_STREAM_READ);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        /**
+         * ******************************************************
+         * Collect the tiles the previous feedback names, and their
+         * parents. Resident ones are marked used, the others that
+         * aren't loading yet go into wanted.
+         * ******************************************************
+        **/
+        void analyzeFeedback(std::vector<uint32_t> & wanted)
+        {
+            stats_.requested = 0;
+            /* The buffer written last frame; the one of this frame is still in flight */
+            if (feedbackFrames_ < 2) return;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPbos_[feedbackFrames_ & 1]);
+            const uint8_t* pixels = (const uint8_t*) glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                    (size_t)feedbackWidth_ * feedbackHeight_ * 4, GL_MAP_READ_BIT);
+            if (pixels == NULL) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                return;
+            }
+
+            PageFile & file = stream_->file;
+            size_t count = (size_t)feedbackWidth_ * feedbackHeight_;
+            uint32_t last = UINT32_MAX;
+            for (size_t i = 0; i < count; i++) {
+                const uint8_t* p = pixels + i * 4;
+                if (p[3] == 0) continue;
+
+                uint32_t level = p[3] - 1;
+                uint32_t x = p[0] | ((p[2] & 0x0F) << 8);
+                uint32_t y = p[1] | ((p[2] >> 4) << 8);
+                if (level >= file.getLevelCount() || x >= file.getTilesPerSide(level) ||
+                        y >= file.getTilesPerSide(level)) continue;
+
+                /* Neighbouring pixels mostly name the same tile */
+                uint32_t tile = file.getTileIndex(level, x, y);
+                if (tile == last) continue;
+                last = tile;
+
+                /* Walk up until a tile this frame already reached */
+                while (requested_[tile] != frame_) {
+                    requested_[tile] = frame_;
+                    stats_.requested++;
+                    if (state_[tile] >= 0)                  slots_[state_[tile]].lastUse = std::max(slots_[state_[tile]].lastUse, frame_);
+                    else if (state_[tile] == VT_NOT_RESIDENT) wanted.push_back(tile);
+
+                    if (level + 1 == file.getLevelCount()) break;
+                    level++;
+                    x /= 2;
+                    y /= 2;
+                    tile = file.getTileIndex(level, x, y);
+                }
+            }
+
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        /**
+         * ******************************************************
+         * Read a tile on the ThreadPool
+         * ******************************************************
+        **/
+        void requestTile(uint32_t tile)
+        {
+            std::shared_ptr<TileLoad> load(new TileLoad());
+            load->tile = tile;
+            load->ok = false;
+            state_[tile] = VT_LOADING;
+            inFlight_++;
+
+            std::shared_ptr<Stream> stream = stream_;
+            ThreadPool::global().enqueue([stream, load]() {
+                load->data.resize(stream->file.getPageBytes());
+                load->ok = stream->file.readTile(load->tile, load->data.data());
+
+                std::unique_lock<std::mutex> lock(stream->mutex);
+                stream->ready.push_back(load);
+            });
+        }
+
+        /**
+         * ******************************************************
+         * Put a tile in a free slot, or in the least recently used
+         * one that the last feedback didn't need
+         *
+         * @return false if every slot is needed
+         * ******************************************************
+        **/
+        bool upload(const TileLoad & load)
+        {
+            uint32_t slot;
+            if (!free_.empty()) {
+                slot = free_.back();
+                free_.pop_back();
+            } else {
+                slot = 0;
+                for (uint32_t s = 1; s < slots_.size(); s++) {
+                    if (slots_[s].lastUse < slots_[slot].lastUse) slot = s;
+                }
+                if (slots_[slot].lastUse >= frame_) return false;
+                state_[slots_[slot].tile] = VT_NOT_RESIDENT;
+                stats_.evictions++;
+            }
+            slots_[slot].tile = load.tile;
+            slots_[slot].lastUse = frame_;
+            state_[load.tile] = slot;
+
+            PageFile & file = stream_->file;
+            int page = file.getPageSize();
+            int x = (slot % cachePages_) * page, y = (slot / cachePages_) * page;
+            GLState::get().bindTexture(0, cache_);
+            PixelUploadRing & ring = PixelUploadRing::get();
+            if (!ring.isEnabled() || !ring.upload(0, page, page, GL_RGBA, 4, load.data.data(), x, y)) {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, page, page, GL_RGBA, GL_UNSIGNED_BYTE, load.data.data());
+            }
+            stats_.uploads++;
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * Point every tile at itself or its nearest resident
+         * parent, top level down, and upload the rows of each
+         * level that changed
+         * ******************************************************
+        **/
+        void rebuildIndirection()
+        {
+            PageFile & file = stream_->file;
+            GLState::get().bindTexture(0, indirection_);
+            for (int32_t level = file.getLevelCount() - 1; level >= 0; level--) {
+                uint32_t tiles = file.getTilesPerSide(level);
+                uint32_t first = file.getTileIndex(level, 0, 0);
+                std::vector<uint32_t> & entries = entries_[level];
+                uint32_t firstRow = tiles, lastRow = 0;
+
+                for (uint32_t y = 0; y < tiles; y++) {
+                    for (uint32_t x = 0; x < tiles; x++) {
+                        int32_t slot = state_[first + y * tiles + x];
+                        uint32_t entry;
+                        if (slot >= 0) {
+                            /* R slot x, G slot y, B level */
+                            entry = (slot % cachePages_) | ((slot / cachePages_) << 8) | (level << 16) | 0xFF000000u;
+                        } else {
+                            entry = entries_[level + 1][(y / 2) * (tiles / 2) + x / 2];
+                        }
+                        if (entries[y * tiles + x] != entry) {
+                            entries[y * tiles + x] = entry;
+                            firstRow = std::min(firstRow, y);
+                            lastRow = std::max(lastRow, y);
+                        }
+                    }
+                }
+
+                if (firstRow <= lastRow) {
+                    glTexSubImage2D(GL_TEXTURE_2D, level, 0, firstRow, tiles, lastRow - firstRow + 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, &entries[firstRow * tiles]);
+                }
+            }
+        }
+
+    private: /* Members */
+        uint32_t                    cache_;             /* Texture of cachePages_ x cachePages_ slots */
+        uint32_t                    indirection_;       /* Texture, a texel per tile */
+        uint32_t                    feedbackFbo_;
+        uint32_t                    feedbackColor_;     /* Renderbuffer, tile per pixel */
+        uint32_t                    feedbackDepth_;     /* Renderbuffer */
+        uint32_t                    feedbackPbos_[2];   /* Read back, one written while the other is read */
+        uint32_t                    feedbackWidth_;
+        uint32_t                    feedbackHeight_;
+        uint64_t                    feedbackFrames_;    /* endFeedback() calls since the buffer was created */
+        bool                        inFeedback_;        /* Between beginFeedback() and endFeedback() */
+        int32_t                     viewport_[4];       /* Restored by endFeedback() */
+        float                       clearColor_[4];     /* Restored by endFeedback() */
+        uint32_t                    cachePages_;        /* Slots per side */
+        uint64_t                    frame_;             /* update() calls */
+        uint32_t                    inFlight_;          /* Loads not uploaded yet */
+        std::vector<int32_t>        state_;             /* Per tile, a slot or a TileState */
+        std::vector<uint64_t>       requested_;         /* Per tile, frame of the last request */
+        std::vector<Slot>           slots_;
+        std::vector<uint32_t>       free_;              /* Unused slots */
+        std::vector<std::vector<uint32_t>> entries_;    /* Indirection texels per level, as uploaded */
+        std::shared_ptr<Stream>     stream_;            /* Page file and finished reads */
+        std::vector<Uniforms>       uniforms_;          /* Per program bound with */
+        VirtualTextureStats         stats_;
+};
+
+#endif
@@ -25,6 +25,16 @@
 #define WINDOW_WIDTH 1024 
 #define WINDOW_HEIGHT 768 
 #define ASPECT_RATIO WINDOW_WIDTH/WINDOW_HEIGHT
+#define TEXTURE_UPLOADS_PER_FRAME 4   /* Caps the upload hitch while a model streams in */
+#define USE_PBO_UPLOADS 1             /* Stage texture uploads through the PixelUploadRing */
+#define FRAME_HISTOGRAM_FRAMES 600    /* Frames per logged frame time histogram */
+#define TEXTURE_BUDGET_MB 256         /* Estimated VRAM for model textures, LRU evicted above */
+#define USE_TEXTURE_ARRAYS 0          /* Pack the model materials into texture arrays, compare the binds */
+#define USE_VIRTUAL_TEXTURE 0         /* Stream the crate from a page file, see tools/vttiler */
+#define VIRTUAL_TEXTURE_PATH "/store/Code/cpp/learnopengl/img/textures/terrain.vtp"
+#define INSTANCING_BENCHMARK 0        /* Draw a grid of nanosuits, instanced and one draw per copy in turns */
+#define BENCHMARK_INSTANCES 10000
+#define USE_MESH_ARENA 0              /* Model meshes share the MeshArena buffers, drawn with multi draws */
 
 /* Common */
 #include "common/shader.hpp"
@@ -34,14 +44,21 @@
 
 /* Includes */
 #include <Utils.hpp>
+#include "GLState.hpp"
+#include "PixelUploadRing.hpp"
+#include "FrameTimeHistogram.hpp"
 #include "Shader.hpp"
 #include "Program.hpp"
 #include "Window.hpp"
 #include "Textures.hpp"
+#include "TextureManager.hpp"
+#include "VirtualTexture.hpp"
+#include "InstanceBuffer.hpp"
 #include "Buffers.hpp"
 #include "Transform.hpp"
 #include "Camera.hpp"
 #include "Model.hpp"
+#include "UniformBlocks.hpp"
 
 
 /**
@@ -112,7 +129,7 @@ void createBuffer(VertexArray &vertexArray) {
     vertexArray.print();
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::get().bindVertexArray(0);
 }
 
 /**
@@ -155,7 +172,7 @@ void createWorldAxes(VertexArray& VAO_worldAxes) {
     VAO_worldAxes.enableAllAttribArrays();
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::get().bindVertexArray(0);
 }
 
 /**
@@ -178,7 +195,8 @@ void createGrid(VertexArray& VAO_grid) {
  * ******************************************************
 **/
 Model * loadModel() {
-    Model * model = new Model("/store/Code/cpp/learnopengl/models/nanosuit.obj", GL_STATIC_DRAW);
+    Model * model = new Model("/store/Code/cpp/learnopengl/models/nanosuit.obj", GL_STATIC_DRAW,
+            true, BR_DISCARD, false, USE_TEXTURE_ARRAYS, USE_MESH_ARENA);
 
     return model;
 }
@@ -228,23 +246,48 @@ int main( void )
     createGrid(VAO_grid);
 
     /* Load a new model */
+    PixelUploadRing::get().setEnabled(USE_PBO_UPLOADS);
+    TextureManager::get().setBudget((size_t)TEXTURE_BUDGET_MB << 20);
     Model *nanosuit = loadModel();
 
     /* Compile shaders and link program */
     Shader vShader("/store/Code/cpp/learnopengl/shaders/SimpleVertexShader.vs", GL_VERTEX_SHADER); 
-    Shader fShader("/store/Code/cpp/learnopengl/shaders/SimpleFragmentShader.fs", GL_FRAGMENT_SHADER);
+    std::vector<std::string> materialDefines;
+    if (USE_TEXTURE_ARRAYS) materialDefines.push_back("TEXTURE_ARRAYS");
+    Shader fShader("/store/Code/cpp/learnopengl/shaders/SimpleFragmentShader.fs", GL_FRAGMENT_SHADER, materialDefines);
     Program program(vShader.getHandler(), fShader.getHandler());
 
+    /* The same program, with the model matrices read from an InstanceBuffer */
+    Shader vInstanced("/store/Code/cpp/learnopengl/shaders/SimpleVertexShader.vs", GL_VERTEX_SHADER,
+            std::vector<std::string>(1, "INSTANCED"));
+    Program instancedProgram(vInstanced.getHandler(), fShader.getHandler());
+
     /* Light Source program */
     Shader vLightSource("/store/Code/cpp/learnopengl/shaders/lightSource.vs", GL_VERTEX_SHADER); 
     Shader fLightSource("/store/Code/cpp/learnopengl/shaders/lightSource.fs", GL_FRAGMENT_SHADER); 
     Program lightSource(vLightSource.getHandler(), fLightSource.getHandler());
 
+    /* Virtual texture programs, the crate sampled from the tile cache and its tile feedback */
+    Shader fVirtual("/store/Code/cpp/learnopengl/shaders/virtualTexture.fs", GL_FRAGMENT_SHADER);
+    Shader fVirtualFeedback("/store/Code/cpp/learnopengl/shaders/virtualTexture.fs", GL_FRAGMENT_SHADER,
+            std::vector<std::string>(1, "VT_FEEDBACK"));
+    Program virtualProgram(vLightSource.getHandler(), fVirtual.getHandler());
+    Program feedbackProgram(vLightSource.getHandler(), fVirtualFeedback.getHandler());
+
+    std::unique_ptr<VirtualTexture> virtualTexture;
+    if (USE_VIRTUAL_TEXTURE) {
+        virtualTexture.reset(new VirtualTexture(VIRTUAL_TEXTURE_PATH));
+        if (!virtualTexture->isValid()) virtualTexture.reset();
+    }
+
     /* Stencil shaders */
     Shader vStencil("/store/Code/cpp/learnopengl/shaders/stencil.vs", GL_VERTEX_SHADER); 
     Shader fStencil("/store/Code/cpp/learnopengl/shaders/stencil.fs", GL_FRAGMENT_SHADER); 
     Program stencil(vStencil.getHandler(), fStencil.getHandler());
 
+    /* For the per frame uniform upload stats */
+    Program* programs[] = { &program, &instancedProgram, &lightSource, &virtualProgram, &feedbackProgram, &stencil };
+
     /* Camera */
     Camera camera(glm::vec3(0, 10, 10.0f), 70.0f, ASPECT_RATIO, 0.01f, 1000.0f);
 
@@ -266,8 +309,71 @@ int main( void )
     //Texture smile("/store/Code/cpp/learnopengl/img/textures/awesomeface.png", GL_RGBA, 1);
 
     double time = 0, deltaTime = 0, lastFrame = 0;//, rotateTime = glfwGetTime();
+    FrameTimeHistogram frameTimes;
+    uint64_t frame = 0;
     glm::mat4 res(1.0f);
 
+    /* Resolve the per frame uniforms once */
+    UniformHandle uModel                    = program.getUniform("model");
+    UniformHandle uTransposedInversedModel  = program.getUniform("transposedInversedModel");
+    UniformHandle uObjectColor              = program.getUniform("objectColor");
+    UniformHandle uViewPos                  = program.getUniform("viewPos");
+    UniformHandle uMaterialShininess        = program.getUniform("material.shininess");
+
+    UniformHandle uInstancedObjectColor         = instancedProgram.getUniform("objectColor");
+    UniformHandle uInstancedViewPos             = instancedProgram.getUniform("viewPos");
+    UniformHandle uInstancedMaterialShininess   = instancedProgram.getUniform("material.shininess");
+
+    UniformHandle uStencilModel                     = stencil.getUniform("model");
+    UniformHandle uStencilTransposedInversedModel   = stencil.getUniform("transposedInversedModel");
+
+    UniformHandle uLightSourceTexture       = lightSource.getUniform("ourTexture");
+
+    /* Camera and lights live in uniform buffers shared by the programs */
+    UniformBuffer<CameraBlock> cameraBuffer(UBO_CAMERA);
+    UniformBuffer<LightsBlock> lightsBuffer(UBO_LIGHTS);
+    program.bindUniformBlock("Camera", UBO_CAMERA);
+    program.bindUniformBlock("Lights", UBO_LIGHTS);
+    instancedProgram.bindUniformBlock("Camera", UBO_CAMERA);
+    instancedProgram.bindUniformBlock("Lights", UBO_LIGHTS);
+    stencil.bindUniformBlock("Camera", UBO_CAMERA);
+    lightSource.bindUniformBlock("Camera", UBO_CAMERA);
+    virtualProgram.bindUniformBlock("Camera", UBO_CAMERA);
+    feedbackProgram.bindUniformBlock("Camera", UBO_CAMERA);
+
+    CameraBlock cameraBlock;
+    LightsBlock lightsBlock = LightsBlock();
+
+    /* Directional Light */
+    lightsBlock.dirLight.direction  = glm::vec3(0, -1, 0);
+    lightsBlock.dirLight.ambient    = glm::vec3(0.123f, 0.123f, 0.123f);
+    lightsBlock.dirLight.diffuse    = glm::vec3(1.5f, 1.5f, 1.5f); // darken the dirLight a bit to fit the scene
+    lightsBlock.dirLight.specular   = glm::vec3(1.0f, 1.0f, 1.0f);
+
+    /* Light */
+    lightsBlock.light.ambient       = glm::vec3(0.123f, 0.123f, 0.123f);
+    lightsBlock.light.diffuse       = glm::vec3(1.5f, 1.5f, 1.5f); // darken the light a bit to fit the scene
+    lightsBlock.light.specular      = glm::vec3(1.0f, 1.0f, 1.0f);
+    lightsBlock.light.constant      = 1.0f;
+    lightsBlock.light.linear        = 0.045f;
+    lightsBlock.light.quadratic     = 0.0075f;
+
+    /* Spotlight */
+    lightsBlock.spotlight.diffuse       = glm::vec3(1.5f, 1.5f, 1.5f);
+    lightsBlock.spotlight.specular      = glm::vec3(1.0f, 1.0f, 1.0f);
+    lightsBlock.spotlight.cutOff        = glm::cos(glm::radians(12.5f));
+    lightsBlock.spotlight.outerCutOff   = glm::cos(glm::radians(14.5f));
+    lightsBlock.spotlight.constant      = 1.0f;
+    lightsBlock.spotlight.linear        = 0.045f;
+    lightsBlock.spotlight.quadratic     = 0.0075f;
+
+    /* Instancing benchmark grid, spinning so the matrices are streamed every frame */
+    InstanceBuffer gridInstances;
+    std::vector<glm::mat4> gridModels(INSTANCING_BENCHMARK ? BENCHMARK_INSTANCES : 0);
+    uint32_t gridSide = (uint32_t)ceil(sqrt((double)BENCHMARK_INSTANCES));
+    bool gridInstanced = true;
+    double gridSubmitMs = 0;
+
     // Rotate camera
     float camX = 0, camZ = 0, radius = 10.0f;
     //camera.fix(glm::vec3(0,0,0)); // TODO fix if you want to rotate around a point
@@ -281,6 +387,11 @@ int main( void )
         time = glfwGetTime();
         deltaTime = time - lastFrame;
         lastFrame = time;
+        if (frame++ > 0) frameTimes.add(deltaTime * 1000.0);
+
+        /* Swap in the textures decoded since the last frame */
+        TextureLoader::get().poll(TEXTURE_UPLOADS_PER_FRAME);
+        TextureManager::get().update();
 
         /* Input */
         uptrWindow.get()->processInput(deltaTime, camera);
@@ -291,6 +402,23 @@ int main( void )
         mvp = camera.getProjection() * mov;
         vp = camera.getViewProjection();
 
+        cameraBlock.view = view;
+        cameraBlock.vp = vp;
+        cameraBlock.mov = mov;
+        cameraBlock.mvp = mvp;
+        cameraBuffer.update(cameraBlock);
+
+        /* Which crate tiles this view needs, then stream what the last frame asked for */
+        if (virtualTexture) {
+            virtualTexture->beginFeedback();
+            feedbackProgram.use();
+            virtualTexture->bind(feedbackProgram, 0);
+            GLState::get().bindVertexArray(VAO_crate.getHandler());
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            virtualTexture->endFeedback();
+            virtualTexture->update();
+        }
+
         /* Stencil Ops */
         /* 1st render pass, draw as normal, writing to the stencil buffer */
         glStencilFunc(GL_ALWAYS, 1, 0xFF);
@@ -298,53 +426,56 @@ int main( void )
 
         /* Run object model program */
         program.use();
-        program.setMat4f("model", &(model.getModelRef()[0][0]));
-        program.setMat4f("view", &view[0][0]);
-        program.setMat4f("mov", &mov[0][0]);
-        program.setMat4f("mvp", &mvp[0][0]);
-        program.setMat4f("vp", &vp[0][0]);
+        program.setMat4f(uModel, &(model.getModelRef()[0][0]));
         /* Transform the Normal vectors 
          * Applying the Model-View to normals is not as straight-forward.
          * Since Un-uniform sclaing would result in morphed normals */
         glm::mat4 inversedModel = glm::inverse(model.getModelRef());
         glm::mat4 transposedInversedModel  = glm::transpose(inversedModel);
-        program.setMat4f("transposedInversedModel", &transposedInversedModel[0][0]);
-        program.setVec3("objectColor", 1.0f, 0.5f, 0.31f);
+        program.setMat4f(uTransposedInversedModel, &transposedInversedModel[0][0]);
+        program.setVec3(uObjectColor, 1.0f, 0.5f, 0.31f);
             camX = sin(time) * radius;
             camZ = cos(time) * radius;
 
-        /* Directional Light */
-        program.setVec3("dirLight.direction", 0, -1, 0);
-        program.setVec3("dirLight.ambient",  0.123f, 0.123f, 0.123f);
-        program.setVec3("dirLight.diffuse",  1.5f, 1.5f, 1.5f); // darken the dirLight a bit to fit the scene
-        program.setVec3("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        /* Light */
-        program.setVec3("light.position", camX, 14, camZ);
-        program.setVec3("light.ambient",  0.123f, 0.123f, 0.123f);
-        program.setVec3("light.diffuse",  1.5f, 1.5f, 1.5f); // darken the light a bit to fit the scene
-        program.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
-        program.setFloat("light.constant", 1.0f);
-        program.setFloat("light.linear", 0.045f);
-        program.setFloat("light.quadratic", 0.0075f);
-
-        /* Spotlight */
-        program.setVec3("spotlight.position", camera.getPos());
-        program.setVec3("spotlight.direction", camera.getForward());
-        program.setVec3("spotlight.diffuse",  1.5f, 1.5f, 1.5f);
-        program.setVec3("spotlight.specular", 1.0f, 1.0f, 1.0f);
-        program.setFloat("spotlight.cutOff", glm::cos(glm::radians(12.5f)));
-        program.setFloat("spotlight.outerCutOff", glm::cos(glm::radians(14.5f)));
-        program.setFloat("spotlight.constant", 1.0f);
-        program.setFloat("spotlight.linear", 0.045f);
-        program.setFloat("spotlight.quadratic", 0.0075f);
-
-        program.setVec3("viewPos", glm::vec3(0,0,0)); /* Calculate the specular light in view-space */
-        program.setFloat("material.shininess", 32.0f);
+        /* Only the moving lights change, one upload for the whole block */
+        lightsBlock.light.position = glm::vec3(camX, 14, camZ);
+        lightsBlock.spotlight.position = camera.getPos();
+        lightsBlock.spotlight.direction = camera.getForward();
+        lightsBuffer.update(lightsBlock);
+
+        program.setVec3(uViewPos, glm::vec3(0,0,0)); /* Calculate the specular light in view-space */
+        program.setFloat(uMaterialShininess, 32.0f);
 
         /* Draw models */
         nanosuit->draw(program);
 
+        if (INSTANCING_BENCHMARK) {
+            for (uint32_t i = 0; i < gridModels.size(); i++) {
+                glm::mat4 gridModel = glm::translate(glm::mat4(1.0f),
+                        glm::vec3((float)(i % gridSide) * 3.0f - gridSide * 1.5f, 0.0f, -(float)(i / gridSide) * 3.0f - 5.0f));
+                gridModel = glm::rotate(gridModel, (float)time + i * 0.01f, glm::vec3(0, 1, 0));
+                gridModels[i] = glm::scale(gridModel, glm::vec3(0.2f, 0.2f, 0.2f));
+            }
+
+            double submitStart = glfwGetTime();
+            if (gridInstanced) {
+                gridInstances.update(gridModels.data(), gridModels.size());
+                instancedProgram.use();
+                instancedProgram.setVec3(uInstancedObjectColor, 1.0f, 0.5f, 0.31f);
+                instancedProgram.setVec3(uInstancedViewPos, glm::vec3(0,0,0));
+                instancedProgram.setFloat(uInstancedMaterialShininess, 32.0f);
+                nanosuit->drawInstanced(instancedProgram, gridInstances);
+            } else {
+                for (size_t i = 0; i < gridModels.size(); i++) {
+                    glm::mat4 gridNormals = glm::transpose(glm::inverse(gridModels[i]));
+                    program.setMat4f(uModel, &gridModels[i][0][0]);
+                    program.setMat4f(uTransposedInversedModel, &gridNormals[0][0]);
+                    nanosuit->draw(program);
+                }
+            }
+            gridSubmitMs += (glfwGetTime() - submitStart) * 1000.0;
+        }
+
         // 2nd. render pass: now draw slightly scaled versions of the objects, this time disabling stencil writing.
         // Because the stencil buffer is now filled with several 1s. The parts of the buffer that are 1 are not drawn, thus only drawing 
         // the objects' size differences, making it look like borders.
@@ -354,31 +485,102 @@ int main( void )
         glDisable(GL_DEPTH_TEST);
 
         stencil.use();
-        stencil.setMat4f("model", &(scaledModel.getModelRef()[0][0]));
-        stencil.setMat4f("vp", &vp[0][0]);
+        stencil.setMat4f(uStencilModel, &(scaledModel.getModelRef()[0][0]));
         inversedModel = glm::inverse(scaledModel.getModelRef());
         transposedInversedModel  = glm::transpose(inversedModel);
-        stencil.setMat4f("transposedInversedModel", &transposedInversedModel[0][0]);
+        stencil.setMat4f(uStencilTransposedInversedModel, &transposedInversedModel[0][0]);
         nanosuit->draw(stencil);
 
         /* Reset stencil and depth test */
         glStencilMask(0xFF);
 		glEnable(GL_DEPTH_TEST);
         
-        /* Use the lighting */
-        lightSource.use();
-        lightSource.setMat4f("mvp", &mvp[0][0]);
-        glActiveTexture(GL_TEXTURE0); 
-        lightSource.setInt("ourTexture", 0);
-
         /* Bind and draw crate */
-        glBindTexture(GL_TEXTURE_2D, crate.getHandler());
-        glBindVertexArray(VAO_crate.getHandler());   
+        if (virtualTexture) {
+            virtualProgram.use();
+            virtualTexture->bind(virtualProgram, 0);
+        } else {
+            lightSource.use();
+            lightSource.setInt(uLightSourceTexture, 0);
+            crate.bind(0);
+        }
+        GLState::get().bindVertexArray(VAO_crate.getHandler());
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-        glBindVertexArray(VAO_worldAxes.getHandler());
+        GLState::get().bindVertexArray(VAO_worldAxes.getHandler());
         glDrawArrays(GL_LINES, 0, 18);
 
+        /* Uniform upload stats, per frame, over every program */
+        uint64_t uploadsIssued = 0, uploadsSkipped = 0;
+        for (size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++) {
+            uploadsIssued += programs[i]->getUploadsIssued();
+            uploadsSkipped += programs[i]->getUploadsSkipped();
+            programs[i]->resetUploadStats();
+        }
+        LOG(L_DBG, "Uniform uploads: %lu issued, %lu skipped.", (unsigned long)uploadsIssued, (unsigned long)uploadsSkipped);
+
+        /* Model state changes, per frame */
+        const RenderQueueStats& renderStats = nanosuit->getRenderStats();
+        LOG(L_DBG, "Render queue: %lu draws in %lu multi draws, %lu instances, binds issued/saved: program %lu/%lu, texture %lu/%lu, VAO %lu/%lu.",
+                (unsigned long)renderStats.draws, (unsigned long)renderStats.multiDraws, (unsigned long)renderStats.instances,
+                (unsigned long)renderStats.programBinds, (unsigned long)renderStats.programBindsSaved,
+                (unsigned long)renderStats.textureBinds, (unsigned long)renderStats.textureBindsSaved,
+                (unsigned long)renderStats.vaoBinds, (unsigned long)renderStats.vaoBindsSaved);
+        nanosuit->resetRenderStats();
+
+        /* GL binds, per frame */
+        const GLStateStats& glStats = GLState::get().getStats();
+        LOG(L_DBG, "GL binds issued/filtered: program %lu/%lu, unit %lu/%lu, texture %lu/%lu, VAO %lu/%lu.",
+                (unsigned long)glStats.programBinds, (unsigned long)glStats.programFiltered,
+                (unsigned long)glStats.unitSwitches, (unsigned long)glStats.unitFiltered,
+                (unsigned long)glStats.textureBinds, (unsigned long)glStats.textureFiltered,
+                (unsigned long)glStats.vaoBinds, (unsigned long)glStats.vaoFiltered);
+        GLState::get().resetStats();
+
+        /* Texture streaming, per frame */
+        const PixelUploadStats& uploadStats = PixelUploadRing::get().getStats();
+        if (uploadStats.uploads != 0) {
+            LOG(L_DBG, "Pixel uploads: %lu, %lu KiB staged, %lu stalls for %.2f ms, %lu unmapped.",
+                    (unsigned long)uploadStats.uploads, (unsigned long)(uploadStats.bytes / 1024),
+                    (unsigned long)uploadStats.stalls, uploadStats.stallMs, (unsigned long)uploadStats.unmapped);
+        }
+        PixelUploadRing::get().resetStats();
+
+        /* Texture residency, per frame */
+        TextureManagerStats residency = TextureManager::get().getStats();
+        if (residency.evictions != 0 || residency.reloads != 0) {
+            LOG(L_DBG, "Textures: %lu held, %lu evicted, %lu KiB of %lu KiB resident, %lu evictions, %lu reloads.",
+                    (unsigned long)residency.textures, (unsigned long)residency.evicted,
+                    (unsigned long)(residency.residentBytes / 1024), (unsigned long)(residency.budget / 1024),
+                    (unsigned long)residency.evictions, (unsigned long)residency.reloads);
+        }
+        TextureManager::get().resetStats();
+
+        /* Virtual texture streaming, per frame */
+        if (virtualTexture) {
+            VirtualTextureStats streaming = virtualTexture->getStats();
+            if (streaming.uploads != 0 || streaming.dropped != 0) {
+                LOG(L_DBG, "Virtual texture: %u tiles requested, %u resident, %u loading, %lu uploads, %lu evictions, %lu dropped.",
+                        streaming.requested, streaming.resident, streaming.loading, (unsigned long)streaming.uploads,
+                        (unsigned long)streaming.evictions, (unsigned long)streaming.dropped);
+            }
+            virtualTexture->resetStats();
+        }
+
+        if (frameTimes.getFrames() == FRAME_HISTOGRAM_FRAMES) {
+            if (INSTANCING_BENCHMARK) {
+                /* Each way gets a histogram, then the grid switches */
+                frameTimes.print(gridInstanced ? "Frame times (instanced grid)" : "Frame times (draw per copy grid)");
+                LOG(L_INFO, "%u nanosuits, %s: %.3f ms per frame submitting the draws.", BENCHMARK_INSTANCES,
+                        gridInstanced ? "instanced" : "one draw per copy", gridSubmitMs / FRAME_HISTOGRAM_FRAMES);
+                gridInstanced = !gridInstanced;
+                gridSubmitMs = 0;
+            } else {
+                frameTimes.print(USE_PBO_UPLOADS ? "Frame times (PBO uploads)" : "Frame times (direct uploads)");
+            }
+            frameTimes.reset();
+        }
+
         /* Swap buffers */
         uptrWindow.get()->swapBuffers();
 
@@ -386,6 +588,10 @@ int main( void )
         glfwPollEvents();
     } 
 
+    /* The textures go with the model, while the context is still there */
+    delete nanosuit;
+    virtualTexture.reset();
+
     /* Close OpenGL window and terminate GLFW */
     uptrWindow.reset(NULL);
     glfwTerminate();
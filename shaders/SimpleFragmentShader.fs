@@ -13,6 +13,16 @@ uniform vec3 viewPos;
 
 uniform float ourColor;
 
+#ifdef TEXTURE_ARRAYS
+// Material textures packed in arrays, see TextureArray.hpp. One layer per slot:
+// x diffuse, y specular, z normals, w height
+struct Material {
+    float shininess;
+};
+uniform sampler2DArray diffuseArray;
+uniform sampler2DArray specularArray;
+uniform vec4 materialLayers;
+#else
 struct Material {
     sampler2D ambient;
     sampler2D diffuse1;
@@ -22,6 +32,14 @@ struct Material {
     sampler2D specular2;
     float shininess;
 };
+#endif
+
+// The material textures at a fragment, sampled once
+struct MaterialColor {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
 
 struct DirectionalLight {
     vec3 direction;
@@ -58,9 +76,35 @@ struct Light {
 };
 
 uniform Material material;
-uniform DirectionalLight dirLight;
-uniform Light light;
-uniform Spotlight spotlight;
+// Uploaded once per frame, see UniformBlocks.hpp
+layout(std140) uniform Lights {
+    DirectionalLight dirLight;
+    Light light;
+    Spotlight spotlight;
+};
+
+/**
+ * ******************************************************
+ * Sample the material textures.
+ *
+ * Done once per fragment, every light reuses the colors.
+ * Without an ambient texture (the arrays have none) the
+ * ambient is the diffuse color.
+ * ******************************************************
+**/
+MaterialColor sampleMaterial(vec2 texPos) {
+    MaterialColor color;
+#ifdef TEXTURE_ARRAYS
+    color.diffuse  = vec3(texture(diffuseArray, vec3(texPos, materialLayers.x)));
+    color.specular = vec3(texture(specularArray, vec3(texPos, materialLayers.y)));
+    color.ambient  = color.diffuse;
+#else
+    color.ambient  = vec3(texture(material.ambient, texPos));
+    color.diffuse  = vec3(texture(material.diffuse1, texPos));
+    color.specular = vec3(texture(material.specular1, texPos));
+#endif
+    return color;
+}
 
 /**
  * ******************************************************
@@ -96,8 +140,8 @@ float calculateLightAttenuation(Light source, vec3 objPos) {
  * (light color) and the material ambient (material color).
  * ******************************************************
 **/
-vec3 calculateAmbient(vec3 lightAmbient, sampler2D materialAmbient, vec2 texPos) {
-    return (lightAmbient * vec3(texture(materialAmbient, texPos)));
+vec3 calculateAmbient(vec3 lightAmbient, vec3 materialAmbient) {
+    return (lightAmbient * materialAmbient);
 }
 
 /**
@@ -120,10 +164,10 @@ vec3 calculateAmbient(vec3 lightAmbient, sampler2D materialAmbient, vec2 texPos)
  * and the material diffuse property.
  * ******************************************************
 **/
-vec3 calculateDiffuse(vec3 normal_MV, vec3 lightDir, vec3 lightDiffuse, sampler2D materialDiffuse, vec2 texPos) {
+vec3 calculateDiffuse(vec3 normal_MV, vec3 lightDir, vec3 lightDiffuse, vec3 materialDiffuse) {
     /* Diffuse impact. Dot product */
     float diff = max(dot(normal_MV, lightDir), 0.0);
-    return (lightDiffuse * (diff * vec3(texture(materialDiffuse, texPos))));
+    return (lightDiffuse * (diff * materialDiffuse));
 }
 
 /**
@@ -165,10 +209,10 @@ vec3 calculateDiffuse(vec3 normal_MV, vec3 lightDir, vec3 lightDiffuse, sampler2
  *
  * ******************************************************
 **/
-vec3 calculateSpecular(vec3 normal_MV, vec3 viewDir, vec3 lightDir, vec3 lightSpecular, sampler2D materialSpecular, float materialShininess, vec2 texPos) {
+vec3 calculateSpecular(vec3 normal_MV, vec3 viewDir, vec3 lightDir, vec3 lightSpecular, vec3 materialSpecular, float materialShininess) {
     vec3 reflectDir = reflect(-lightDir, normal_MV);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialShininess);
-    return (lightSpecular * (spec * vec3(texture(materialSpecular, texPos))));
+    return (lightSpecular * (spec * materialSpecular));
 }
 
 /**
@@ -181,20 +225,19 @@ vec3 calculateSpecular(vec3 normal_MV, vec3 viewDir, vec3 lightDir, vec3 lightSp
  * ******************************************************
 **/
 vec3 calculateDirectionalLight(DirectionalLight dl, Material material,
+                               MaterialColor color,
                                vec3 normal_MV,
-                               vec3 viewDir,
-                               vec2 texPos) {
+                               vec3 viewDir) {
     vec3 lved /* light vector direction */ = normalize(-dl.direction);
 
     /* Ambient */
-    //vec3 ambient = dl.ambient * vec3(texture(material.ambient, texPos));
-    vec3 ambient = calculateAmbient(dl.ambient, material.ambient, texPos);
+    vec3 ambient = calculateAmbient(dl.ambient, color.ambient);
 
     /* Diffuse */
-    vec3 diffuse = calculateDiffuse(normal_MV, lved , dl.diffuse, material.diffuse1, texPos);
+    vec3 diffuse = calculateDiffuse(normal_MV, lved , dl.diffuse, color.diffuse);
 
     /* Specular */
-    vec3 specular = calculateSpecular(normal_MV, viewDir, lved , light.specular, material.specular1, material.shininess, texPos);
+    vec3 specular = calculateSpecular(normal_MV, viewDir, lved , light.specular, color.specular, material.shininess);
 
     return (ambient + diffuse + specular);
 }
@@ -210,7 +253,7 @@ vec3 calculateDirectionalLight(DirectionalLight dl, Material material,
  * lumens on the package.
  * ******************************************************
 **/
-vec3 calculatePointLight(float attenuation, vec2 texPos, 
+vec3 calculatePointLight(float attenuation, MaterialColor color,
                         vec3 normal_MV, 
                         vec3 viewDir,
                         Light light,
@@ -219,16 +262,15 @@ vec3 calculatePointLight(float attenuation, vec2 texPos,
     vec3 lved /* light vector direction */ = normalize(light.position - in_fragPos);
 
     /* Setting material */
-    //vec3 ambient = light.ambient * vec3(texture(material.ambient, texPos));
-    vec3 ambient = calculateAmbient(light.ambient, material.ambient, texPos);
+    vec3 ambient = calculateAmbient(light.ambient, color.ambient);
     ambient *= attenuation;
 
     /* Diffuse */
-    vec3 diffuse = calculateDiffuse(normal_MV, lved , light.diffuse, material.diffuse1, texPos);
+    vec3 diffuse = calculateDiffuse(normal_MV, lved , light.diffuse, color.diffuse);
     diffuse *= attenuation;
 
     /* Specular */
-    vec3 specular = calculateSpecular(normal_MV, viewDir, lved , light.specular, material.specular1, material.shininess, texPos);
+    vec3 specular = calculateSpecular(normal_MV, viewDir, lved , light.specular, color.specular, material.shininess);
     specular *= attenuation;
 
     return (ambient + diffuse + specular);
@@ -244,17 +286,17 @@ vec3 calculatePointLight(float attenuation, vec2 texPos,
 vec3 calculateSpotlight(float attenuation,
                         vec3 normal_MV,
                         vec3 viewDir,
-                        vec2 texPos,
+                        MaterialColor color,
                         Spotlight spotlight,
                         Material material) {
     vec3 lved /* light vector direction */ = normalize(spotlight.position - in_fragPos);
 
     /* Diffuse */
-    vec3 diffuse = calculateDiffuse(normal_MV, lved, spotlight.diffuse, material.diffuse1, texPos);
+    vec3 diffuse = calculateDiffuse(normal_MV, lved, spotlight.diffuse, color.diffuse);
     diffuse *= attenuation;
 
     /* Diffuse */
-    vec3 specular = calculateSpecular(normal_MV, viewDir, lved, spotlight.specular, material.specular1, material.shininess, texPos);
+    vec3 specular = calculateSpecular(normal_MV, viewDir, lved, spotlight.specular, color.specular, material.shininess);
     specular *= attenuation;
 
     float theta = dot(lved, normalize(-spotlight.direction));
@@ -299,17 +341,20 @@ void main()
     /* Attenuation */
     float attenuation = calculateLightAttenuation(light, in_fragPos);
 
+    /* Material */
+    MaterialColor color = sampleMaterial(in_tex);
+
     /* Point Light */
-    vec3 result = calculatePointLight(attenuation, in_tex,
+    vec3 result = calculatePointLight(attenuation, color,
                         normal_MV, viewDir,
                         light, material);
     result *= objectColor; 
     /* Spotlight */
     result += calculateSpotlight(attenuation, normal_MV,
-                   viewDir, in_tex, spotlight, material);
+                   viewDir, color, spotlight, material);
 
     /* Directional Light  */
-    result += calculateDirectionalLight(dirLight, material, normal_MV, viewDir, in_tex);
+    result += calculateDirectionalLight(dirLight, material, color, normal_MV, viewDir);
 
     //outCol = vec4(result, 1.0);
     float near = 0.1;
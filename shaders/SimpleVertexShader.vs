@@ -5,21 +5,36 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aCol;
 layout(location = 2) in vec2 aTex;
 
+#ifdef INSTANCED
+// Per instance, a column per location, see InstanceBuffer.hpp
+layout(location = 3) in mat4 iModel;
+layout(location = 7) in mat4 iTransposedInversedModel;
+#else
 uniform mat4 model; 
-uniform mat4 view;
-uniform mat4 mov;
-uniform mat4 mvp;
-uniform mat4 vp;
+#endif
+// Shared by all programs, see UniformBlocks.hpp
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 vp;
+    mat4 mov;
+    mat4 mvp;
+};
  // we now define the uniform in the vertex shader and pass the 'view space' 
  // lightpos to the fragment shader. in_lightPos is currently in world space.
 uniform vec3 u_lightPos;
+#ifndef INSTANCED
 uniform mat4 transposedInversedModel;
+#endif
 
 out vec3 in_normal;
 out vec2 in_tex;
 out vec3 in_fragPos;
 
 void main(){
+#ifdef INSTANCED
+    mat4 model = iModel;
+    mat4 transposedInversedModel = iTransposedInversedModel;
+#endif
     in_fragPos = vec3(model * vec4(aPos, 1.0));
     gl_Position = (vp * vec4(in_fragPos, 1.0f));
     in_normal = vec3(transposedInversedModel* vec4(aCol, 0));
@@ -5,7 +5,13 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aCol;
 layout(location = 2) in vec2 aTex;
 
-uniform mat4 mvp;
+// Shared by all programs, see UniformBlocks.hpp
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 vp;
+    mat4 mov;
+    mat4 mvp;
+};
 
 out vec3 vsCol;
 out vec2 vsTex;
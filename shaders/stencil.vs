@@ -6,10 +6,13 @@ layout(location = 1) in vec3 aCol;
 layout(location = 2) in vec2 aTex;
 
 uniform mat4 model; 
-uniform mat4 view;
-uniform mat4 mov;
-uniform mat4 mvp;
-uniform mat4 vp;
+// Shared by all programs, see UniformBlocks.hpp
+layout(std140) uniform Camera {
+    mat4 view;
+    mat4 vp;
+    mat4 mov;
+    mat4 mvp;
+};
  // we now define the uniform in the vertex shader and pass the 'view space' 
  // lightpos to the fragment shader. in_lightPos is currently in world space.
 uniform vec3 u_lightPos;
@@ -0,0 +1,45 @@
+#version 330 core
+// Samples a virtual texture, see VirtualTexture.hpp. Built with
+// VT_FEEDBACK it writes the tile each fragment needs instead:
+// R, G the low bits of the tile x, y, B their high bits, A the level + 1.
+out vec4 FragColor;
+
+in vec2 vsTex;
+
+uniform sampler2D vtCache;
+uniform sampler2D vtIndirection;
+uniform vec4 vtInfo;        // virtual size, levels, tile size, border
+uniform vec2 vtScale;       // image / virtual size, the rest is padding
+uniform float vtCacheSize;  // cache texels per side
+uniform float vtLodBias;
+
+// Level the fragment needs, from the texel footprint
+float virtualLevel(vec2 texel)
+{
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + vtLodBias;
+    return clamp(floor(lod), 0.0, vtInfo.y - 1.0);
+}
+
+void main()
+{
+    // Clamped, a virtual texture doesn't repeat
+    vec2 uv = clamp(vsTex, 0.0, 1.0) * vtScale;
+    float level = virtualLevel(uv * vtInfo.x);
+    float tiles = exp2(vtInfo.y - 1.0 - level);
+    ivec2 tile = min(ivec2(uv * tiles), ivec2(tiles - 1.0));
+
+#ifdef VT_FEEDBACK
+    FragColor = vec4(float(tile.x & 255), float(tile.y & 255),
+            float((tile.x >> 8) | ((tile.y >> 8) << 4)), level + 1.0) / 255.0;
+#else
+    // Slot x, y and level of the tile, or of its nearest resident parent
+    vec3 entry = floor(texelFetch(vtIndirection, tile, int(level)).xyz * 255.0 + 0.5);
+    vec2 inTile = fract(uv * exp2(vtInfo.y - 1.0 - entry.z));
+
+    float page = vtInfo.z + 2.0 * vtInfo.w;
+    vec2 texel = entry.xy * page + vtInfo.w + inTile * vtInfo.z;
+    FragColor = textureLod(vtCache, texel / vtCacheSize, 0.0);
+#endif
+}
@@ -0,0 +1,96 @@
+/******************************************
+
+* File Name : tests/TestContext.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Hidden 3.3 core context for the tests that need GL, and the check
+ * macro they report with. A test exits with 1 if a check failed.
+ */
+
+#ifndef _LOGL_TEST_CONTEXT_HPP_
+#define _LOGL_TEST_CONTEXT_HPP_
+
+/* Glew */
+#include <GL/glew.h>
+
+/* GLFW */
+#include <glfw3.h>
+
+#include "Utils.hpp"
+
+#define TEST_CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { LOG(L_ERR, "FAILED: " __VA_ARGS__); testFailures()++; } \
+    } while (0)
+
+inline uint32_t& testFailures()
+{
+    static uint32_t failures = 0;
+    return failures;
+}
+
+/**
+ * ******************************************************
+ * @brief Invisible window owning the test context
+ * ******************************************************
+**/
+class TestContext {
+    public: /* Constructors */
+        TestContext(int width = 640, int height = 480) :
+            window_(NULL)
+        {
+            if (!glfwInit()) {
+                LOG(L_ERR, "Failed to initialize GLFW");
+                return;
+            }
+            glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+            window_ = glfwCreateWindow(width, height, "Test", NULL, NULL);
+            if (window_ == NULL) {
+                LOG(L_ERR, "Failed to create a 3.3 core context");
+                glfwTerminate();
+                return;
+            }
+            glfwMakeContextCurrent(window_);
+
+            glewExperimental = true;
+            if (glewInit() != GLEW_OK) {
+                LOG(L_ERR, "Failed to initialize GLEW");
+                glfwDestroyWindow(window_);
+                glfwTerminate();
+                window_ = NULL;
+            }
+        }
+
+        ~TestContext()
+        {
+            if (window_ == NULL) return;
+            glfwDestroyWindow(window_);
+            glfwTerminate();
+        }
+
+    public: /* Methods */
+        bool isValid() { return window_ != NULL; }
+        GLFWwindow* getWindow() { return window_; }
+
+    private: /* Members */
+        GLFWwindow*     window_;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/******************************************
+
+* File Name : tests/bindcount/bindcount.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Texture binds per frame of a model drawn with its 2D textures and
+ * with the textures packed into arrays, from the RenderQueue stats.
+ * Prints both, the arrays must not bind more. Every array sampler
+ * of the packed program must be bound for every mesh, to the
+ * material's array or to TextureArray::blank().
+ *
+ * bindcount [model] [frames]
+ *
+ * Run from this directory, the shaders are read from the repository.
+ * The default model is the nanosuit main.cpp loads.
+ */
+
+/* STD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Shader.hpp"
+#include "Program.hpp"
+#include "Model.hpp"
+#include "TextureLoader.hpp"
+
+#define BC_MODEL    "/store/Code/cpp/learnopengl/models/nanosuit.obj"
+#define BC_FRAMES   100
+
+/* Per frame averages of one way of drawing the model */
+static RenderQueueStats measure(const char* label, const char* path, bool packTextures, uint32_t frames)
+{
+    Shader vShader("../../shaders/SimpleVertexShader.vs", GL_VERTEX_SHADER, "shaders.log");
+    std::vector<std::string> defines;
+    if (packTextures) defines.push_back("TEXTURE_ARRAYS");
+    Shader fShader("../../shaders/SimpleFragmentShader.fs", GL_FRAGMENT_SHADER, defines, "shaders.log");
+    Program program(vShader.getHandler(), fShader.getHandler());
+
+    Model model(path, GL_STATIC_DRAW, false, BR_DISCARD, false, packTextures);
+    TextureLoader::get().finish();
+
+    /* The first frame binds everything, the steady state is what counts */
+    model.draw(program);
+    model.resetRenderStats();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        TextureManager::get().update();
+        model.draw(program);
+    }
+    glFinish();
+
+    RenderQueueStats stats = model.getRenderStats();
+    LOG(L_INFO, "%s: %.1f draws, %.1f texture binds, %.1f saved, %.1f program binds, %.1f VAO binds per frame.",
+            label, stats.draws / (double)frames, stats.textureBinds / (double)frames,
+            stats.textureBindsSaved / (double)frames, stats.programBinds / (double)frames,
+            stats.vaoBinds / (double)frames);
+
+    if (packTextures) {
+        /* The last mesh drawn left its arrays on the sampled units */
+        for (uint32_t slot = 0; slot < MATERIAL_SLOTS; slot++) {
+            int32_t location = glGetUniformLocation(program.getId(), materialArraySampler(slot).c_str());
+            if (location < 0) continue;
+            int32_t unit = -1, bound = 0;
+            glGetUniformiv(program.getId(), location, &unit);
+            if (unit == (int32_t)slot) {
+                GLState::get().activeTexture(unit);
+                glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &bound);
+            }
+            TEST_CHECK(unit == (int32_t)slot && bound != 0, "%s reads unit %d, array %d bound",
+                    materialArraySampler(slot).c_str(), unit, bound);
+        }
+    }
+    TEST_CHECK(glGetError() == GL_NO_ERROR, "GL error drawing %s.", label);
+    return stats;
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = argc > 1 ? argv[1] : BC_MODEL;
+    uint32_t frames = argc > 2 ? atoi(argv[2]) : BC_FRAMES;
+    if (frames == 0) frames = 1;
+
+    TestContext context;
+    if (!context.isValid()) return 1;
+    {
+        RenderQueueStats textures = measure("2D textures", path.c_str(), false, frames);
+        RenderQueueStats arrays = measure("Texture arrays", path.c_str(), true, frames);
+        TEST_CHECK(textures.draws != 0, "%s drew nothing", path.c_str());
+        TEST_CHECK(arrays.textureBinds <= textures.textureBinds, "the arrays bind more, %lu against %lu",
+                (unsigned long)arrays.textureBinds, (unsigned long)textures.textureBinds);
+    }
+
+    LOG(L_INFO, "bindcount: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+/******************************************
+
+* File Name : tests/importalloc/importalloc.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Counts the heap allocations and bytes of Model::processMesh for
+ * generated meshes of 1K to 1M vertices. The buffers are sized once
+ * from mNumVertices and the faces, so the allocation count must be
+ * the same for every size and the bytes past the exact vertex and
+ * index sizes must not grow with the mesh.
+ *
+ * No GL, runs anywhere Assimp links.
+ */
+
+/* STD */
+#include <new>
+#include <atomic>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Program.hpp"
+#include "Model.hpp"
+
+static std::atomic<bool>        counting(false);
+static std::atomic<uint64_t>    allocations(0);
+static std::atomic<uint64_t>    allocatedBytes(0);
+
+void* operator new(size_t size)
+{
+    if (counting) {
+        allocations++;
+        allocatedBytes += size;
+    }
+    void* p = malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+/* A strip of triangles over a row of vertices, with normals and texture coordinates */
+static aiMesh* makeMesh(uint32_t vertexCount)
+{
+    aiMesh* mesh = new aiMesh();
+    mesh->mNumVertices = vertexCount;
+    mesh->mVertices = new aiVector3D[vertexCount];
+    mesh->mNormals = new aiVector3D[vertexCount];
+    mesh->mTextureCoords[0] = new aiVector3D[vertexCount];
+    for (uint32_t i = 0; i < vertexCount; i++) {
+        mesh->mVertices[i] = aiVector3D(i >> 1, i & 1, 0.0f);
+        mesh->mNormals[i] = aiVector3D(0.0f, 0.0f, 1.0f);
+        mesh->mTextureCoords[0][i] = aiVector3D((i >> 1) / (float)vertexCount, i & 1, 0.0f);
+    }
+
+    mesh->mNumFaces = vertexCount - 2;
+    mesh->mFaces = new aiFace[mesh->mNumFaces];
+    for (uint32_t i = 0; i < mesh->mNumFaces; i++) {
+        mesh->mFaces[i].mNumIndices = 3;
+        mesh->mFaces[i].mIndices = new unsigned int[3];
+        mesh->mFaces[i].mIndices[0] = i;
+        mesh->mFaces[i].mIndices[1] = i + 1 + (i & 1);
+        mesh->mFaces[i].mIndices[2] = i + 2 - (i & 1);
+    }
+    mesh->mMaterialIndex = 0;
+    return mesh;
+}
+
+int main()
+{
+    static const uint32_t sizes[] = { 1000, 10000, 100000, 1000000 };
+    const uint32_t sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    /* One material with a diffuse and a specular texture */
+    aiScene scene;
+    scene.mNumMaterials = 1;
+    scene.mMaterials = new aiMaterial*[1];
+    scene.mMaterials[0] = new aiMaterial();
+    aiString diffuse("diffuse.png"), specular("specular.png");
+    scene.mMaterials[0]->AddProperty(&diffuse, AI_MATKEY_TEXTURE_DIFFUSE(0));
+    scene.mMaterials[0]->AddProperty(&specular, AI_MATKEY_TEXTURE_SPECULAR(0));
+
+    uint64_t counts[sizeCount], overheads[sizeCount];
+    for (uint32_t s = 0; s < sizeCount; s++) {
+        aiMesh* mesh = makeMesh(sizes[s]);
+        {
+            MeshData data;
+            allocations = 0;
+            allocatedBytes = 0;
+            counting = true;
+            Model::processMesh(mesh, &scene, data);
+            counting = false;
+
+            uint64_t exact = data.vertices.size() * sizeof(Vertex) + data.indices.size() * sizeof(unsigned int);
+            counts[s] = allocations;
+            overheads[s] = allocatedBytes - exact;
+            LOG(L_INFO, "%7u vertices, %7lu indices: %lu allocations, %lu KiB, %lu bytes over the exact size.",
+                    sizes[s], (unsigned long)data.indices.size(), (unsigned long)counts[s],
+                    (unsigned long)(allocatedBytes >> 10), (unsigned long)overheads[s]);
+
+            TEST_CHECK(data.vertices.size() == sizes[s] && data.vertices.capacity() == sizes[s],
+                    "%u vertices in a vector of %lu", sizes[s], (unsigned long)data.vertices.capacity());
+            TEST_CHECK(data.indices.capacity() == data.indices.size(), "%lu indices in a vector of %lu",
+                    (unsigned long)data.indices.size(), (unsigned long)data.indices.capacity());
+            TEST_CHECK(data.textures.size() == 2, "%lu texture references", (unsigned long)data.textures.size());
+        }
+        delete mesh;
+    }
+
+    for (uint32_t s = 1; s < sizeCount; s++) {
+        TEST_CHECK(counts[s] == counts[0], "%u vertices take %lu allocations, %u take %lu", sizes[s],
+                (unsigned long)counts[s], sizes[0], (unsigned long)counts[0]);
+        TEST_CHECK(overheads[s] == overheads[0], "%u vertices allocate %lu bytes over the exact size, %u %lu",
+                sizes[s], (unsigned long)overheads[s], sizes[0], (unsigned long)overheads[0]);
+    }
+
+    LOG(L_INFO, "importalloc: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
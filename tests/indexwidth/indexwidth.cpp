@@ -0,0 +1,159 @@
+/******************************************
+
+* File Name : tests/indexwidth/indexwidth.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Index width at the 16 bit boundary. The 16 bit indexVBO overloads
+ * must take 65535 and 65536 welded vertices, refuse 65537 without
+ * touching the out_ arrays, and the 32 bit fallback must then give
+ * every vertex once. Mesh must pick u8/u16/u32 by vertex count and
+ * size its index buffer to match.
+ */
+
+/* STD */
+#include <vector>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Program.hpp"
+#include "Mesh.hpp"
+#include "vboindexer.hpp"
+
+/* count distinct vertices, each used once */
+static void makeVertices(uint32_t count, std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& uvs,
+        std::vector<glm::vec3>& normals)
+{
+    vertices.resize(count);
+    uvs.assign(count, glm::vec2(0.0f, 0.0f));
+    normals.assign(count, glm::vec3(0.0f, 0.0f, 1.0f));
+    for (uint32_t i = 0; i < count; i++) vertices[i] = glm::vec3(i % 1024, i / 1024, 0.0f);
+}
+
+static void checkIndexer(uint32_t count)
+{
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    makeVertices(count, vertices, uvs, normals);
+
+    std::vector<unsigned short> shortIndices;
+    std::vector<glm::vec3> outVertices, outNormals;
+    std::vector<glm::vec2> outUvs;
+    bool fits = indexVBO(vertices, uvs, normals, shortIndices, outVertices, outUvs, outNormals);
+
+    if (count <= 0x10000) {
+        TEST_CHECK(fits, "%u vertices should fit 16 bit indices.", count);
+        TEST_CHECK(outVertices.size() == count && shortIndices.size() == count,
+                "%u vertices: %lu welded, %lu indices.", count,
+                (unsigned long)outVertices.size(), (unsigned long)shortIndices.size());
+        bool wrapped = false;
+        for (uint32_t i = 0; i < shortIndices.size(); i++) wrapped |= shortIndices[i] != i;
+        TEST_CHECK(!wrapped, "%u vertices: 16 bit indices wrapped.", count);
+        return;
+    }
+
+    TEST_CHECK(!fits, "%u vertices can't fit 16 bit indices.", count);
+    TEST_CHECK(shortIndices.empty() && outVertices.empty() && outUvs.empty() && outNormals.empty(),
+            "%u vertices: the failed 16 bit call left %lu vertices, %lu indices.", count,
+            (unsigned long)outVertices.size(), (unsigned long)shortIndices.size());
+
+    /* The fallback a caller takes */
+    std::vector<unsigned int> indices;
+    indexVBO(vertices, uvs, normals, indices, outVertices, outUvs, outNormals);
+    TEST_CHECK(outVertices.size() == count && outUvs.size() == count && outNormals.size() == count,
+            "%u vertices: the 32 bit fallback gave %lu.", count, (unsigned long)outVertices.size());
+    bool wrong = indices.size() != count;
+    for (uint32_t i = 0; !wrong && i < indices.size(); i++) wrong = indices[i] != i;
+    TEST_CHECK(!wrong, "%u vertices: wrong 32 bit indices.", count);
+}
+
+static void checkIndexerTBN(uint32_t count)
+{
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    makeVertices(count, vertices, uvs, normals);
+    std::vector<glm::vec3> tangents(count, glm::vec3(1.0f, 0.0f, 0.0f)), bitangents(count, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<unsigned short> shortIndices;
+    std::vector<glm::vec3> outVertices, outNormals, outTangents, outBitangents;
+    std::vector<glm::vec2> outUvs;
+    bool fits = indexVBO_TBN(vertices, uvs, normals, tangents, bitangents,
+            shortIndices, outVertices, outUvs, outNormals, outTangents, outBitangents);
+    TEST_CHECK(fits == (count <= 0x10000), "TBN, %u vertices: 16 bit indices %s.", count, fits ? "fit" : "don't fit");
+    size_t expected = fits ? count : 0;
+    TEST_CHECK(outVertices.size() == expected && outTangents.size() == expected && outBitangents.size() == expected,
+            "TBN, %u vertices: %lu welded, %lu tangents.", count,
+            (unsigned long)outVertices.size(), (unsigned long)outTangents.size());
+}
+
+/* Indices are offset by what out_vertices already holds */
+static void checkAppend()
+{
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    makeVertices(0x10000, vertices, uvs, normals);
+
+    std::vector<unsigned short> shortIndices;
+    std::vector<glm::vec3> outVertices(1), outNormals(1);
+    std::vector<glm::vec2> outUvs(1);
+    bool fits = indexVBO(vertices, uvs, normals, shortIndices, outVertices, outUvs, outNormals);
+    TEST_CHECK(!fits && outVertices.size() == 1 && shortIndices.empty(),
+            "1 + 65536 vertices: %s, %lu vertices left.", fits ? "fit" : "refused", (unsigned long)outVertices.size());
+
+    vertices.pop_back();
+    uvs.pop_back();
+    normals.pop_back();
+    fits = indexVBO(vertices, uvs, normals, shortIndices, outVertices, outUvs, outNormals);
+    TEST_CHECK(fits && outVertices.size() == 0x10000 && shortIndices.front() == 1 && shortIndices.back() == 0xFFFF,
+            "1 + 65535 vertices should fit, offset by 1.");
+}
+
+/* Index type and buffer size Mesh picks */
+static void checkMesh(uint32_t count, uint32_t indexType, size_t indexSize)
+{
+    std::vector<Vertex> vertices(count);
+    std::vector<unsigned int> indices(count);
+    for (uint32_t i = 0; i < count; i++) indices[i] = count - 1 - i;
+
+    Mesh mesh(std::move(vertices), std::move(indices), std::vector<Texture*>(), GL_STATIC_DRAW);
+    TEST_CHECK(mesh.getIndexType() == indexType, "Mesh of %u vertices: index type 0x%x, not 0x%x.",
+            count, mesh.getIndexType(), indexType);
+    TEST_CHECK(mesh.getGpuBytes() == count * sizeof(Vertex) + count * indexSize,
+            "Mesh of %u vertices: %lu buffer bytes.", count, (unsigned long)mesh.getGpuBytes());
+}
+
+int main()
+{
+    checkIndexer(0xFFFF);
+    checkIndexer(0x10000);
+    checkIndexer(0x10001);
+    checkIndexerTBN(0x10000);
+    checkIndexerTBN(0x10001);
+    checkAppend();
+
+    TestContext context;
+    TEST_CHECK(context.isValid(), "No GL context, the Mesh checks didn't run.");
+    if (context.isValid()) {
+        checkMesh(0x100, GL_UNSIGNED_BYTE, 1);
+        checkMesh(0x101, GL_UNSIGNED_SHORT, 2);
+        checkMesh(0xFFFF, GL_UNSIGNED_SHORT, 2);
+        checkMesh(0x10000, GL_UNSIGNED_SHORT, 2);
+        checkMesh(0x10001, GL_UNSIGNED_INT, 4);
+    }
+
+    LOG(L_INFO, "indexwidth: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
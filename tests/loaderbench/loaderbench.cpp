@@ -0,0 +1,175 @@
+/******************************************
+
+* File Name : tests/loaderbench/loaderbench.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Load time and peak memory of the four .obj loaders on the same file:
+ * loadOBJ, loadOBJ_fast, TinyObjModel and Model (Assimp, mesh cache
+ * off). Every load runs in a child process of its own, so one loader's
+ * heap doesn't carry into the next; the peak is the growth of the
+ * child's peak RSS over the load. Prints the median time and the
+ * largest peak of every loader.
+ *
+ * loadOBJ and loadOBJ_fast only read the geometry. TinyObjModel and
+ * Model also upload the meshes and load the textures, their time and
+ * peak run until the textures are decoded and uploaded.
+ *
+ * loaderbench [model] [runs]
+ *
+ * The default model is the nanosuit main.cpp loads.
+ */
+
+/* STD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <stdint.h>
+
+/* POSIX */
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Program.hpp"
+#include "Model.hpp"
+#include "TextureLoader.hpp"
+#include "objloader.hpp"
+
+#define LB_MODEL    "/store/Code/cpp/learnopengl/models/nanosuit.obj"
+#define LB_RUNS     3
+
+/* What a child sends back */
+struct LoadResult {
+    bool        loaded;
+    double      ms;
+    uint64_t    peak;       /* Peak RSS growth, bytes */
+};
+
+enum Loader { LB_LOADOBJ, LB_LOADOBJ_FAST, LB_TINYOBJ, LB_ASSIMP, LB_LOADERS };
+
+static const char* loaderNames[LB_LOADERS] = { "loadOBJ", "loadOBJ_fast", "TinyObjModel", "Model (Assimp)" };
+
+/* Peak resident set, bytes */
+static uint64_t peakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_maxrss << 10;
+}
+
+/* Load the model once, in this process */
+static LoadResult load(Loader loader, const char* path)
+{
+    LoadResult result = { false, 0.0, 0 };
+
+    /* The models need a context, made before the baseline */
+    std::unique_ptr<TestContext> context;
+    if (loader == LB_TINYOBJ || loader == LB_ASSIMP) {
+        context.reset(new TestContext());
+        if (!context->isValid()) return result;
+    }
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<unsigned int> indices;
+    uint64_t before = peakRss();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    switch (loader) {
+        case LB_LOADOBJ:
+            result.loaded = loadOBJ(path, vertices, uvs, normals);
+            break;
+        case LB_LOADOBJ_FAST:
+            result.loaded = loadOBJ_fast(path, indices, vertices, uvs, normals);
+            break;
+        case LB_TINYOBJ: {
+            TinyObjModel model(path);
+            TextureLoader::get().finish();
+            glFinish();
+            result.loaded = model.getMeshCount() > 0;
+            break;
+        }
+        default: {
+            Model model(path, GL_STATIC_DRAW, false);
+            TextureLoader::get().finish();
+            glFinish();
+            result.loaded = model.getMeshCount() > 0;
+            break;
+        }
+    }
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.peak = peakRss() - before;
+    return result;
+}
+
+/* Load the model in a child process */
+static LoadResult loadInChild(Loader loader, const char* path)
+{
+    LoadResult result = { false, 0.0, 0 };
+    int fds[2];
+    if (pipe(fds) != 0) return result;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        result = load(loader, path);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    if (pid > 0 && read(fds[0], &result, sizeof(result)) != sizeof(result)) result.loaded = false;
+    close(fds[0]);
+    if (pid > 0) waitpid(pid, NULL, 0);
+    return result;
+}
+
+static double median(std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 ? argv[1] : LB_MODEL;
+    uint32_t runs = argc > 2 ? atoi(argv[2]) : LB_RUNS;
+    if (runs == 0) runs = 1;
+
+    /* Interleaved, a slow stretch of the machine hits every loader */
+    std::vector<std::vector<double>> times(LB_LOADERS);
+    std::vector<uint64_t> peaks(LB_LOADERS, 0);
+    for (uint32_t run = 0; run < runs; run++) {
+        for (uint32_t l = 0; l < LB_LOADERS; l++) {
+            LoadResult result = loadInChild((Loader)l, path);
+            TEST_CHECK(result.loaded, "%s could not load %s.", loaderNames[l], path);
+            times[l].push_back(result.ms);
+            peaks[l] = std::max(peaks[l], result.peak);
+        }
+    }
+
+    printf("%-16s %12s %12s\n", "loader", "ms", "peak MB");
+    for (uint32_t l = 0; l < LB_LOADERS; l++) {
+        printf("%-16s %12.2f %12.1f\n", loaderNames[l], median(times[l]), peaks[l] / 1048576.0);
+    }
+
+    LOG(L_INFO, "loaderbench: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
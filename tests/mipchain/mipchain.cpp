@@ -0,0 +1,163 @@
+/******************************************
+
+* File Name : tests/mipchain/mipchain.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * MipChain: the SSE and AVX2 versions must give the scalar chain bit
+ * for bit, for both filters, sRGB on and off, 1 to 4 channels and odd
+ * sizes; a flat image must stay flat down to 1x1. Then a 4K RGBA
+ * benchmark of each version and filter, with the peak memory of the
+ * build, which must stay under MC_BYTES_PER_TEXEL of the source.
+ *
+ * No GL, runs anywhere.
+ */
+
+/* STD */
+#include <vector>
+#include <chrono>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX */
+#include <sys/resource.h>
+
+#include "TestContext.hpp"
+#include "MipChain.hpp"
+
+#define MC_BENCH_SIZE       4096
+#define MC_BENCH_RUNS       3
+#define MC_BYTES_PER_TEXEL  8       /* Peak growth while building, the 8 bit source excluded */
+
+/* Peak resident set, bytes */
+static uint64_t peakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_maxrss << 10;
+}
+
+static std::vector<uint8_t> noise(size_t size, uint32_t seed)
+{
+    std::vector<uint8_t> pixels(size);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        pixels[i] = seed >> 24;
+    }
+    return pixels;
+}
+
+/* Every level of b equal to a */
+static bool sameChain(MipChain& a, MipChain& b)
+{
+    if (a.getLevelCount() != b.getLevelCount()) return false;
+    for (uint32_t level = 1; level < a.getLevelCount(); level++) {
+        size_t size = (size_t)a.getLevelWidth(level) * a.getLevelHeight(level) * a.getChannels();
+        if (memcmp(a.getLevel(level), b.getLevel(level), size) != 0) return false;
+    }
+    return true;
+}
+
+static void checkSimd(MipSimd best)
+{
+    static const uint32_t sizes[][2] = { {1, 1}, {1, 9}, {9, 1}, {2, 2}, {3, 5}, {17, 9}, {64, 64}, {255, 129}, {1000, 3} };
+    uint32_t runs = 0;
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (uint32_t channels = 1; channels <= 4; channels++) {
+            std::vector<uint8_t> pixels = noise((size_t)sizes[s][0] * sizes[s][1] * channels, s * 4 + channels);
+            for (uint32_t filter = MF_BOX; filter <= MF_KAISER; filter++) {
+                for (uint32_t srgb = 0; srgb < 2; srgb++) {
+                    MipChain scalar;
+                    scalar.build(pixels.data(), sizes[s][0], sizes[s][1], channels, (MipFilter)filter, srgb, MS_SCALAR);
+                    for (uint32_t simd = MS_SSE; simd <= (uint32_t)best; simd++) {
+                        MipChain chain;
+                        chain.build(pixels.data(), sizes[s][0], sizes[s][1], channels, (MipFilter)filter, srgb, (MipSimd)simd);
+                        TEST_CHECK(sameChain(scalar, chain), "%s differs from scalar, %ux%u, %u channels, filter %u, sRGB %u",
+                                MipChain::simdName((MipSimd)simd), sizes[s][0], sizes[s][1], channels, filter, srgb);
+                        runs++;
+                    }
+                }
+            }
+        }
+    }
+    LOG(L_INFO, "%u chains compared to scalar, up to %s.", runs, MipChain::simdName(best));
+}
+
+static void checkFlat()
+{
+    const uint8_t color[4] = { 200, 17, 96, 255 };
+    std::vector<uint8_t> pixels((size_t)37 * 21 * 4);
+    for (size_t i = 0; i < pixels.size(); i++) pixels[i] = color[i % 4];
+
+    for (uint32_t filter = MF_BOX; filter <= MF_KAISER; filter++) {
+        MipChain chain;
+        chain.build(pixels.data(), 37, 21, 4, (MipFilter)filter, true);
+        bool flat = true;
+        for (uint32_t level = 1; level < chain.getLevelCount(); level++) {
+            const uint8_t* texels = chain.getLevel(level);
+            size_t size = (size_t)chain.getLevelWidth(level) * chain.getLevelHeight(level) * 4;
+            for (size_t i = 0; i < size; i++) flat = flat && texels[i] == color[i % 4];
+        }
+        TEST_CHECK(chain.getLevelCount() == 6, "37x21 has %u levels", chain.getLevelCount());
+        TEST_CHECK(flat, "a flat image isn't flat down the chain, filter %u", filter);
+    }
+}
+
+static void benchmark(MipSimd best)
+{
+    std::vector<uint8_t> pixels = noise((size_t)MC_BENCH_SIZE * MC_BENCH_SIZE * 4, 7);
+    double texels = (double)MC_BENCH_SIZE * MC_BENCH_SIZE;
+
+    /* First build, the peak memory is measured around it */
+    uint64_t before = peakRss();
+    {
+        MipChain chain;
+        chain.build(pixels.data(), MC_BENCH_SIZE, MC_BENCH_SIZE, 4, MF_KAISER, true, best);
+    }
+    uint64_t grown = peakRss() - before;
+    TEST_CHECK(grown < (uint64_t)(texels * MC_BYTES_PER_TEXEL), "building a %u RGBA chain grew the peak by %lu MB",
+            MC_BENCH_SIZE, (unsigned long)(grown >> 20));
+    LOG(L_INFO, "%ux%u RGBA Kaiser chain: peak memory +%lu MB, the source is %lu MB.", MC_BENCH_SIZE, MC_BENCH_SIZE,
+            (unsigned long)(grown >> 20), (unsigned long)(pixels.size() >> 20));
+
+    for (uint32_t filter = MF_BOX; filter <= MF_KAISER; filter++) {
+        for (uint32_t simd = MS_SCALAR; simd <= (uint32_t)best; simd++) {
+            double fastest = 0.0;
+            for (uint32_t run = 0; run < MC_BENCH_RUNS; run++) {
+                MipChain chain;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                chain.build(pixels.data(), MC_BENCH_SIZE, MC_BENCH_SIZE, 4, (MipFilter)filter, true, (MipSimd)simd);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                if (run == 0 || ms < fastest) fastest = ms;
+            }
+            LOG(L_INFO, "%ux%u RGBA sRGB, %s %s: %.1f ms, %.1f Mtexel/s.", MC_BENCH_SIZE, MC_BENCH_SIZE,
+                    filter == MF_KAISER ? "Kaiser" : "box", MipChain::simdName((MipSimd)simd), fastest,
+                    texels / fastest / 1000.0);
+        }
+    }
+}
+
+int main()
+{
+    MipSimd best = MipChain::bestSimd();
+    checkSimd(best);
+    checkFlat();
+    benchmark(best);
+
+    LOG(L_INFO, "mipchain: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/******************************************
+
+* File Name : tests/objmaterials/objmaterials.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * TinyObjModel on objects split across many materials. Writes grids of
+ * OM_SHAPES objects with a usemtl per row, cycling through 1 to 256
+ * materials that share three texture files, and loads them. Checks
+ * that the corners are welded per object and material, that each
+ * texture file is loaded once however many materials use it, and
+ * prints the load time per material count.
+ *
+ * objmaterials [runs]
+ *
+ * Run from this directory, the textures are read from the repository.
+ */
+
+/* STD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+
+/* POSIX */
+#include <unistd.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Program.hpp"
+#include "Model.hpp"
+#include "TextureLoader.hpp"
+
+#define OM_SHAPES   8
+#define OM_SIDE     256         /* Quads per side of an object */
+#define OM_RUNS     3
+#define OM_PATH     "objmaterials.obj"
+#define OM_MTL      "objmaterials.mtl"
+
+/* What the written model must load as */
+struct Expected {
+    size_t vertices;            /* Welded per object and material */
+    size_t corners;
+    size_t textureRefs;
+};
+
+/**
+ * OM_SHAPES grids, row y of an object uses material y % materials.
+ * Returns false on a write error.
+ */
+static bool writeModel(uint32_t materials, Expected& expected)
+{
+    static const char* diffuse[] = { "container.jpg", "wall.jpg" };
+
+    FILE* mtl = fopen(OM_MTL, "wb");
+    if (mtl == NULL) return false;
+    for (uint32_t m = 0; m < materials; m++) {
+        fprintf(mtl, "newmtl material%u\nKd 1 1 1\n", m);
+        fprintf(mtl, "map_Kd ../../img/textures/%s\n", diffuse[m & 1]);
+        fprintf(mtl, "map_Ks ../../img/textures/awesomeface.png\n\n");
+    }
+    if (fclose(mtl) != 0) return false;
+
+    FILE* obj = fopen(OM_PATH, "wb");
+    if (obj == NULL) return false;
+    fprintf(obj, "mtllib " OM_MTL "\n");
+
+    std::set<uint64_t> welded;      /* (object, material, point) */
+    const uint32_t points = (OM_SIDE + 1) * (OM_SIDE + 1);
+    for (uint32_t s = 0; s < OM_SHAPES; s++) {
+        for (uint32_t y = 0; y <= OM_SIDE; y++) {
+            for (uint32_t x = 0; x <= OM_SIDE; x++) {
+                fprintf(obj, "v %u %u %u\nvt %f %f\nvn 0 0 1\n", x, y, s, x / (float)OM_SIDE, y / (float)OM_SIDE);
+            }
+        }
+
+        fprintf(obj, "o object%u\n", s);
+        uint64_t base = (uint64_t)s * points + 1;
+        for (uint32_t y = 0; y < OM_SIDE; y++) {
+            uint32_t material = y % materials;
+            fprintf(obj, "usemtl material%u\n", material);
+            for (uint32_t x = 0; x < OM_SIDE; x++) {
+                uint64_t a = base + (uint64_t)y * (OM_SIDE + 1) + x, b = a + 1;
+                uint64_t c = a + OM_SIDE + 1, d = c + 1;
+                fprintf(obj, "f %lu/%lu/%lu %lu/%lu/%lu %lu/%lu/%lu\n", a, a, a, b, b, b, c, c, c);
+                fprintf(obj, "f %lu/%lu/%lu %lu/%lu/%lu %lu/%lu/%lu\n", b, b, b, d, d, d, c, c, c);
+                uint64_t corners[] = { a, b, c, d };
+                for (uint32_t i = 0; i < 4; i++) {
+                    welded.insert(((uint64_t)s * materials + material) * (OM_SHAPES * (uint64_t)points) + corners[i]);
+                }
+            }
+        }
+    }
+    if (fclose(obj) != 0) return false;
+
+    expected.vertices = welded.size();
+    expected.corners = (size_t)OM_SHAPES * OM_SIDE * OM_SIDE * 6;
+    expected.textureRefs = (size_t)materials * 2;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t runs = argc > 1 ? atoi(argv[1]) : OM_RUNS;
+    if (runs == 0) runs = 1;
+
+    TestContext context;
+    if (!context.isValid()) return 1;
+
+    static const uint32_t materialCounts[] = { 1, 16, 256 };
+    for (uint32_t i = 0; i < sizeof(materialCounts) / sizeof(materialCounts[0]); i++) {
+        uint32_t materials = materialCounts[i];
+        Expected expected;
+        bool written = writeModel(materials, expected);
+        TEST_CHECK(written, "could not write " OM_PATH);
+        if (!written) break;
+
+        std::vector<double> times;
+        for (uint32_t run = 0; run < runs; run++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            TinyObjModel model(OM_PATH);
+            times.push_back(std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count());
+            TextureLoader::get().finish();
+
+            if (run > 0) continue;
+            TEST_CHECK(model.getVertexCount() == expected.vertices, "%u materials: %lu vertices, expected %lu.",
+                    materials, (unsigned long)model.getVertexCount(), (unsigned long)expected.vertices);
+            TEST_CHECK(model.getCornerCount() == expected.corners, "%u materials: %lu corners, expected %lu.",
+                    materials, (unsigned long)model.getCornerCount(), (unsigned long)expected.corners);
+            TEST_CHECK(model.getTextureRefs() == expected.textureRefs, "%u materials: %lu texture references.",
+                    materials, (unsigned long)model.getTextureRefs());
+            TEST_CHECK(model.getTextureLoads() == std::min(materials + 1, 3u),
+                    "%u materials: %lu textures loaded.", materials, (unsigned long)model.getTextureLoads());
+            LOG(L_INFO, "%u materials: %lu meshes, %lu vertices for %lu corners, %lu textures loaded for %lu "
+                    "references.", materials, (unsigned long)model.getMeshCount(),
+                    (unsigned long)model.getVertexCount(), (unsigned long)model.getCornerCount(),
+                    (unsigned long)model.getTextureLoads(), (unsigned long)model.getTextureRefs());
+        }
+
+        std::sort(times.begin(), times.end());
+        LOG(L_INFO, "%u materials: %.2f ms median of %u.", materials, times[times.size() / 2], runs);
+    }
+    unlink(OM_PATH);
+    unlink(OM_MTL);
+
+    LOG(L_INFO, "objmaterials: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/******************************************
+
+* File Name : tests/objstream/objstream.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Peak memory of loadOBJ_stream on a multi GB file. Writes a scan like
+ * grid (faces use the rows just before them) of about 3 GB, streams it
+ * in 64K vertex chunks and checks that the peak RSS grew by less than
+ * OS_RSS_BOUND, whatever the file size. The whole v/vt/vn pools of the
+ * default file are about 470 MB.
+ *
+ * objstream [size in MB] [path]
+ */
+
+/* STD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+/* POSIX */
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "objloader.hpp"
+
+#define OS_DEFAULT_SIZE     3072        /* MB */
+#define OS_ROW_VERTICES     1024
+#define OS_CHUNK_VERTICES   (64 << 10)
+#define OS_RSS_BOUND        (96 << 20)  /* Bytes */
+
+/* Peak resident set, bytes */
+static uint64_t peakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_maxrss << 10;
+}
+
+/**
+ * Rows of OS_ROW_VERTICES v/vt/vn, each followed by the triangles to
+ * the row before it. Returns the row count, 0 on error.
+ */
+static uint32_t writeGrid(const char* path, uint64_t size)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return 0;
+
+    uint32_t rows = 0;
+    for (uint64_t written = 0; written < size; rows++) {
+        for (uint32_t x = 0; x < OS_ROW_VERTICES; x++) {
+            fprintf(file, "v %u.%03u %u.%03u %u.%03u\n", x, rows % 1000, rows, x % 1000, (x + rows) % 97, x % 7);
+            fprintf(file, "vt %f %f\n", x / (float)OS_ROW_VERTICES, (rows % 4096) / 4096.0f);
+            fprintf(file, "vn 0.0 0.0 1.0\n");
+        }
+        for (uint32_t x = 0; rows > 0 && x + 1 < OS_ROW_VERTICES; x++) {
+            uint64_t a = (uint64_t)(rows - 1) * OS_ROW_VERTICES + x + 1;
+            uint64_t b = a + 1, c = a + OS_ROW_VERTICES, d = c + 1;
+            fprintf(file, "f %lu/%lu/%lu %lu/%lu/%lu %lu/%lu/%lu\n", a, a, a, b, b, b, c, c, c);
+            fprintf(file, "f %lu/%lu/%lu %lu/%lu/%lu %lu/%lu/%lu\n", b, b, b, d, d, d, c, c, c);
+        }
+        written = ftell(file);
+    }
+    if (fclose(file) != 0) return 0;
+    return rows;
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t size = (uint64_t)(argc > 1 ? atoi(argv[1]) : OS_DEFAULT_SIZE) << 20;
+    const char* path = argc > 2 ? argv[2] : "objstream.obj";
+
+    uint32_t rows = writeGrid(path, size);
+    TEST_CHECK(rows > 1, "could not write %s", path);
+    if (rows <= 1) return 1;
+    LOG(L_INFO, "%s: %u rows, %.1f MB", path, rows, size / 1048576.0);
+
+    uint64_t before = peakRss();
+    uint64_t triangles = 0, vertices = 0, chunks = 0;
+    bool loaded = loadOBJ_stream(path, OS_CHUNK_VERTICES, [&](ObjMeshChunk& chunk) {
+        TEST_CHECK(chunk.vertices.size() <= OS_CHUNK_VERTICES, "chunk of %lu vertices", chunk.vertices.size());
+        triangles += chunk.indices.size() / 3;
+        vertices += chunk.vertices.size();
+        chunks++;
+    });
+    uint64_t grown = peakRss() - before;
+    unlink(path);
+
+    uint64_t expected = (uint64_t)(rows - 1) * (OS_ROW_VERTICES - 1) * 2;
+    TEST_CHECK(loaded, "loadOBJ_stream failed");
+    TEST_CHECK(triangles == expected, "%lu triangles, expected %lu", triangles, expected);
+    TEST_CHECK(grown < OS_RSS_BOUND, "peak RSS grew by %lu MB", grown >> 20);
+    LOG(L_INFO, "%lu triangles, %lu vertices in %lu chunks, peak RSS +%lu MB",
+            triangles, vertices, chunks, grown >> 20);
+
+    LOG(L_INFO, "objstream: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/******************************************
+
+* File Name : tests/renderalloc/renderalloc.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Counts the heap allocations of steady state draws. After a warm up
+ * frame, which resolves the samplers and sizes the queue storage,
+ * Mesh::draw and RenderQueue::push/submit must not allocate, for
+ * meshes with their own buffers and for meshes in the MeshArena.
+ *
+ * Run from this directory, the shaders and textures are read from
+ * the repository.
+ */
+
+/* STD */
+#include <new>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <stdlib.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Shader.hpp"
+#include "Program.hpp"
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+#include "TextureManager.hpp"
+
+#define TEST_MESHES     64
+#define TEST_FRAMES     100
+
+static std::atomic<bool>        counting(false);
+static std::atomic<uint64_t>    allocations(0);
+
+void* operator new(size_t size)
+{
+    if (counting) allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+/* A textured quad */
+static Mesh* makeQuad(float x, std::vector<Texture*> textures, bool useArena)
+{
+    std::vector<Vertex> vertices(4);
+    for (uint32_t i = 0; i < 4; i++) {
+        vertices[i].pos_ = glm::vec3(x + (i & 1), (i >> 1), 0.0f);
+        vertices[i].normal_ = glm::vec3(0.0f, 0.0f, 1.0f);
+        vertices[i].texCoords_ = glm::vec2(i & 1, i >> 1);
+    }
+    std::vector<unsigned int> indices = { 0, 1, 2, 2, 1, 3 };
+    return new Mesh(std::move(vertices), std::move(indices), std::move(textures), GL_STATIC_DRAW,
+            BR_DISCARD, useArena);
+}
+
+/* Allocations of frames of fn, after one warm up frame */
+template<class F>
+static uint64_t countAllocations(F fn)
+{
+    fn();
+    allocations = 0;
+    counting = true;
+    for (uint32_t frame = 0; frame < TEST_FRAMES; frame++) fn();
+    counting = false;
+    return allocations;
+}
+
+int main()
+{
+    TestContext context;
+    if (!context.isValid()) return 1;
+    {
+        Shader vShader("../../shaders/SimpleVertexShader.vs", GL_VERTEX_SHADER, "shaders.log");
+        Shader fShader("../../shaders/SimpleFragmentShader.fs", GL_FRAGMENT_SHADER, "shaders.log");
+        Program program(vShader.getHandler(), fShader.getHandler());
+
+        TextureManager& textures = TextureManager::get();
+        Texture* container = textures.acquire("../../img/textures/container.jpg", "diffuse", false);
+        Texture* wall = textures.acquire("../../img/textures/wall.jpg", "diffuse", false);
+        Texture* face = textures.acquire("../../img/textures/awesomeface.png", "specular", false);
+
+        std::vector<std::unique_ptr<Mesh>> meshes;
+        for (uint32_t i = 0; i < TEST_MESHES; i++) {
+            std::vector<Texture*> material = { (i & 1) ? container : wall, face };
+            meshes.push_back(std::unique_ptr<Mesh>(makeQuad(i, material, i >= TEST_MESHES / 2)));
+        }
+
+        uint64_t draws = countAllocations([&]() {
+            for (size_t i = 0; i < meshes.size(); i++) meshes[i]->draw(program);
+        });
+        TEST_CHECK(draws == 0, "Mesh::draw made %lu allocations in %u frames.", (unsigned long)draws, TEST_FRAMES);
+
+        RenderQueue queue;
+        uint64_t submits = countAllocations([&]() {
+            for (size_t i = 0; i < meshes.size(); i++) queue.push(program, meshes[i].get(), i / (float)TEST_MESHES);
+            queue.submit();
+        });
+        TEST_CHECK(submits == 0, "RenderQueue push/submit made %lu allocations in %u frames.",
+                (unsigned long)submits, TEST_FRAMES);
+
+        glFinish();
+        TEST_CHECK(glGetError() == GL_NO_ERROR, "GL error after the draws.");
+        LOG(L_INFO, "%u meshes, %u frames: %lu allocations in Mesh::draw, %lu in the RenderQueue, %lu draws.",
+                TEST_MESHES, TEST_FRAMES, (unsigned long)draws, (unsigned long)submits,
+                (unsigned long)queue.getStats().draws);
+
+        meshes.clear();
+        textures.release(container);
+        textures.release(wall);
+        textures.release(face);
+    }
+
+    LOG(L_INFO, "renderalloc: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/******************************************
+
+* File Name : tests/startup/startup.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Model load times, Assimp import against the binary mesh cache,
+ * each with the files dropped from the page cache (cold) and read
+ * right before (warm). The textures are held by a first Model for
+ * the whole run, so only the meshes are timed. Prints the median of
+ * every case; the warm mesh cache must beat the warm import.
+ *
+ * startup [model] [runs]
+ *
+ * Dropping the pages needs no privileges but only works for clean
+ * pages, the files are synced first. The default model is the
+ * nanosuit main.cpp loads.
+ */
+
+/* STD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+
+/* POSIX */
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Program.hpp"
+#include "Model.hpp"
+#include "TextureLoader.hpp"
+
+#define ST_MODEL    "/store/Code/cpp/learnopengl/models/nanosuit.obj"
+#define ST_RUNS     5
+
+/* Evict a file from the page cache, quietly skipped if it doesn't exist */
+static void dropPages(const std::string & path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/* Milliseconds to load the model and finish its uploads */
+static double load(const std::string & path, bool useCache, bool cold)
+{
+    if (cold) {
+        dropPages(path);
+        dropPages(path.substr(0, path.find_last_of('.')) + ".mtl");
+        dropPages(path + MESH_CACHE_EXT);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        Model model(path.c_str(), GL_STATIC_DRAW, useCache);
+        glFinish();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double median(std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = argc > 1 ? argv[1] : ST_MODEL;
+    uint32_t runs = argc > 2 ? atoi(argv[2]) : ST_RUNS;
+    if (runs == 0) runs = 1;
+
+    TestContext context;
+    if (!context.isValid()) return 1;
+    {
+        /* Writes the mesh cache if there is none, and holds the textures */
+        Model textures(path.c_str(), GL_STATIC_DRAW, true);
+        TextureLoader::get().finish();
+
+        static const struct {
+            const char* label;
+            bool        useCache;
+            bool        cold;
+        } cases[] = {
+            { "Assimp import, cold",    false,  true },
+            { "Assimp import, warm",    false,  false },
+            { "Mesh cache, cold",       true,   true },
+            { "Mesh cache, warm",       true,   false },
+        };
+        const uint32_t caseCount = sizeof(cases) / sizeof(cases[0]);
+
+        /* Interleaved, a slow stretch of the machine hits every case */
+        std::vector<std::vector<double>> times(caseCount);
+        for (uint32_t run = 0; run < runs; run++) {
+            for (uint32_t c = 0; c < caseCount; c++) {
+                times[c].push_back(load(path, cases[c].useCache, cases[c].cold));
+            }
+        }
+
+        for (uint32_t c = 0; c < caseCount; c++) {
+            LOG(L_INFO, "%s: %.2f ms median of %u.", cases[c].label, median(times[c]), runs);
+        }
+        double import = median(times[1]), cached = median(times[3]);
+        LOG(L_INFO, "Warm mesh cache load is %.1fx the warm import.", import / cached);
+        TEST_CHECK(cached < import, "the mesh cache load, %.2f ms, isn't faster than the import, %.2f ms",
+                cached, import);
+        TEST_CHECK(glGetError() == GL_NO_ERROR, "GL error loading %s.", path.c_str());
+    }
+
+    LOG(L_INFO, "startup: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
@@ -0,0 +1,152 @@
+/******************************************
+
+* File Name : tests/texdecode/texdecode.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Load time of a model's worth of textures, decoded on the context
+ * thread against decoded on the TextureLoader. Copies the repository
+ * textures to TD_TEXTURES files of their own, so none is shared, and
+ * acquires them all the way a model does. Prints how long the context
+ * thread was blocked in the acquires and how long until every texture
+ * was uploaded, the median of every way; the async acquires must block
+ * for less than the sync ones.
+ *
+ * texdecode [textures] [runs]
+ *
+ * Run from this directory, the textures are read from the repository.
+ * Both ways end up the same on one core, the decodes only overlap with
+ * the context thread and each other when there are cores to spare.
+ */
+
+/* STD */
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+
+/* POSIX */
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "TextureManager.hpp"
+#include "TextureLoader.hpp"
+
+#define TD_TEXTURES     48
+#define TD_RUNS         3
+#define TD_DIR          "texdecode.textures/"
+
+/* Copy a file, false on error */
+static bool copyFile(const char* from, const std::string& to)
+{
+    FILE* in = fopen(from, "rb");
+    if (in == NULL) return false;
+    FILE* out = fopen(to.c_str(), "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+
+    char buffer[1 << 16];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        if (fwrite(buffer, 1, read, out) != read) break;
+    }
+    bool copied = !ferror(in) && !ferror(out);
+    fclose(in);
+    return fclose(out) == 0 && copied;
+}
+
+static double since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double median(std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count = argc > 1 ? atoi(argv[1]) : TD_TEXTURES;
+    uint32_t runs = argc > 2 ? atoi(argv[2]) : TD_RUNS;
+    if (runs == 0) runs = 1;
+
+    static const char* sources[] = {
+        "../../img/textures/container.jpg", "../../img/textures/wall.jpg", "../../img/textures/awesomeface.png",
+    };
+    static const char* extensions[] = { ".jpg", ".jpg", ".png" };
+    const uint32_t sourceCount = sizeof(sources) / sizeof(sources[0]);
+
+    mkdir(TD_DIR, 0755);
+    std::vector<std::string> paths;
+    for (uint32_t i = 0; i < count; i++) {
+        std::string path = TD_DIR + std::to_string(i) + extensions[i % sourceCount];
+        bool copied = copyFile(sources[i % sourceCount], path);
+        TEST_CHECK(copied, "could not copy %s to %s.", sources[i % sourceCount], path.c_str());
+        if (!copied) return 1;
+        paths.push_back(path);
+    }
+
+    TestContext context;
+    if (!context.isValid()) return 1;
+    {
+        TextureManager& textures = TextureManager::get();
+        std::vector<double> blocked[2], ready[2];
+
+        /* Interleaved, a slow stretch of the machine hits both ways */
+        for (uint32_t run = 0; run < runs; run++) {
+            for (uint32_t async = 0; async < 2; async++) {
+                std::vector<Texture*> acquired;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (uint32_t i = 0; i < count; i++) {
+                    acquired.push_back(textures.acquire(paths[i], i % sourceCount == 2 ? "specular" : "diffuse",
+                                async != 0));
+                }
+                blocked[async].push_back(since(start));
+                TextureLoader::get().finish();
+                glFinish();
+                ready[async].push_back(since(start));
+
+                for (uint32_t i = 0; i < count; i++) {
+                    TEST_CHECK(!acquired[i]->isPending(), "%s still pending after finish().", paths[i].c_str());
+                    textures.release(acquired[i]);
+                }
+            }
+        }
+        TEST_CHECK(glGetError() == GL_NO_ERROR, "GL error loading the textures.");
+
+        static const char* ways[] = { "sync", "async" };
+        for (uint32_t async = 0; async < 2; async++) {
+            LOG(L_INFO, "%u textures, %s: %.2f ms blocked, %.2f ms until uploaded, median of %u.", count,
+                    ways[async], median(blocked[async]), median(ready[async]), runs);
+        }
+        TEST_CHECK(median(blocked[1]) < median(blocked[0]), "the async acquires blocked for %.2f ms, the sync "
+                "ones for %.2f ms.", median(blocked[1]), median(blocked[0]));
+    }
+
+    for (uint32_t i = 0; i < count; i++) unlink(paths[i].c_str());
+    rmdir(TD_DIR);
+
+    LOG(L_INFO, "texdecode: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
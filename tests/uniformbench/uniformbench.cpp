@@ -0,0 +1,173 @@
+/******************************************
+
+* File Name : tests/uniformbench/uniformbench.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Per frame cost of the model program's uniforms, set the way the
+ * render loop sets them, four ways:
+ *
+ *  - glGetUniformLocation and glUniform* on every call, as Program
+ *    did before the location cache
+ *  - the name based setters, a hashed lookup and the shadow copy
+ *  - UniformHandles resolved once
+ *  - UniformHandles with values that don't change, which the
+ *    shadow copy skips
+ *
+ * The values change every frame in the first three, so every set is
+ * uploaded and only the lookup differs. The name based setters must
+ * not allocate, and every way must resolve the same locations.
+ *
+ * uniformbench [frames]
+ *
+ * Run from this directory, the shaders are read from the repository.
+ */
+
+/* STD */
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Shader.hpp"
+#include "Program.hpp"
+
+#define UB_FRAMES   100000
+
+static std::atomic<bool>        counting(false);
+static std::atomic<uint64_t>    allocations(0);
+
+void* operator new(size_t size)
+{
+    if (counting) allocations++;
+    void* p = malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+/* The uniforms main.cpp sets per frame and Mesh per draw, in that order */
+static const char* names[] = {
+    "model", "transposedInversedModel", "objectColor", "viewPos",
+    "material.shininess", "material.diffuse1", "material.specular1",
+};
+static const uint32_t nameCount = sizeof(names) / sizeof(names[0]);
+
+/* Nanoseconds per frame of fn(frame) */
+template<class F>
+static double perFrame(uint32_t frames, F fn)
+{
+    fn(0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 1; frame <= frames; frame++) fn(frame);
+    glFinish();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames = argc > 1 ? atoi(argv[1]) : UB_FRAMES;
+    if (frames == 0) frames = 1;
+
+    TestContext context;
+    if (!context.isValid()) return 1;
+    {
+        Shader vShader("../../shaders/SimpleVertexShader.vs", GL_VERTEX_SHADER, "shaders.log");
+        Shader fShader("../../shaders/SimpleFragmentShader.fs", GL_FRAGMENT_SHADER, "shaders.log");
+        Program program(vShader.getHandler(), fShader.getHandler());
+        program.use();
+
+        UniformHandle handles[nameCount];
+        for (uint32_t i = 0; i < nameCount; i++) {
+            handles[i] = program.getUniform(names[i]);
+            int32_t location = glGetUniformLocation(program.getId(), names[i]);
+            TEST_CHECK(handles[i].location == location, "%s resolves to %d, GL says %d", names[i],
+                    handles[i].location, location);
+        }
+
+        glm::mat4 model(1.0f);
+        double located = perFrame(frames, [&](uint32_t frame) {
+            model[3][0] = (float)frame;
+            uint32_t id = program.getId();
+            glUniformMatrix4fv(glGetUniformLocation(id, "model"), 1, GL_FALSE, &model[0][0]);
+            glUniformMatrix4fv(glGetUniformLocation(id, "transposedInversedModel"), 1, GL_FALSE, &model[0][0]);
+            glUniform3f(glGetUniformLocation(id, "objectColor"), frame, 0.5f, 0.31f);
+            glUniform3f(glGetUniformLocation(id, "viewPos"), frame, 0.0f, 0.0f);
+            glUniform1f(glGetUniformLocation(id, "material.shininess"), frame);
+            glUniform1i(glGetUniformLocation(id, "material.diffuse1"), frame & 7);
+            glUniform1i(glGetUniformLocation(id, "material.specular1"), (frame + 1) & 7);
+        });
+
+        uint64_t nameAllocations = 0;
+        double named = perFrame(frames, [&](uint32_t frame) {
+            model[3][0] = (float)frame;
+            counting = true;
+            program.setMat4f("model", &model[0][0]);
+            program.setMat4f("transposedInversedModel", &model[0][0]);
+            program.setVec3("objectColor", frame, 0.5f, 0.31f);
+            program.setVec3("viewPos", frame, 0.0f, 0.0f);
+            program.setFloat("material.shininess", frame);
+            program.setInt("material.diffuse1", frame & 7);
+            program.setInt("material.specular1", (frame + 1) & 7);
+            counting = false;
+        });
+        nameAllocations = allocations;
+
+        double resolved = perFrame(frames, [&](uint32_t frame) {
+            model[3][0] = (float)frame;
+            program.setMat4f(handles[0], &model[0][0]);
+            program.setMat4f(handles[1], &model[0][0]);
+            program.setVec3(handles[2], frame, 0.5f, 0.31f);
+            program.setVec3(handles[3], frame, 0.0f, 0.0f);
+            program.setFloat(handles[4], frame);
+            program.setInt(handles[5], frame & 7);
+            program.setInt(handles[6], (frame + 1) & 7);
+        });
+
+        program.resetUploadStats();
+        double skipped = perFrame(frames, [&](uint32_t) {
+            program.setMat4f(handles[0], &model[0][0]);
+            program.setMat4f(handles[1], &model[0][0]);
+            program.setVec3(handles[2], 1.0f, 0.5f, 0.31f);
+            program.setVec3(handles[3], 0.0f, 0.0f, 0.0f);
+            program.setFloat(handles[4], 32.0f);
+            program.setInt(handles[5], 0);
+            program.setInt(handles[6], 1);
+        });
+
+        LOG(L_INFO, "%u uniforms, %u frames, per frame:", nameCount, frames);
+        LOG(L_INFO, "  glGetUniformLocation per set: %8.1f ns", located);
+        LOG(L_INFO, "  name based setters:           %8.1f ns, %.2fx faster", named, located / named);
+        LOG(L_INFO, "  UniformHandles:               %8.1f ns, %.2fx faster", resolved, located / resolved);
+        LOG(L_INFO, "  UniformHandles, unchanged:    %8.1f ns, %.2fx faster, %lu uploads skipped",
+                skipped, located / skipped, (unsigned long)program.getUploadsSkipped());
+
+        TEST_CHECK(nameAllocations == 0, "the name based setters made %lu allocations in %u frames",
+                (unsigned long)nameAllocations, frames);
+        TEST_CHECK(glGetError() == GL_NO_ERROR, "GL error setting the uniforms.");
+    }
+
+    LOG(L_INFO, "uniformbench: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
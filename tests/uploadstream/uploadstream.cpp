@@ -0,0 +1,159 @@
+/******************************************
+
+* File Name : tests/uploadstream/uploadstream.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Frame times while 4K RGBA textures stream in mid scene, uploaded
+ * straight from client memory and through the PixelUploadRing. Every
+ * US_UPLOAD_EVERY frames a 4K level is uploaded between two halves of
+ * the draws; both runs print a FrameTimeHistogram, the tail
+ * percentiles are where the ring should win. The last upload of each
+ * run is read back and compared.
+ *
+ * Run from this directory, the shaders and textures are read from
+ * the repository.
+ */
+
+/* STD */
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "Shader.hpp"
+#include "Program.hpp"
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+#include "TextureManager.hpp"
+#include "PixelUploadRing.hpp"
+#include "FrameTimeHistogram.hpp"
+
+#define US_MESHES           64
+#define US_FRAMES           600
+#define US_UPLOAD_EVERY     10
+#define US_SIZE             4096
+
+/* A textured quad */
+static Mesh* makeQuad(float x, std::vector<Texture*> textures)
+{
+    std::vector<Vertex> vertices(4);
+    for (uint32_t i = 0; i < 4; i++) {
+        vertices[i].pos_ = glm::vec3(x + (i & 1), (i >> 1), 0.0f);
+        vertices[i].normal_ = glm::vec3(0.0f, 0.0f, 1.0f);
+        vertices[i].texCoords_ = glm::vec2(i & 1, i >> 1);
+    }
+    std::vector<unsigned int> indices = { 0, 1, 2, 2, 1, 3 };
+    return new Mesh(std::move(vertices), std::move(indices), std::move(textures), GL_STATIC_DRAW);
+}
+
+/* One run, returns false if the last upload didn't read back */
+static bool run(const char* label, bool staged, GLFWwindow* window, Program& program,
+        std::vector<std::unique_ptr<Mesh>>& meshes, uint32_t texture, const std::vector<uint8_t>& pixels)
+{
+    PixelUploadRing& ring = PixelUploadRing::get();
+    ring.setEnabled(staged);
+
+    RenderQueue queue;
+    FrameTimeHistogram histogram;
+    uint64_t stalls = 0, unmapped = 0;
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+    for (uint32_t frame = 0; frame < US_FRAMES; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (size_t i = 0; i < meshes.size() / 2; i++) queue.push(program, meshes[i].get(), i / (float)US_MESHES);
+        queue.submit();
+
+        if (frame % US_UPLOAD_EVERY == 0) {
+            /* Each frame streams its own pattern */
+            const uint8_t* level = &pixels[(frame / US_UPLOAD_EVERY % 2) * 4];
+            GLState::get().bindTexture(0, texture);
+            if (!staged || !ring.upload(0, US_SIZE, US_SIZE, GL_RGBA, 4, level)) {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, US_SIZE, US_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, level);
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            }
+        }
+
+        for (size_t i = meshes.size() / 2; i < meshes.size(); i++) queue.push(program, meshes[i].get(), i / (float)US_MESHES);
+        queue.submit();
+        glfwSwapBuffers(window);
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        histogram.add(std::chrono::duration<double, std::milli>(now - last).count());
+        last = now;
+
+        stalls += ring.getStats().stalls;
+        unmapped += ring.getStats().unmapped;
+        ring.resetStats();
+    }
+    histogram.print(label);
+    LOG(L_INFO, "%s: %lu ring stalls, %lu unmapped bands.", label, (unsigned long)stalls, (unsigned long)unmapped);
+
+    /* The last upload used the pattern at offset ((US_FRAMES - 1) / US_UPLOAD_EVERY % 2) * 4 */
+    std::vector<uint8_t> readBack((size_t)US_SIZE * US_SIZE * 4);
+    GLState::get().bindTexture(0, texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, readBack.data());
+    const uint8_t* expected = &pixels[((US_FRAMES - 1) / US_UPLOAD_EVERY % 2) * 4];
+    return memcmp(readBack.data(), expected, readBack.size()) == 0;
+}
+
+int main()
+{
+    TestContext context(1280, 720);
+    if (!context.isValid()) return 1;
+    glfwSwapInterval(0);
+    {
+        Shader vShader("../../shaders/SimpleVertexShader.vs", GL_VERTEX_SHADER, "shaders.log");
+        Shader fShader("../../shaders/SimpleFragmentShader.fs", GL_FRAGMENT_SHADER, "shaders.log");
+        Program program(vShader.getHandler(), fShader.getHandler());
+
+        TextureManager& textures = TextureManager::get();
+        Texture* container = textures.acquire("../../img/textures/container.jpg", "diffuse", false);
+        Texture* face = textures.acquire("../../img/textures/awesomeface.png", "specular", false);
+
+        std::vector<std::unique_ptr<Mesh>> meshes;
+        for (uint32_t i = 0; i < US_MESHES; i++) {
+            meshes.push_back(std::unique_ptr<Mesh>(makeQuad(i, { container, face })));
+        }
+
+        /* Two 4K patterns one pixel apart */
+        std::vector<uint8_t> pixels((size_t)US_SIZE * US_SIZE * 4 + 4);
+        for (size_t i = 0; i < pixels.size(); i++) pixels[i] = (uint8_t)(i * 2654435761u >> 24);
+
+        uint32_t texture;
+        glGenTextures(1, &texture);
+        GLState::get().bindTexture(0, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, US_SIZE, US_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+        bool direct = run("Client memory uploads", false, context.getWindow(), program, meshes, texture, pixels);
+        bool staged = run("Pixel upload ring", true, context.getWindow(), program, meshes, texture, pixels);
+        TEST_CHECK(direct, "the last client memory upload doesn't read back.");
+        TEST_CHECK(staged, "the last ring upload doesn't read back.");
+        TEST_CHECK(glGetError() == GL_NO_ERROR, "GL error after the runs.");
+
+        GLState::get().bindTexture(0, 0);
+        glDeleteTextures(1, &texture);
+        meshes.clear();
+        textures.release(container);
+        textures.release(face);
+    }
+
+    LOG(L_INFO, "uploadstream: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
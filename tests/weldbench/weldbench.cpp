@@ -0,0 +1,195 @@
+/******************************************
+
+* File Name : tests/weldbench/weldbench.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Vertex welding time, three ways, on unindexed grids of 10K to 10M
+ * vertices (six per quad, each grid point shared by up to six):
+ *
+ *  - indexVBO_slow, the linear search over the welded vertices
+ *  - the std::map indexVBO that was in vboindexer.cpp before the
+ *    welder, copied below with 32 bit indices so its output can be
+ *    checked past 65536 vertices
+ *  - indexVBO, the open addressing welder
+ *
+ * indexVBO_slow is O(n^2) and stops at WB_SLOW_MAX vertices. Every
+ * way must weld to one vertex per grid point, and the indices must
+ * give back the input.
+ *
+ * weldbench [max vertices]
+ */
+
+/* STD */
+#include <map>
+#include <vector>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <glm.hpp>
+
+#include "TestContext.hpp"
+#include "vboindexer.hpp"
+
+#define WB_MAX_VERTICES     10000000
+#define WB_SLOW_MAX         100000
+
+/* The std::map indexVBO, as it was before the welder */
+struct PackedVertex {
+    glm::vec3 position;
+    glm::vec2 uv;
+    glm::vec3 normal;
+    bool operator<(const PackedVertex that) const {
+        return memcmp((void*)this, (void*)&that, sizeof(PackedVertex)) > 0;
+    };
+};
+
+static bool getSimilarVertexIndex_fast(PackedVertex& packed, std::map<PackedVertex, unsigned int>& VertexToOutIndex,
+        unsigned int& result)
+{
+    std::map<PackedVertex, unsigned int>::iterator it = VertexToOutIndex.find(packed);
+    if (it == VertexToOutIndex.end()) return false;
+    result = it->second;
+    return true;
+}
+
+static void indexVBO_map(std::vector<glm::vec3>& in_vertices, std::vector<glm::vec2>& in_uvs,
+        std::vector<glm::vec3>& in_normals, std::vector<unsigned int>& out_indices,
+        std::vector<glm::vec3>& out_vertices, std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals)
+{
+    std::map<PackedVertex, unsigned int> VertexToOutIndex;
+
+    for (unsigned int i = 0; i < in_vertices.size(); i++) {
+        PackedVertex packed = { in_vertices[i], in_uvs[i], in_normals[i] };
+
+        unsigned int index;
+        bool found = getSimilarVertexIndex_fast(packed, VertexToOutIndex, index);
+
+        if (found) {
+            out_indices.push_back(index);
+        } else {
+            out_vertices.push_back(in_vertices[i]);
+            out_uvs.push_back(in_uvs[i]);
+            out_normals.push_back(in_normals[i]);
+            unsigned int newindex = (unsigned int)out_vertices.size() - 1;
+            out_indices.push_back(newindex);
+            VertexToOutIndex[packed] = newindex;
+        }
+    }
+}
+
+/* Welded output of one way */
+template<class I>
+struct Welded {
+    std::vector<I>          indices;
+    std::vector<glm::vec3>  vertices;
+    std::vector<glm::vec2>  uvs;
+    std::vector<glm::vec3>  normals;
+};
+
+/* An unindexed side x side grid of quads, two triangles each */
+static void makeGrid(uint32_t side, std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& uvs,
+        std::vector<glm::vec3>& normals)
+{
+    static const uint32_t corners[6][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+    size_t count = (size_t)side * side * 6;
+    vertices.clear(); uvs.clear(); normals.clear();
+    vertices.reserve(count); uvs.reserve(count);
+    normals.assign(count, glm::vec3(0.0f, 0.0f, 1.0f));
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            for (uint32_t c = 0; c < 6; c++) {
+                uint32_t px = x + corners[c][0], py = y + corners[c][1];
+                vertices.push_back(glm::vec3(px, py, 0.0f));
+                uvs.push_back(glm::vec2(px / (float)side, py / (float)side));
+            }
+        }
+    }
+}
+
+/* Milliseconds of fn() */
+template<class F>
+static double timed(F fn)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* The welded mesh must have one vertex per grid point and give back the input */
+template<class I>
+static void checkWelded(const char* label, const Welded<I>& welded, uint32_t side,
+        const std::vector<glm::vec3>& vertices)
+{
+    size_t points = (size_t)(side + 1) * (side + 1);
+    TEST_CHECK(welded.vertices.size() == points, "%s: %lu welded vertices, %lu grid points.", label,
+            (unsigned long)welded.vertices.size(), (unsigned long)points);
+    TEST_CHECK(welded.indices.size() == vertices.size(), "%s: %lu indices for %lu vertices.", label,
+            (unsigned long)welded.indices.size(), (unsigned long)vertices.size());
+    if (welded.indices.size() != vertices.size()) return;
+    for (size_t i = 0; i < vertices.size(); i++) {
+        if (welded.indices[i] >= welded.vertices.size() || welded.vertices[welded.indices[i]] != vertices[i]) {
+            TEST_CHECK(false, "%s: index %lu doesn't give back its vertex.", label, (unsigned long)i);
+            return;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxVertices = argc > 1 ? (uint32_t)atoi(argv[1]) : WB_MAX_VERTICES;
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+
+    printf("%10s %10s %12s %12s %12s %8s\n", "vertices", "welded", "slow ms", "map ms", "welder ms", "speedup");
+    for (uint32_t target = 10000; target <= maxVertices; target *= 10) {
+        uint32_t side = 1;
+        while ((side + 1) * (side + 1) * 6ULL <= target) side++;
+        makeGrid(side, vertices, uvs, normals);
+
+        double slowMs = -1.0;
+        if (vertices.size() <= WB_SLOW_MAX) {
+            Welded<unsigned short> slow;
+            slowMs = timed([&]() {
+                indexVBO_slow(vertices, uvs, normals, slow.indices, slow.vertices, slow.uvs, slow.normals);
+            });
+            checkWelded("indexVBO_slow", slow, side, vertices);
+        }
+
+        Welded<unsigned int> map;
+        double mapMs = timed([&]() {
+            indexVBO_map(vertices, uvs, normals, map.indices, map.vertices, map.uvs, map.normals);
+        });
+        checkWelded("std::map indexVBO", map, side, vertices);
+        map = Welded<unsigned int>();
+
+        Welded<unsigned int> welder;
+        double welderMs = timed([&]() {
+            indexVBO(vertices, uvs, normals, welder.indices, welder.vertices, welder.uvs, welder.normals);
+        });
+        checkWelded("indexVBO", welder, side, vertices);
+
+        char slowText[32];
+        if (slowMs < 0.0) snprintf(slowText, sizeof(slowText), "-");
+        else snprintf(slowText, sizeof(slowText), "%.2f", slowMs);
+        printf("%10lu %10lu %12s %12.2f %12.2f %7.1fx\n", (unsigned long)vertices.size(),
+                (unsigned long)welder.vertices.size(), slowText, mapMs, welderMs, mapMs / welderMs);
+    }
+
+    LOG(L_INFO, "weldbench: %s", testFailures() ? "FAILED" : "passed");
+    return testFailures() ? 1 : 0;
+}
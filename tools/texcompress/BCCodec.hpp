@@ -0,0 +1,631 @@
+/******************************************
+
+* File Name : tools/texcompress/BCCodec.hpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * CPU encoders and decoders for single 4x4 blocks: BC1, BC3, BC5 and
+ * BC7 mode 6. The encoders fit the endpoints along the principal axis
+ * of the block, pick the nearest palette entries and refine the
+ * endpoints once with least squares. Good enough for an offline tool;
+ * no exhaustive search, and BC7 only uses its single subset RGBA mode.
+ *
+ * The decoders are only there to measure what the encoders lost.
+ */
+
+#ifndef _LOGL_BC_CODEC_HPP_
+#define _LOGL_BC_CODEC_HPP_
+
+/* STD */
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define BC_PIXELS   16  /* Pixels per block */
+
+/**
+ * ******************************************************
+ * A 4x4 block of RGBA pixels, row major
+ * ******************************************************
+**/
+struct BCBlock {
+    uint8_t px[BC_PIXELS][4];
+};
+
+/**
+ * ******************************************************
+ * @brief Block codec
+ * ******************************************************
+**/
+class BCCodec {
+    public: /* Methods */
+        /**
+         * ******************************************************
+         * Copy the block at (bx, by) out of an RGBA image, the
+         * edges are repeated for partial blocks
+         * ******************************************************
+        **/
+        static void fetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height,
+                uint32_t bx, uint32_t by, BCBlock& block)
+        {
+            for (uint32_t y = 0; y < 4; y++) {
+                uint32_t sy = by * 4 + y < height ? by * 4 + y : height - 1;
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = bx * 4 + x < width ? bx * 4 + x : width - 1;
+                    memcpy(block.px[y * 4 + x], rgba + ((size_t)sy * width + sx) * 4, 4);
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Copy a decoded block into an RGBA image, clipped
+         * ******************************************************
+        **/
+        static void storeBlock(const BCBlock& block, uint32_t bx, uint32_t by,
+                uint8_t* rgba, uint32_t width, uint32_t height)
+        {
+            for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, block.px[y * 4 + x], 4);
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * BC1, 8 bytes. Opaque, always the four color mode.
+         * ******************************************************
+        **/
+        static void encodeBC1(const BCBlock& block, uint8_t* out)
+        {
+            encodeColor(block, out);
+        }
+
+        static void decodeBC1(const uint8_t* in, BCBlock& block)
+        {
+            decodeColor(in, block, false);
+        }
+
+        /**
+         * ******************************************************
+         * BC3, 16 bytes. A BC4 alpha block, then the color block.
+         * ******************************************************
+        **/
+        static void encodeBC3(const BCBlock& block, uint8_t* out)
+        {
+            encodeChannel(block, 3, out);
+            encodeColor(block, out + 8);
+        }
+
+        static void decodeBC3(const uint8_t* in, BCBlock& block)
+        {
+            decodeColor(in + 8, block, true);
+            decodeChannel(in, block, 3);
+        }
+
+        /**
+         * ******************************************************
+         * BC5, 16 bytes. Red and green as two BC4 blocks.
+         * ******************************************************
+        **/
+        static void encodeBC5(const BCBlock& block, uint8_t* out)
+        {
+            encodeChannel(block, 0, out);
+            encodeChannel(block, 1, out + 8);
+        }
+
+        static void decodeBC5(const uint8_t* in, BCBlock& block)
+        {
+            decodeChannel(in, block, 0);
+            decodeChannel(in + 8, block, 1);
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                block.px[i][2] = 0;
+                block.px[i][3] = 255;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * BC7 mode 6, 16 bytes. One RGBA subset, 7 bit endpoints
+         * with a p-bit each and 4 bit indices.
+         * ******************************************************
+        **/
+        static void encodeBC7(const BCBlock& block, uint8_t* out)
+        {
+            float points[BC_PIXELS][4];
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                for (uint32_t c = 0; c < 4; c++) points[i][c] = block.px[i][c];
+            }
+
+            float lo[4], hi[4];
+            fitAxis(points, 4, lo, hi);
+
+            Mode6 best, candidate;
+            quantizeMode6(lo, hi, candidate);
+            uint32_t bestError = indicesMode6(block, candidate);
+            best = candidate;
+
+            /* One least squares pass on the chosen indices */
+            float weights[BC_PIXELS];
+            for (uint32_t i = 0; i < BC_PIXELS; i++) weights[i] = 1.0f - weight4(candidate.index[i]) / 64.0f;
+            if (refit(points, 4, weights, lo, hi)) {
+                quantizeMode6(lo, hi, candidate);
+                uint32_t error = indicesMode6(block, candidate);
+                if (error < bestError) best = candidate;
+            }
+
+            /* The anchor index has an implicit 0 msb */
+            if (best.index[0] & 8) {
+                for (uint32_t c = 0; c < 4; c++) {
+                    uint8_t t = best.endpoint[0][c];
+                    best.endpoint[0][c] = best.endpoint[1][c];
+                    best.endpoint[1][c] = t;
+                }
+                uint8_t p = best.pbit[0];
+                best.pbit[0] = best.pbit[1];
+                best.pbit[1] = p;
+                for (uint32_t i = 0; i < BC_PIXELS; i++) best.index[i] = 15 - best.index[i];
+            }
+
+            memset(out, 0, 16);
+            uint32_t bit = 0;
+            putBits(out, bit, 1 << 6, 7);                       /* Mode 6 */
+            for (uint32_t c = 0; c < 4; c++) {
+                putBits(out, bit, best.endpoint[0][c], 7);
+                putBits(out, bit, best.endpoint[1][c], 7);
+            }
+            putBits(out, bit, best.pbit[0], 1);
+            putBits(out, bit, best.pbit[1], 1);
+            putBits(out, bit, best.index[0], 3);
+            for (uint32_t i = 1; i < BC_PIXELS; i++) putBits(out, bit, best.index[i], 4);
+        }
+
+        /**
+         * ******************************************************
+         * Only mode 6 is decoded, other modes come out magenta
+         * ******************************************************
+        **/
+        static void decodeBC7(const uint8_t* in, BCBlock& block)
+        {
+            uint32_t bit = 0;
+            if (getBits(in, bit, 7) != (1 << 6)) {
+                for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                    block.px[i][0] = 255; block.px[i][1] = 0; block.px[i][2] = 255; block.px[i][3] = 255;
+                }
+                return;
+            }
+
+            uint32_t e[2][4];
+            for (uint32_t c = 0; c < 4; c++) {
+                e[0][c] = getBits(in, bit, 7);
+                e[1][c] = getBits(in, bit, 7);
+            }
+            uint32_t p0 = getBits(in, bit, 1);
+            uint32_t p1 = getBits(in, bit, 1);
+            for (uint32_t c = 0; c < 4; c++) {
+                e[0][c] = (e[0][c] << 1) | p0;
+                e[1][c] = (e[1][c] << 1) | p1;
+            }
+
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                uint32_t w = weight4(getBits(in, bit, i == 0 ? 3 : 4));
+                for (uint32_t c = 0; c < 4; c++) {
+                    block.px[i][c] = ((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6;
+                }
+            }
+        }
+
+    private: /* Types */
+        struct Mode6 {
+            uint8_t endpoint[2][4];     /* 7 bit */
+            uint8_t pbit[2];
+            uint8_t index[BC_PIXELS];
+        };
+
+    private: /* Methods */
+        /**
+         * ******************************************************
+         * Endpoints along the principal axis of the points
+         *
+         * @param[in]  points
+         * @param[in]  channels     - 3 or 4 used of each point
+         * @param[out] lo, hi       - the extremes of the projection
+         * ******************************************************
+        **/
+        static void fitAxis(const float points[BC_PIXELS][4], uint32_t channels, float* lo, float* hi)
+        {
+            float mean[4] = { 0, 0, 0, 0 };
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                for (uint32_t c = 0; c < channels; c++) mean[c] += points[i][c] / BC_PIXELS;
+            }
+
+            float cov[4][4];
+            memset(cov, 0, sizeof(cov));
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                for (uint32_t a = 0; a < channels; a++) {
+                    for (uint32_t b = 0; b < channels; b++) {
+                        cov[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                    }
+                }
+            }
+
+            /* Power iteration */
+            float axis[4] = { 1, 1, 1, 1 };
+            for (uint32_t iteration = 0; iteration < 8; iteration++) {
+                float next[4] = { 0, 0, 0, 0 };
+                float length = 0;
+                for (uint32_t a = 0; a < channels; a++) {
+                    for (uint32_t b = 0; b < channels; b++) next[a] += cov[a][b] * axis[b];
+                    length += next[a] * next[a];
+                }
+                if (length < 1e-8f) break;  /* Flat block, any axis will do */
+                length = sqrtf(length);
+                for (uint32_t a = 0; a < channels; a++) axis[a] = next[a] / length;
+            }
+
+            float tMin = 0, tMax = 0;
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                float t = 0;
+                for (uint32_t c = 0; c < channels; c++) t += (points[i][c] - mean[c]) * axis[c];
+                if (t < tMin) tMin = t;
+                if (t > tMax) tMax = t;
+            }
+            for (uint32_t c = 0; c < channels; c++) {
+                lo[c] = clampf(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+                hi[c] = clampf(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Least squares endpoints for fixed interpolation weights
+         *
+         * @param[in]  weights      - of the first endpoint, per point
+         * @param[out] first, second
+         *
+         * @return false if the weights don't pin the endpoints
+         * ******************************************************
+        **/
+        static bool refit(const float points[BC_PIXELS][4], uint32_t channels,
+                const float* weights, float* first, float* second)
+        {
+            float aa = 0, ab = 0, bb = 0;
+            float ax[4] = { 0, 0, 0, 0 }, bx[4] = { 0, 0, 0, 0 };
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                float a = weights[i], b = 1.0f - weights[i];
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (uint32_t c = 0; c < channels; c++) {
+                    ax[c] += a * points[i][c];
+                    bx[c] += b * points[i][c];
+                }
+            }
+            float det = aa * bb - ab * ab;
+            if (fabsf(det) < 1e-6f) return false;
+
+            for (uint32_t c = 0; c < channels; c++) {
+                first[c]  = clampf((bb * ax[c] - ab * bx[c]) / det, 0.0f, 255.0f);
+                second[c] = clampf((aa * bx[c] - ab * ax[c]) / det, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        /**
+         * ******************************************************
+         * 565 color helpers
+         * ******************************************************
+        **/
+        static uint16_t pack565(const float* c)
+        {
+            uint32_t r = (uint32_t)(c[0] * 31.0f / 255.0f + 0.5f);
+            uint32_t g = (uint32_t)(c[1] * 63.0f / 255.0f + 0.5f);
+            uint32_t b = (uint32_t)(c[2] * 31.0f / 255.0f + 0.5f);
+            return (uint16_t)((r << 11) | (g << 5) | b);
+        }
+
+        static void unpack565(uint16_t v, int32_t* c)
+        {
+            uint32_t r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+            c[0] = (r << 3) | (r >> 2);
+            c[1] = (g << 2) | (g >> 4);
+            c[2] = (b << 3) | (b >> 2);
+        }
+
+        /**
+         * ******************************************************
+         * The four colors of a color block
+         * ******************************************************
+        **/
+        static void colorPalette(uint16_t c0, uint16_t c1, bool fourColor, int32_t palette[4][3])
+        {
+            unpack565(c0, palette[0]);
+            unpack565(c1, palette[1]);
+            for (uint32_t c = 0; c < 3; c++) {
+                if (fourColor || c0 > c1) {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                } else {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Color block indices for quantized endpoints
+         *
+         * @return squared error
+         * ******************************************************
+        **/
+        static uint32_t colorIndices(const BCBlock& block, uint16_t c0, uint16_t c1, uint32_t& indices)
+        {
+            int32_t palette[4][3];
+            colorPalette(c0, c1, true, palette);
+
+            uint32_t total = 0;
+            indices = 0;
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                uint32_t best = 0, bestError = 0xFFFFFFFF;
+                for (uint32_t p = 0; p < 4; p++) {
+                    uint32_t error = 0;
+                    for (uint32_t c = 0; c < 3; c++) {
+                        int32_t d = (int32_t)block.px[i][c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= best << (2 * i);
+                total += bestError;
+            }
+            return total;
+        }
+
+        /**
+         * ******************************************************
+         * The color part of BC1 and BC3, four color mode: c0 > c1,
+         * or both equal for a flat block
+         * ******************************************************
+        **/
+        static void encodeColor(const BCBlock& block, uint8_t* out)
+        {
+            float points[BC_PIXELS][4];
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                for (uint32_t c = 0; c < 4; c++) points[i][c] = block.px[i][c];
+            }
+
+            float lo[4], hi[4];
+            fitAxis(points, 3, lo, hi);
+
+            uint16_t c0 = pack565(hi), c1 = pack565(lo);
+            if (c0 < c1) { uint16_t t = c0; c0 = c1; c1 = t; }
+            uint32_t indices;
+            uint32_t bestError = colorIndices(block, c0, c1, indices);
+            uint16_t best0 = c0, best1 = c1;
+            uint32_t bestIndices = indices;
+
+            /* One least squares pass on the chosen indices */
+            static const float firstWeight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+            float weights[BC_PIXELS];
+            for (uint32_t i = 0; i < BC_PIXELS; i++) weights[i] = firstWeight[(indices >> (2 * i)) & 3];
+            if (refit(points, 3, weights, hi, lo)) {
+                c0 = pack565(hi);
+                c1 = pack565(lo);
+                if (c0 < c1) { uint16_t t = c0; c0 = c1; c1 = t; }
+                uint32_t error = colorIndices(block, c0, c1, indices);
+                if (error < bestError) {
+                    best0 = c0;
+                    best1 = c1;
+                    bestIndices = indices;
+                }
+            }
+
+            /* Equal endpoints select the three color mode in BC1, all indices 0 is the same in both */
+            if (best0 == best1) bestIndices = 0;
+
+            out[0] = best0 & 0xFF;
+            out[1] = best0 >> 8;
+            out[2] = best1 & 0xFF;
+            out[3] = best1 >> 8;
+            for (uint32_t b = 0; b < 4; b++) out[4 + b] = (bestIndices >> (8 * b)) & 0xFF;
+        }
+
+        static void decodeColor(const uint8_t* in, BCBlock& block, bool fourColor)
+        {
+            uint16_t c0 = in[0] | (in[1] << 8);
+            uint16_t c1 = in[2] | (in[3] << 8);
+            uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t)in[7] << 24);
+
+            int32_t palette[4][3];
+            colorPalette(c0, c1, fourColor, palette);
+            bool punchThrough = !fourColor && c0 <= c1;
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                uint32_t p = (indices >> (2 * i)) & 3;
+                for (uint32_t c = 0; c < 3; c++) block.px[i][c] = palette[p][c];
+                block.px[i][3] = (punchThrough && p == 3) ? 0 : 255;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * The eight values of a BC4 block
+         * ******************************************************
+        **/
+        static void channelPalette(uint32_t a0, uint32_t a1, uint32_t palette[8])
+        {
+            palette[0] = a0;
+            palette[1] = a1;
+            if (a0 > a1) {
+                for (uint32_t j = 1; j < 7; j++) palette[j + 1] = ((7 - j) * a0 + j * a1 + 3) / 7;
+            } else {
+                for (uint32_t j = 1; j < 5; j++) palette[j + 1] = ((5 - j) * a0 + j * a1 + 2) / 5;
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        /**
+         * ******************************************************
+         * One channel as a BC4 block, eight value mode
+         * ******************************************************
+        **/
+        static void encodeChannel(const BCBlock& block, uint32_t channel, uint8_t* out)
+        {
+            uint32_t lo = 255, hi = 0;
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                uint32_t v = block.px[i][channel];
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+
+            uint32_t palette[8];
+            channelPalette(hi, lo, palette);
+
+            uint64_t bits = 0;
+            for (uint32_t i = 0; i < BC_PIXELS && hi != lo; i++) {
+                uint32_t v = block.px[i][channel];
+                uint32_t best = 0, bestError = 0xFFFFFFFF;
+                for (uint32_t p = 0; p < 8; p++) {
+                    uint32_t error = v > palette[p] ? v - palette[p] : palette[p] - v;
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                bits |= (uint64_t)best << (3 * i);
+            }
+
+            out[0] = hi;
+            out[1] = lo;
+            for (uint32_t b = 0; b < 6; b++) out[2 + b] = (bits >> (8 * b)) & 0xFF;
+        }
+
+        static void decodeChannel(const uint8_t* in, BCBlock& block, uint32_t channel)
+        {
+            uint32_t palette[8];
+            channelPalette(in[0], in[1], palette);
+
+            uint64_t bits = 0;
+            for (uint32_t b = 0; b < 6; b++) bits |= (uint64_t)in[2 + b] << (8 * b);
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                block.px[i][channel] = palette[(bits >> (3 * i)) & 7];
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Mode 6 endpoints, each with the p-bit that fits it best
+         * ******************************************************
+        **/
+        static void quantizeMode6(const float* first, const float* second, Mode6& mode)
+        {
+            const float* endpoints[2] = { first, second };
+            for (uint32_t e = 0; e < 2; e++) {
+                float bestError = 1e30f;
+                for (uint32_t p = 0; p < 2; p++) {
+                    uint8_t q[4];
+                    float error = 0;
+                    for (uint32_t c = 0; c < 4; c++) {
+                        float v = (endpoints[e][c] - p) / 2.0f;
+                        q[c] = (uint8_t)clampf(v + 0.5f, 0.0f, 127.0f);
+                        float d = (float)((q[c] << 1) | p) - endpoints[e][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        memcpy(mode.endpoint[e], q, 4);
+                        mode.pbit[e] = p;
+                    }
+                }
+            }
+        }
+
+        /**
+         * ******************************************************
+         * Mode 6 indices for the quantized endpoints
+         *
+         * @return squared error
+         * ******************************************************
+        **/
+        static uint32_t indicesMode6(const BCBlock& block, Mode6& mode)
+        {
+            int32_t palette[16][4];
+            for (uint32_t c = 0; c < 4; c++) {
+                int32_t e0 = (mode.endpoint[0][c] << 1) | mode.pbit[0];
+                int32_t e1 = (mode.endpoint[1][c] << 1) | mode.pbit[1];
+                for (uint32_t k = 0; k < 16; k++) {
+                    palette[k][c] = ((64 - weight4(k)) * e0 + weight4(k) * e1 + 32) >> 6;
+                }
+            }
+
+            uint32_t total = 0;
+            for (uint32_t i = 0; i < BC_PIXELS; i++) {
+                uint32_t best = 0, bestError = 0xFFFFFFFF;
+                for (uint32_t k = 0; k < 16; k++) {
+                    uint32_t error = 0;
+                    for (uint32_t c = 0; c < 4; c++) {
+                        int32_t d = (int32_t)block.px[i][c] - palette[k][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        best = k;
+                    }
+                }
+                mode.index[i] = best;
+                total += bestError;
+            }
+            return total;
+        }
+
+        /**
+         * ******************************************************
+         * Bit stream helpers, LSB first
+         * ******************************************************
+        **/
+        static void putBits(uint8_t* out, uint32_t& bit, uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++, bit++) {
+                if (value & (1u << i)) out[bit >> 3] |= 1 << (bit & 7);
+            }
+        }
+
+        static uint32_t getBits(const uint8_t* in, uint32_t& bit, uint32_t count)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; i++, bit++) {
+                value |= ((in[bit >> 3] >> (bit & 7)) & 1) << i;
+            }
+            return value;
+        }
+
+        /* BC7 4 bit index weights, out of 64 */
+        static uint32_t weight4(uint32_t index)
+        {
+            static const uint8_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+            return weights[index];
+        }
+
+        static float clampf(float v, float lo, float hi)
+        {
+            return v < lo ? lo : (v > hi ? hi : v);
+        }
+};
+
+#endif
@@ -0,0 +1,263 @@
+/******************************************
+
+* File Name : tools/texcompress/texcompress.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Offline texture compressor. Decodes PNG/JPG/TGA with stb_image,
+ * builds the mip chain, encodes every level to BC1, BC3, BC5 or BC7
+ * and writes a DDS that Texture uploads without decoding anything.
+ * Reports the size against raw RGBA and the PSNR of level 0.
+ *
+ * Usage: texcompress [-f bc1|bc3|bc5|bc7] [-m box|kaiser] [-l] [-n] [-o out.dds] images...
+ *  -f  block format; by default BC3 for images with alpha, else BC1
+ *  -m  mip filter, Kaiser by default
+ *  -l  the image is linear data; by default only BC5 (normal maps) is
+ *  -n  level 0 only, no mip chain
+ *  -o  output path, one input only; by default the input with .dds
+ */
+
+/* STD */
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define STB_IMAGE_IMPLEMENTATION 1
+#include <stb_image.h>
+
+#include "Utils.hpp"
+#include "ThreadPool.hpp"
+#include "DDSFile.hpp"
+#include "MipChain.hpp"
+#include "BCCodec.hpp"
+
+typedef void (*BlockEncoder)(const BCBlock&, uint8_t*);
+typedef void (*BlockDecoder)(const uint8_t*, BCBlock&);
+
+/**
+ * ******************************************************
+ * What a format encodes and which channels it keeps
+ * ******************************************************
+**/
+struct FormatInfo {
+    BlockFormat     format;
+    const char*     name;
+    BlockEncoder    encode;
+    BlockDecoder    decode;
+    uint32_t        channels;   /* Compared for the PSNR, from R */
+};
+
+static const FormatInfo FORMATS[] = {
+    { BF_BC1, "bc1", BCCodec::encodeBC1, BCCodec::decodeBC1, 3 },
+    { BF_BC3, "bc3", BCCodec::encodeBC3, BCCodec::decodeBC3, 4 },
+    { BF_BC5, "bc5", BCCodec::encodeBC5, BCCodec::decodeBC5, 2 },
+    { BF_BC7, "bc7", BCCodec::encodeBC7, BCCodec::decodeBC7, 4 },
+};
+
+/**
+ * ******************************************************
+ * Encode one level, a row of blocks per task
+ * ******************************************************
+**/
+static void encodeLevel(const FormatInfo& info, const uint8_t* rgba,
+        uint32_t width, uint32_t height, std::vector<uint8_t>& blocks)
+{
+    uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    uint32_t blockSize = DDSFile::blockSize(info.format);
+    blocks.resize((size_t)blocksX * blocksY * blockSize);
+
+    ThreadPool::global().parallelFor(blocksY, [&](uint32_t by) {
+        BCBlock block;
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            BCCodec::fetchBlock(rgba, width, height, bx, by, block);
+            info.encode(block, &blocks[((size_t)by * blocksX + bx) * blockSize]);
+        }
+    });
+}
+
+/**
+ * ******************************************************
+ * PSNR of the encoded level against the source, over the
+ * channels the format keeps. INFINITY if lossless.
+ * ******************************************************
+**/
+static double measurePSNR(const FormatInfo& info, const std::vector<uint8_t>& rgba,
+        uint32_t width, uint32_t height, const uint8_t* blocks)
+{
+    uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    uint32_t blockSize = DDSFile::blockSize(info.format);
+    std::vector<uint8_t> decoded(rgba.size());
+
+    BCBlock block;
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            info.decode(blocks + ((size_t)by * blocksX + bx) * blockSize, block);
+            BCCodec::storeBlock(block, bx, by, decoded.data(), width, height);
+        }
+    }
+
+    double error = 0;
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        for (uint32_t c = 0; c < info.channels; c++) {
+            double d = (double)rgba[i * 4 + c] - decoded[i * 4 + c];
+            error += d * d;
+        }
+    }
+    double mse = error / ((double)width * height * info.channels);
+    return mse == 0 ? INFINITY : 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+/**
+ * ******************************************************
+ * Compress one image
+ *
+ * @param[in] input
+ * @param[in] output
+ * @param[in] forced        - format asked for, NULL to pick
+ * @param[in] mips          - build the mip chain
+ * @param[in] filter        - mip chain filter
+ * @param[in] linear        - no sRGB, even for color formats
+ * @param[out] rawBytes     - RGBA size of the chain, for the totals
+ * @param[out] ddsBytes     - block size of the chain
+ * ******************************************************
+**/
+static bool compress(const std::string& input, const std::string& output, const FormatInfo* forced,
+        bool mips, MipFilter filter, bool linear, size_t& rawBytes, size_t& ddsBytes)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    /* Bottom up, the way Texture uploads the decoded images */
+    int w, h, channels;
+    stbi_set_flip_vertically_on_load(true);
+    uint8_t* pixels = stbi_load(input.c_str(), &w, &h, &channels, 4);
+    if (pixels == NULL) {
+        LOG(L_ERR, "%s: %s", input.c_str(), stbi_failure_reason());
+        return false;
+    }
+    uint32_t width = w, height = h;
+    std::vector<uint8_t> level(pixels, pixels + (size_t)width * height * 4);
+    stbi_image_free(pixels);
+
+    const FormatInfo* info = forced;
+    if (info == NULL) {
+        bool alpha = false;
+        for (size_t i = 3; i < level.size() && !alpha; i += 4) alpha = level[i] != 255;
+        info = &FORMATS[alpha ? 1 : 0];
+    }
+
+    /* BC5 holds normal maps, filtering them as sRGB would bend the vectors */
+    MipChain chain;
+    if (mips) chain.build(level.data(), width, height, 4, filter, !linear && info->format != BF_BC5);
+
+    DDSFile dds(info->format, width, height);
+    std::vector<uint8_t> blocks;
+    uint32_t levels = mips ? chain.getLevelCount() : 1;
+    double psnr = 0;
+    rawBytes = 0;
+    for (uint32_t l = 0; l < levels; l++) {
+        uint32_t levelWidth = dds.getLevelWidth(l), levelHeight = dds.getLevelHeight(l);
+        encodeLevel(*info, l == 0 ? level.data() : chain.getLevel(l), levelWidth, levelHeight, blocks);
+        dds.addLevel(blocks.data());
+        rawBytes += (size_t)levelWidth * levelHeight * 4;
+        if (l == 0) psnr = measurePSNR(*info, level, levelWidth, levelHeight, blocks.data());
+    }
+
+    if (!dds.write(output.c_str())) return false;
+    ddsBytes = dds.getSize();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    LOG(L_INFO, "%s -> %s: %s %ux%u, %u levels, %lu KiB (RGBA %lu KiB, %.1fx), PSNR %.2f dB, %.0f ms.",
+            input.c_str(), output.c_str(), info->name, width, height, dds.getLevelCount(),
+            (unsigned long)(ddsBytes / 1024), (unsigned long)(rawBytes / 1024),
+            (double)rawBytes / ddsBytes, psnr, elapsed.count());
+    return true;
+}
+
+static void usage()
+{
+    printf("Usage: texcompress [-f bc1|bc3|bc5|bc7] [-m box|kaiser] [-l] [-n] [-o out.dds] images...\n");
+}
+
+int main(int argc, char** argv)
+{
+    const FormatInfo* forced = NULL;
+    bool mips = true, linear = false;
+    MipFilter filter = MF_KAISER;
+    std::string output;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            i++;
+            for (uint32_t f = 0; f < sizeof(FORMATS) / sizeof(FORMATS[0]); f++) {
+                if (strcmp(argv[i], FORMATS[f].name) == 0) forced = &FORMATS[f];
+            }
+            if (forced == NULL) {
+                LOG(L_ERR, "Unknown format %s.", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "box") == 0) {
+                filter = MF_BOX;
+            } else if (strcmp(argv[i], "kaiser") == 0) {
+                filter = MF_KAISER;
+            } else {
+                LOG(L_ERR, "Unknown mip filter %s.", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-l") == 0) {
+            linear = true;
+        } else if (strcmp(argv[i], "-n") == 0) {
+            mips = false;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 1;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty() || (!output.empty() && inputs.size() > 1)) {
+        usage();
+        return 1;
+    }
+
+    size_t rawTotal = 0, ddsTotal = 0;
+    uint32_t failed = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::string out = output;
+        if (out.empty()) out = inputs[i].substr(0, inputs[i].find_last_of('.')) + ".dds";
+
+        size_t rawBytes = 0, ddsBytes = 0;
+        if (compress(inputs[i], out, forced, mips, filter, linear, rawBytes, ddsBytes)) {
+            rawTotal += rawBytes;
+            ddsTotal += ddsBytes;
+        } else {
+            failed++;
+        }
+    }
+
+    if (inputs.size() > 1 && ddsTotal > 0) {
+        LOG(L_INFO, "%lu textures, %lu KiB (RGBA %lu KiB, %.1fx), %u failed.",
+                (unsigned long)(inputs.size() - failed), (unsigned long)(ddsTotal / 1024),
+                (unsigned long)(rawTotal / 1024), (double)rawTotal / ddsTotal, failed);
+    }
+    return failed ? 1 : 0;
+}
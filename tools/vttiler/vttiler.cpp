@@ -0,0 +1,197 @@
+/******************************************
+
+* File Name : tools/vttiler/vttiler.cpp
+
+* Creation Date : 18-10-2026
+
+* Last Modified :
+
+* Created By : Mihai Constantin constant.mihai@googlemail.com
+
+* License :
+
+******************************************/
+
+/**
+ * Purpose
+ *
+ * Offline tiler for virtual textures. Decodes an image with stb_image,
+ * builds its mip chain and cuts every level into bordered tiles in a
+ * page file (see PageFile) that VirtualTexture streams from.
+ * Tiles that only hold padding are not written, the file keeps a hole
+ * there.
+ *
+ * Usage: vttiler [-t tile] [-b border] [-m box|kaiser] [-l] [-o out.vtp] images...
+ *  -t  texels per tile side, a power of two, 128 by default
+ *  -b  border texels, 4 by default
+ *  -m  mip filter, Kaiser by default
+ *  -l  the image is linear data, not sRGB color
+ *  -o  output path, one input only; by default the input with .vtp
+ */
+
+/* STD */
+#include <vector>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION 1
+#include <stb_image.h>
+
+#include "Utils.hpp"
+#include "ThreadPool.hpp"
+#include "MipChain.hpp"
+#include "PageFile.hpp"
+
+/**
+ * ******************************************************
+ * Copy a tile and its border out of a level, clamping
+ * at the image edges
+ * ******************************************************
+**/
+static void cutTile(const uint8_t* rgba, uint32_t width, uint32_t height,
+        uint32_t tileSize, uint32_t border, uint32_t tx, uint32_t ty, uint8_t* page)
+{
+    uint32_t pageSize = tileSize + 2 * border;
+    int64_t x0 = (int64_t)tx * tileSize - border, y0 = (int64_t)ty * tileSize - border;
+    for (uint32_t y = 0; y < pageSize; y++) {
+        int64_t sy = y0 + y;
+        sy = sy < 0 ? 0 : (sy >= height ? height - 1 : sy);
+        for (uint32_t x = 0; x < pageSize; x++) {
+            int64_t sx = x0 + x;
+            sx = sx < 0 ? 0 : (sx >= width ? width - 1 : sx);
+            memcpy(page + ((size_t)y * pageSize + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+/**
+ * ******************************************************
+ * Tile one image
+ *
+ * @param[in] input
+ * @param[in] output
+ * @param[in] tileSize
+ * @param[in] border
+ * @param[in] filter        - mip chain filter
+ * @param[in] linear        - no sRGB
+ * @param[out] bytes        - tile bytes written
+ * ******************************************************
+**/
+static bool tile(const std::string& input, const std::string& output, uint32_t tileSize, uint32_t border,
+        MipFilter filter, bool linear, size_t& bytes)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    /* Bottom up, the way Texture uploads the decoded images */
+    int w, h, channels;
+    stbi_set_flip_vertically_on_load(true);
+    uint8_t* pixels = stbi_load(input.c_str(), &w, &h, &channels, 4);
+    if (pixels == NULL) {
+        LOG(L_ERR, "%s: %s", input.c_str(), stbi_failure_reason());
+        return false;
+    }
+
+    MipChain chain;
+    chain.build(pixels, w, h, 4, filter, !linear);
+
+    PageFile file;
+    if (!file.create(output.c_str(), w, h, tileSize, border)) {
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    std::atomic<uint32_t> written(0), failed(0);
+    for (uint32_t level = 0; level < file.getLevelCount(); level++) {
+        const uint8_t* rgba = level == 0 ? pixels : chain.getLevel(level);
+        uint32_t width = chain.getLevelWidth(level), height = chain.getLevelHeight(level);
+        uint32_t tiles = file.getTilesPerSide(level);
+
+        ThreadPool::global().parallelFor(tiles, [&](uint32_t ty) {
+            std::vector<uint8_t> page(file.getPageBytes());
+            for (uint32_t tx = 0; tx < tiles; tx++) {
+                /* Only padding, never sampled */
+                if ((uint64_t)tx * tileSize >= width || (uint64_t)ty * tileSize >= height) continue;
+
+                cutTile(rgba, width, height, tileSize, border, tx, ty, page.data());
+                if (file.writeTile(file.getTileIndex(level, tx, ty), page.data())) written++;
+                else failed++;
+            }
+        });
+    }
+    stbi_image_free(pixels);
+
+    if (failed != 0) {
+        LOG(L_ERR, "Could not write %u tiles of %s.", (uint32_t)failed, output.c_str());
+        return false;
+    }
+    bytes = (size_t)written * file.getPageBytes();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    LOG(L_INFO, "%s -> %s: %dx%d, %u levels, %u of %u tiles (%ux%u + %u border), %lu KiB, %.0f ms.",
+            input.c_str(), output.c_str(), w, h, file.getLevelCount(), (uint32_t)written, file.getTileCount(),
+            tileSize, tileSize, border, (unsigned long)(bytes / 1024), elapsed.count());
+    return true;
+}
+
+static void usage()
+{
+    printf("Usage: vttiler [-t tile] [-b border] [-m box|kaiser] [-l] [-o out.vtp] images...\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t tileSize = VT_TILE_SIZE, border = VT_TILE_BORDER;
+    bool linear = false;
+    MipFilter filter = MF_KAISER;
+    std::string output;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tileSize = atoi(argv[++i]);
+            if (tileSize < 16 || (tileSize & (tileSize - 1)) != 0) {
+                LOG(L_ERR, "Tile size %s is not a power of two of 16 or more.", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            border = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "box") == 0) {
+                filter = MF_BOX;
+            } else if (strcmp(argv[i], "kaiser") == 0) {
+                filter = MF_KAISER;
+            } else {
+                LOG(L_ERR, "Unknown mip filter %s.", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-l") == 0) {
+            linear = true;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 1;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty() || (!output.empty() && inputs.size() > 1) || border * 2 >= tileSize) {
+        usage();
+        return 1;
+    }
+
+    uint32_t failed = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        std::string out = output;
+        if (out.empty()) out = inputs[i].substr(0, inputs[i].find_last_of('.')) + PAGE_FILE_EXT;
+
+        size_t bytes = 0;
+        if (!tile(inputs[i], out, tileSize, border, filter, linear, bytes)) failed++;
+    }
+    return failed ? 1 : 0;
+}